@@ -54,9 +54,22 @@ JS_ABI void js_reload_context()
     js_create_context();
 }
 
-JS_ABI char *js_rpc(char *input)
+static size_t g_response_length;
+
+// Returns a response that stays valid until the next call, see `js_rpc_response_length()`
+JS_ABI const char *js_rpc(char *input)
+{
+    return rpc_call(input, &g_response_length);
+}
+
+JS_ABI size_t js_rpc_response_length()
+{
+    return g_response_length;
+}
+
+JS_ABI const char *js_rpc_binary(void *input)
 {
-    return rpc_call(input);
+    return rpc_call_binary(input);
 }
 
 #else
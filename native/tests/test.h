@@ -0,0 +1,22 @@
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// Minimal test helpers: every test is its own executable run by ctest,
+// a failed check prints its location and exits with a non-zero code.
+
+#define test_check(cond) do { \
+		if (!(cond)) { \
+			fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+			exit(1); \
+		} \
+	} while (0)
+
+#define test_check_eq(a, b) do { \
+		long long test_a_ = (long long)(a), test_b_ = (long long)(b); \
+		if (test_a_ != test_b_) { \
+			fprintf(stderr, "%s:%d: check failed: %s == %s (%lld != %lld)\n", __FILE__, __LINE__, #a, #b, test_a_, test_b_); \
+			exit(1); \
+		} \
+	} while (0)
@@ -0,0 +1,121 @@
+#include "ufbx.h"
+#include "test.h"
+
+#include <math.h>
+#include <string.h>
+
+// Decoding geometry cache frames of every data format and encoding into caller
+// buffers, compared against a plain scalar conversion.
+
+#define NUM_VALUES 103
+
+static float value_f32(uint32_t i) { return (float)i * 1.5f - 40.0f + 1.0f / (float)(i + 3); }
+static double value_f64(uint32_t i) { return (double)i * -2.25 + 1.0 / (double)(i + 7); }
+
+static void write_bytes(FILE *f, const void *data, size_t size, bool big_endian)
+{
+	char buf[8];
+	memcpy(buf, data, size);
+	if (big_endian) {
+		for (size_t i = 0; i < size / 2; i++) {
+			char t = buf[i]; buf[i] = buf[size - 1 - i]; buf[size - 1 - i] = t;
+		}
+	}
+	fwrite(buf, 1, size, f);
+}
+
+static ufbx_cache_frame make_frame(const char *path, uint64_t offset, ufbx_cache_data_format format, bool big_endian)
+{
+	ufbx_cache_frame frame = { 0 };
+	frame.filename.data = path;
+	frame.filename.length = strlen(path);
+	frame.data_format = format;
+	frame.data_encoding = big_endian ? UFBX_CACHE_DATA_ENCODING_BIG_ENDIAN : UFBX_CACHE_DATA_ENCODING_LITTLE_ENDIAN;
+	frame.data_offset = offset;
+	bool is_vec3 = format == UFBX_CACHE_DATA_FORMAT_VEC3_FLOAT || format == UFBX_CACHE_DATA_FORMAT_VEC3_DOUBLE;
+	frame.data_count = is_vec3 ? NUM_VALUES / 3 : NUM_VALUES;
+	return frame;
+}
+
+static void check_read(const ufbx_cache_frame *frame, bool is_double, size_t count, bool use_weight, bool additive)
+{
+	size_t num_values = frame->data_format == UFBX_CACHE_DATA_FORMAT_VEC3_FLOAT || frame->data_format == UFBX_CACHE_DATA_FORMAT_VEC3_DOUBLE
+		? NUM_VALUES / 3 * 3 : NUM_VALUES;
+
+	ufbx_real data[NUM_VALUES + 1];
+	for (size_t i = 0; i <= NUM_VALUES; i++) data[i] = (ufbx_real)i;
+
+	ufbx_geometry_cache_data_opts opts = { 0 };
+	opts.use_weight = use_weight;
+	opts.weight = (ufbx_real)0.75;
+	opts.additive = additive;
+	size_t num = ufbx_read_geometry_cache_real(frame, data, count, &opts);
+
+	size_t expected = count < num_values ? count : num_values;
+	test_check_eq(num, expected);
+	for (size_t i = 0; i <= NUM_VALUES; i++) {
+		ufbx_real ref = (ufbx_real)i;
+		if (i < num) {
+			ufbx_real v = is_double ? (ufbx_real)value_f64((uint32_t)i) : (ufbx_real)value_f32((uint32_t)i);
+			if (use_weight) v *= (ufbx_real)0.75;
+			ref = additive ? ref + v : v;
+		}
+		test_check(data[i] == ref);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	const char *path = "test_cache_read.bin";
+
+	// Four copies of the data: little/big endian floats, little/big endian doubles
+	uint64_t offsets[4];
+	FILE *f = fopen(path, "wb");
+	test_check(f);
+	fwrite("header", 1, 6, f);
+	for (int copy = 0; copy < 4; copy++) {
+		offsets[copy] = (uint64_t)ftell(f);
+		bool big_endian = (copy & 1) != 0;
+		for (uint32_t i = 0; i < NUM_VALUES; i++) {
+			if (copy < 2) {
+				float v = value_f32(i);
+				write_bytes(f, &v, sizeof(v), big_endian);
+			} else {
+				double v = value_f64(i);
+				write_bytes(f, &v, sizeof(v), big_endian);
+			}
+		}
+	}
+	fclose(f);
+
+	static const ufbx_cache_data_format float_formats[] = { UFBX_CACHE_DATA_FORMAT_REAL_FLOAT, UFBX_CACHE_DATA_FORMAT_VEC3_FLOAT };
+	static const ufbx_cache_data_format double_formats[] = { UFBX_CACHE_DATA_FORMAT_REAL_DOUBLE, UFBX_CACHE_DATA_FORMAT_VEC3_DOUBLE };
+
+	for (int copy = 0; copy < 4; copy++) {
+		bool is_double = copy >= 2;
+		bool big_endian = (copy & 1) != 0;
+		for (int vec = 0; vec < 2; vec++) {
+			ufbx_cache_data_format format = is_double ? double_formats[vec] : float_formats[vec];
+			ufbx_cache_frame frame = make_frame(path, offsets[copy], format, big_endian);
+
+			// Cover every tail length of the vectorized loop and partial reads
+			for (size_t count = 1; count <= NUM_VALUES; count++) {
+				for (int mode = 0; mode < 4; mode++) {
+					check_read(&frame, is_double, count, (mode & 1) != 0, (mode & 2) != 0);
+				}
+			}
+		}
+	}
+
+	// Truncated data returns only the values that could be read
+	{
+		ufbx_cache_frame frame = make_frame(path, offsets[3] + 8 * (NUM_VALUES - 5), UFBX_CACHE_DATA_FORMAT_REAL_DOUBLE, true);
+		ufbx_real data[NUM_VALUES];
+		test_check_eq(ufbx_read_geometry_cache_real(&frame, data, NUM_VALUES, NULL), 5);
+		test_check(data[0] == (ufbx_real)value_f64(NUM_VALUES - 5));
+	}
+
+	remove(path);
+	printf("test_cache_read: OK\n");
+	return 0;
+}
@@ -0,0 +1,126 @@
+#include "compact_vertex.h"
+#include "test.h"
+
+#include <math.h>
+#include <float.h>
+
+// Round trip of positions and normals through the compact vertex encoding,
+// every decoded value must stay within the precision of the format.
+
+static uint32_t rng_state = 1;
+static float rng_float(float min, float max)
+{
+	rng_state = rng_state * 1664525u + 1013904223u;
+	return min + (float)(rng_state >> 8) * (1.0f / 16777216.0f) * (max - min);
+}
+
+static float max_normal_error;
+
+static void check_normal(um_vec3 normal)
+{
+	int16_t encoded[2];
+	cv_encode_normal(encoded, normal);
+	um_vec3 decoded = cv_decode_normal(encoded);
+	test_check(fabsf(um_length3(decoded) - 1.0f) < 1e-5f);
+	float error = um_length3(um_sub3(decoded, um_normalize3(normal)));
+	if (error > max_normal_error) max_normal_error = error;
+	if (!(error <= CV_MAX_NORMAL_ERROR)) {
+		fprintf(stderr, "normal (%g, %g, %g): error %g\n", normal.x, normal.y, normal.z, error);
+	}
+	test_check(error <= CV_MAX_NORMAL_ERROR);
+}
+
+static void check_positions(const um_vec3 *positions, size_t count)
+{
+	um_vec3 min = um_dup3(FLT_MAX), max = um_dup3(-FLT_MAX);
+	for (size_t i = 0; i < count; i++) {
+		min = um_min3(min, positions[i]);
+		max = um_max3(max, positions[i]);
+	}
+	cv_bounds bounds = cv_make_bounds(min, max);
+	um_vec3 tolerance = cv_position_tolerance(&bounds);
+
+	for (size_t i = 0; i < count; i++) {
+		int16_t encoded[3];
+		cv_encode_position(encoded, positions[i], &bounds);
+		um_vec3 d = um_sub3(cv_decode_position(encoded, &bounds), positions[i]);
+		test_check(fabsf(d.x) <= tolerance.x);
+		test_check(fabsf(d.y) <= tolerance.y);
+		test_check(fabsf(d.z) <= tolerance.z);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	// Axis-aligned and diagonal directions
+	for (int x = -1; x <= 1; x++) {
+		for (int y = -1; y <= 1; y++) {
+			for (int z = -1; z <= 1; z++) {
+				if (x == 0 && y == 0 && z == 0) continue;
+				check_normal(um_v3((float)x, (float)y, (float)z));
+			}
+		}
+	}
+
+	// Around the seam between the +z and -z hemispheres, where the encoding folds
+	static const float seam_z[] = { 0.0f, -0.0f, 1e-7f, -1e-7f, 1e-4f, -1e-4f, 1e-2f, -1e-2f };
+	for (size_t i = 0; i < 360; i++) {
+		float angle = (float)i * (6.2831853f / 360.0f);
+		for (size_t j = 0; j < sizeof(seam_z) / sizeof(*seam_z); j++) {
+			check_normal(um_v3(cosf(angle), sinf(angle), seam_z[j]));
+		}
+	}
+
+	// Unnormalized and random directions
+	check_normal(um_v3(1e-15f, 0.0f, -1e-15f));
+	check_normal(um_v3(1e15f, -1e15f, 1e14f));
+	for (size_t i = 0; i < 200000; i++) {
+		um_vec3 n = um_v3(rng_float(-1.0f, 1.0f), rng_float(-1.0f, 1.0f), rng_float(-1.0f, 1.0f));
+		if (um_length3(n) < 1e-3f) continue;
+		check_normal(n);
+	}
+
+	// Zero normals still decode to a unit vector
+	{
+		int16_t encoded[2];
+		cv_encode_normal(encoded, um_zero3);
+		test_check(fabsf(um_length3(cv_decode_normal(encoded)) - 1.0f) < 1e-5f);
+	}
+
+	// Random positions with large and small extents far from the origin
+	static um_vec3 positions[1024];
+	static const float extents[] = { 1e-3f, 1.0f, 100.0f, 1e5f };
+	static const float offsets[] = { 0.0f, -10.0f, 1e4f };
+	for (size_t ei = 0; ei < sizeof(extents) / sizeof(*extents); ei++) {
+		for (size_t oi = 0; oi < sizeof(offsets) / sizeof(*offsets); oi++) {
+			float e = extents[ei], o = offsets[oi];
+			for (size_t i = 0; i < 1024; i++) {
+				positions[i] = um_v3(o + rng_float(-e, e), o + rng_float(-e, e) * 0.5f, o - rng_float(0.0f, e));
+			}
+			check_positions(positions, 1024);
+		}
+	}
+
+	// Degenerate bounds: A single point, a flat plane and a line
+	{
+		um_vec3 point[] = { um_v3(3.0f, -4.0f, 5.0f) };
+		check_positions(point, 1);
+
+		um_vec3 same[] = { um_v3(1.0f, 2.0f, 3.0f), um_v3(1.0f, 2.0f, 3.0f) };
+		check_positions(same, 2);
+
+		for (size_t i = 0; i < 256; i++) {
+			positions[i] = um_v3(rng_float(-2.0f, 2.0f), 7.0f, rng_float(-2.0f, 2.0f));
+		}
+		check_positions(positions, 256);
+
+		for (size_t i = 0; i < 256; i++) {
+			positions[i] = um_v3(-1.0f, 0.0f, rng_float(0.0f, 50.0f));
+		}
+		check_positions(positions, 256);
+	}
+
+	printf("max normal error: %g\n", max_normal_error);
+	printf("test_compact_vertex: OK\n");
+	return 0;
+}
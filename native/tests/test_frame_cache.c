@@ -0,0 +1,215 @@
+#include "ufbx.h"
+#include "test.h"
+
+#include <math.h>
+#include <string.h>
+
+// Looped playback of a small PC2 point cache through `ufbx_frame_cache`
+
+#define NUM_POINTS 64
+#define NUM_FRAMES 8
+
+static float point_value(int variant, uint32_t frame, uint32_t point, uint32_t axis)
+{
+	return (float)(variant * 1000 + frame * 10) + (float)point * 0.25f + (float)axis * 0.125f;
+}
+
+static void write_u32(FILE *f, uint32_t v) { fwrite(&v, 4, 1, f); }
+static void write_f32(FILE *f, float v) { fwrite(&v, 4, 1, f); }
+
+static void write_pc2(const char *path, int variant)
+{
+	FILE *f = fopen(path, "wb");
+	test_check(f);
+	fwrite("POINTCACHE2", 1, 12, f);
+	write_u32(f, 1);
+	write_u32(f, NUM_POINTS);
+	write_f32(f, 0.0f);
+	write_f32(f, 1.0f);
+	write_u32(f, NUM_FRAMES);
+	for (uint32_t frame = 0; frame < NUM_FRAMES; frame++) {
+		for (uint32_t point = 0; point < NUM_POINTS; point++) {
+			for (uint32_t axis = 0; axis < 3; axis++) {
+				write_f32(f, point_value(variant, frame, point, axis));
+			}
+		}
+	}
+	fclose(f);
+}
+
+static ufbx_geometry_cache *load_pc2(const char *path)
+{
+	ufbx_geometry_cache_opts opts = { 0 };
+	opts.frames_per_second = 30.0;
+	ufbx_error error;
+	ufbx_geometry_cache *cache = ufbx_load_geometry_cache(path, &opts, &error);
+	test_check(cache);
+	test_check_eq(cache->channels.count, 1);
+	test_check_eq(cache->channels.data[0].frames.count, NUM_FRAMES);
+	return cache;
+}
+
+static size_t num_opens;
+
+static bool counting_open_file(void *user, ufbx_stream *stream, const char *path, size_t path_len)
+{
+	num_opens++;
+	return ufbx_open_file(user, stream, path, path_len);
+}
+
+// Sample every frame once, `half` samples between frames to blend two cached frames
+static void play(const ufbx_cache_channel *channel, ufbx_frame_cache *frame_cache, int variant, bool half)
+{
+	ufbx_geometry_cache_data_opts opts = { 0 };
+	opts.frame_cache = frame_cache;
+	opts.open_file_cb.fn = &counting_open_file;
+
+	ufbx_vec3 data[NUM_POINTS];
+	uint32_t num_samples = half ? NUM_FRAMES - 1 : NUM_FRAMES;
+	for (uint32_t frame = 0; frame < num_samples; frame++) {
+		double time = ((double)frame + (half ? 0.5 : 0.0)) / 30.0;
+		size_t num = ufbx_sample_geometry_cache_vec3(channel, time, data, NUM_POINTS, &opts);
+		test_check_eq(num, NUM_POINTS);
+
+		for (uint32_t point = 0; point < NUM_POINTS; point++) {
+			for (uint32_t axis = 0; axis < 3; axis++) {
+				double ref = point_value(variant, frame, point, axis);
+				if (half) ref = (ref + point_value(variant, frame + 1, point, axis)) * 0.5;
+				test_check(fabs(data[point].v[axis] - ref) < 1e-3);
+			}
+		}
+	}
+}
+
+int main(int argc, char **argv)
+{
+	const char *path = "test_frame_cache.pc2";
+	write_pc2(path, 0);
+	ufbx_geometry_cache *cache = load_pc2(path);
+	const ufbx_cache_channel *channel = &cache->channels.data[0];
+
+	// Large budget: the first pass decodes every frame, later passes only hit memory
+	{
+		ufbx_frame_cache *frame_cache = ufbx_create_frame_cache(1 << 20, NULL, NULL);
+		test_check(frame_cache);
+
+		play(channel, frame_cache, 0, false);
+		ufbx_frame_cache_stats stats = ufbx_get_frame_cache_stats(frame_cache);
+		test_check_eq(stats.misses, NUM_FRAMES);
+		test_check_eq(stats.hits, 0);
+		test_check_eq(stats.num_frames, NUM_FRAMES);
+
+		for (int loop = 0; loop < 3; loop++) {
+			play(channel, frame_cache, 0, false);
+		}
+		play(channel, frame_cache, 0, true);
+		stats = ufbx_get_frame_cache_stats(frame_cache);
+		test_check_eq(stats.misses, NUM_FRAMES);
+		test_check_eq(stats.hits, 3 * NUM_FRAMES + 2 * (NUM_FRAMES - 1));
+		test_check_eq(stats.evictions, 0);
+
+		// Reading a frame directly bypasses the cache
+		ufbx_vec3 data[NUM_POINTS];
+		ufbx_geometry_cache_data_opts opts = { 0 };
+		opts.frame_cache = frame_cache;
+		test_check_eq(ufbx_read_geometry_cache_vec3(&channel->frames.data[1], data, NUM_POINTS, &opts), NUM_POINTS);
+		test_check(data[2].x == point_value(0, 1, 2, 0));
+		ufbx_frame_cache_stats after = ufbx_get_frame_cache_stats(frame_cache);
+		test_check_eq(after.hits, stats.hits);
+		test_check_eq(after.misses, stats.misses);
+
+		// Reloading the file gets a new cache identity so the stale frames are never returned
+		ufbx_free_geometry_cache(cache);
+		write_pc2(path, 1);
+		cache = load_pc2(path);
+		channel = &cache->channels.data[0];
+		play(channel, frame_cache, 1, false);
+		stats = ufbx_get_frame_cache_stats(frame_cache);
+		test_check_eq(stats.misses, 2 * NUM_FRAMES);
+
+		ufbx_clear_frame_cache(frame_cache);
+		stats = ufbx_get_frame_cache_stats(frame_cache);
+		test_check_eq(stats.num_frames, 0);
+		test_check_eq(stats.memory_used, 0);
+
+		ufbx_free_frame_cache(frame_cache);
+	}
+
+	// Budget of half the clip: LRU order evicts every frame before it loops around
+	{
+		ufbx_frame_cache *probe = ufbx_create_frame_cache(1 << 20, NULL, NULL);
+		play(channel, probe, 1, false);
+		size_t frame_size = ufbx_get_frame_cache_stats(probe).memory_used / NUM_FRAMES;
+		ufbx_free_frame_cache(probe);
+
+		ufbx_frame_cache *frame_cache = ufbx_create_frame_cache(frame_size * (NUM_FRAMES / 2), NULL, NULL);
+		test_check(frame_cache);
+		for (int loop = 0; loop < 2; loop++) {
+			play(channel, frame_cache, 1, false);
+		}
+		ufbx_frame_cache_stats stats = ufbx_get_frame_cache_stats(frame_cache);
+		test_check_eq(stats.hits, 0);
+		test_check_eq(stats.misses, 2 * NUM_FRAMES);
+		test_check_eq(stats.evictions, 2 * NUM_FRAMES - NUM_FRAMES / 2);
+		test_check_eq(stats.num_frames, NUM_FRAMES / 2);
+		test_check(stats.memory_used <= stats.memory_budget);
+		ufbx_free_frame_cache(frame_cache);
+	}
+
+	// Playing forwards keeps the file open and only skips ahead
+	{
+		ufbx_frame_cache *frame_cache = ufbx_create_frame_cache(1 << 20, NULL, NULL);
+		num_opens = 0;
+		play(channel, frame_cache, 1, false);
+		test_check_eq(num_opens, 1);
+
+		// Looping back to the start has to reopen the file
+		ufbx_clear_frame_cache(frame_cache);
+		play(channel, frame_cache, 1, false);
+		test_check_eq(num_opens, 2);
+		ufbx_free_frame_cache(frame_cache);
+	}
+
+	// Prefetching decodes the upcoming frames so sampling them only hits memory
+	{
+		ufbx_geometry_cache_data_opts opts = { 0 };
+		opts.open_file_cb.fn = &counting_open_file;
+
+		ufbx_frame_cache *probe = ufbx_create_frame_cache(1 << 20, NULL, NULL);
+		test_check_eq(ufbx_prefetch_frame_cache(probe, channel, 0.0, 1, &opts), 1);
+		size_t frame_size = ufbx_get_frame_cache_stats(probe).memory_used;
+		ufbx_free_frame_cache(probe);
+
+		ufbx_frame_cache *frame_cache = ufbx_create_frame_cache(frame_size * 5, NULL, NULL);
+		num_opens = 0;
+
+		// Starts from the frame before `time` and is limited by the budget
+		test_check_eq(ufbx_prefetch_frame_cache(frame_cache, channel, 1.5 / 30.0, NUM_FRAMES, &opts), 5);
+		test_check_eq(num_opens, 1);
+		ufbx_frame_cache_stats stats = ufbx_get_frame_cache_stats(frame_cache);
+		test_check_eq(stats.prefetched, 5);
+		test_check_eq(stats.misses, 0);
+		test_check_eq(stats.num_frames, 5);
+
+		// Frames already in the cache are not decoded again
+		test_check_eq(ufbx_prefetch_frame_cache(frame_cache, channel, 1.0 / 30.0, 3, &opts), 0);
+
+		ufbx_vec3 data[NUM_POINTS];
+		opts.frame_cache = frame_cache;
+		for (uint32_t frame = 1; frame < 6; frame++) {
+			test_check_eq(ufbx_sample_geometry_cache_vec3(channel, (double)frame / 30.0, data, NUM_POINTS, &opts), NUM_POINTS);
+			test_check(data[3].y == point_value(1, frame, 3, 1));
+		}
+		stats = ufbx_get_frame_cache_stats(frame_cache);
+		test_check_eq(stats.hits, 5);
+		test_check_eq(stats.misses, 0);
+		test_check_eq(stats.evictions, 0);
+		test_check_eq(num_opens, 1);
+		ufbx_free_frame_cache(frame_cache);
+	}
+
+	ufbx_free_geometry_cache(cache);
+	remove(path);
+	printf("test_frame_cache: OK\n");
+	return 0;
+}
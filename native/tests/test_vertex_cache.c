@@ -0,0 +1,138 @@
+#include "vertex_cache.h"
+#include "test.h"
+
+#include <string.h>
+
+// Optimizing a regular grid must keep every triangle with its winding and
+// lower the simulated cache miss ratio, both in row order and shuffled.
+
+#define GRID_SIZE 48
+#define NUM_VERTICES ((GRID_SIZE + 1) * (GRID_SIZE + 1))
+#define NUM_TRIANGLES (GRID_SIZE * GRID_SIZE * 2)
+#define NUM_INDICES (NUM_TRIANGLES * 3)
+
+typedef struct {
+	uint32_t id; // Original vertex index, survives `vc_optimize_fetch()`
+	float position[3];
+} grid_vertex;
+
+typedef struct {
+	uint32_t v[3];
+} triangle;
+
+static uint32_t rng_state = 1;
+static uint32_t rng_next()
+{
+	rng_state = rng_state * 1664525u + 1013904223u;
+	return rng_state >> 8;
+}
+
+static void make_grid(grid_vertex *vertices, uint32_t *indices)
+{
+	for (uint32_t y = 0; y <= GRID_SIZE; y++) {
+		for (uint32_t x = 0; x <= GRID_SIZE; x++) {
+			grid_vertex *v = &vertices[y * (GRID_SIZE + 1) + x];
+			v->id = y * (GRID_SIZE + 1) + x;
+			v->position[0] = (float)x;
+			v->position[1] = 0.0f;
+			v->position[2] = (float)y;
+		}
+	}
+
+	uint32_t *dst = indices;
+	for (uint32_t y = 0; y < GRID_SIZE; y++) {
+		for (uint32_t x = 0; x < GRID_SIZE; x++) {
+			uint32_t a = y * (GRID_SIZE + 1) + x, b = a + 1, c = a + GRID_SIZE + 1, d = c + 1;
+			*dst++ = a; *dst++ = c; *dst++ = b;
+			*dst++ = b; *dst++ = c; *dst++ = d;
+		}
+	}
+}
+
+// Triangle in terms of original vertex ids, rotated to start from the smallest to keep winding
+static triangle canonical_triangle(const grid_vertex *vertices, const uint32_t *indices)
+{
+	uint32_t a = vertices[indices[0]].id, b = vertices[indices[1]].id, c = vertices[indices[2]].id;
+	triangle t;
+	if (a < b && a < c) {
+		t.v[0] = a; t.v[1] = b; t.v[2] = c;
+	} else if (b < c) {
+		t.v[0] = b; t.v[1] = c; t.v[2] = a;
+	} else {
+		t.v[0] = c; t.v[1] = a; t.v[2] = b;
+	}
+	return t;
+}
+
+static int compare_triangle(const void *va, const void *vb)
+{
+	const triangle *a = (const triangle*)va, *b = (const triangle*)vb;
+	for (int i = 0; i < 3; i++) {
+		if (a->v[i] != b->v[i]) return a->v[i] < b->v[i] ? -1 : 1;
+	}
+	return 0;
+}
+
+static void sorted_triangles(triangle *dst, const grid_vertex *vertices, const uint32_t *indices)
+{
+	for (size_t i = 0; i < NUM_TRIANGLES; i++) {
+		dst[i] = canonical_triangle(vertices, indices + i * 3);
+	}
+	qsort(dst, NUM_TRIANGLES, sizeof(triangle), &compare_triangle);
+}
+
+static void check_optimize(bool shuffle)
+{
+	static grid_vertex vertices[NUM_VERTICES];
+	static uint32_t indices[NUM_INDICES];
+	static triangle before[NUM_TRIANGLES], after[NUM_TRIANGLES];
+
+	make_grid(vertices, indices);
+	if (shuffle) {
+		for (size_t i = NUM_TRIANGLES - 1; i > 0; i--) {
+			size_t j = rng_next() % (i + 1);
+			for (size_t k = 0; k < 3; k++) {
+				uint32_t t = indices[i * 3 + k]; indices[i * 3 + k] = indices[j * 3 + k]; indices[j * 3 + k] = t;
+			}
+		}
+	}
+	sorted_triangles(before, vertices, indices);
+
+	vc_stats original = vc_analyze(indices, NUM_INDICES, NUM_VERTICES);
+	vc_optimize_triangles(indices, NUM_INDICES, NUM_VERTICES);
+	vc_optimize_fetch(vertices, sizeof(grid_vertex), indices, NUM_INDICES, NUM_VERTICES);
+	vc_stats optimized = vc_analyze(indices, NUM_INDICES, NUM_VERTICES);
+
+	// Same triangles with the same winding, vertices moved as a whole
+	for (size_t i = 0; i < NUM_INDICES; i++) {
+		test_check(indices[i] < NUM_VERTICES);
+	}
+	for (size_t i = 0; i < NUM_VERTICES; i++) {
+		const grid_vertex *v = &vertices[i];
+		test_check(v->position[0] == (float)(v->id % (GRID_SIZE + 1)));
+		test_check(v->position[2] == (float)(v->id / (GRID_SIZE + 1)));
+	}
+	sorted_triangles(after, vertices, indices);
+	test_check(!memcmp(before, after, sizeof(before)));
+
+	// Fetch order follows first use
+	uint32_t next_vertex = 0;
+	for (size_t i = 0; i < NUM_INDICES; i++) {
+		test_check(indices[i] <= next_vertex);
+		if (indices[i] == next_vertex) next_vertex++;
+	}
+	test_check_eq(next_vertex, NUM_VERTICES);
+
+	printf("%s grid: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n", shuffle ? "shuffled" : "row order",
+		original.acmr, optimized.acmr, original.atvr, optimized.atvr);
+	test_check(optimized.acmr < original.acmr);
+	test_check(optimized.acmr < 0.8f);
+}
+
+int main(int argc, char **argv)
+{
+	check_optimize(false);
+	check_optimize(true);
+	printf("test_vertex_cache: OK\n");
+	return 0;
+}
@@ -0,0 +1,552 @@
+#define _CRT_SECURE_NO_WARNINGS
+
+#include "json_rpc.h"
+#include "external/json_input.h"
+#include "external/json_output.h"
+#include "external/sokol_config.h"
+#include "external/sokol_gfx.h"
+#include "external/umath.h"
+#include "external/cputime.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#if defined(_WIN32)
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+#else
+	#include <dirent.h>
+	#include <errno.h>
+	#include <sys/stat.h>
+	#include <time.h>
+#endif
+
+// Renders a PNG thumbnail of every FBX file in a directory through the same
+// RPC commands the web viewer uses and reports where the time goes.
+//
+//   thumbnail <input-dir> <output-dir> [--size N] [--threads N] [--prefetch N]
+//
+// `--threads` sets the number of viewer worker threads that build meshes and
+// rasterize tiles on the software renderer, one per core by default. The RPC
+// interface is single threaded, but files are read and submitted to
+// `loadSceneAsync` `--prefetch` files ahead (2 by default), so parsing the next
+// files overlaps with rendering the current one.
+
+typedef struct {
+	char **names;
+	size_t count;
+	size_t capacity;
+} file_list;
+
+static void file_list_push(file_list *list, const char *name)
+{
+	if (list->count == list->capacity) {
+		list->capacity = list->capacity ? list->capacity * 2 : 64;
+		list->names = (char**)realloc(list->names, list->capacity * sizeof(char*));
+	}
+	size_t len = strlen(name);
+	char *copy = (char*)malloc(len + 1);
+	memcpy(copy, name, len + 1);
+	list->names[list->count++] = copy;
+}
+
+static bool has_fbx_extension(const char *name)
+{
+	size_t len = strlen(name);
+	if (len < 4) return false;
+	const char *ext = name + len - 4;
+	return ext[0] == '.'
+		&& (ext[1] == 'f' || ext[1] == 'F')
+		&& (ext[2] == 'b' || ext[2] == 'B')
+		&& (ext[3] == 'x' || ext[3] == 'X');
+}
+
+static int compare_names(const void *a, const void *b)
+{
+	return strcmp(*(const char**)a, *(const char**)b);
+}
+
+static bool list_fbx_files(file_list *list, const char *dir)
+{
+#if defined(_WIN32)
+	char pattern[1024];
+	snprintf(pattern, sizeof(pattern), "%s\\*", dir);
+	WIN32_FIND_DATAA data;
+	HANDLE handle = FindFirstFileA(pattern, &data);
+	if (handle == INVALID_HANDLE_VALUE) return false;
+	do {
+		if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) continue;
+		if (has_fbx_extension(data.cFileName)) file_list_push(list, data.cFileName);
+	} while (FindNextFileA(handle, &data));
+	FindClose(handle);
+#else
+	DIR *d = opendir(dir);
+	if (!d) return false;
+	struct dirent *entry;
+	while ((entry = readdir(d)) != NULL) {
+		if (has_fbx_extension(entry->d_name)) file_list_push(list, entry->d_name);
+	}
+	closedir(d);
+#endif
+
+	if (list->count > 0) {
+		qsort(list->names, list->count, sizeof(char*), &compare_names);
+	}
+	return true;
+}
+
+static bool make_directory(const char *path)
+{
+#if defined(_WIN32)
+	return CreateDirectoryA(path, NULL) || GetLastError() == ERROR_ALREADY_EXISTS;
+#else
+	return mkdir(path, 0777) == 0 || errno == EEXIST;
+#endif
+}
+
+static void sleep_ms(uint32_t ms)
+{
+#if defined(_WIN32)
+	Sleep(ms);
+#else
+	struct timespec ts = { 0, (long)ms * 1000000 };
+	nanosleep(&ts, NULL);
+#endif
+}
+
+static void *read_file(const char *path, size_t *p_size)
+{
+	FILE *f = fopen(path, "rb");
+	if (!f) return NULL;
+	fseek(f, 0, SEEK_END);
+	long size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	void *data = size > 0 ? malloc((size_t)size) : NULL;
+	if (data && fread(data, 1, (size_t)size, f) != (size_t)size) {
+		free(data);
+		data = NULL;
+	}
+	fclose(f);
+	*p_size = data ? (size_t)size : 0;
+	return data;
+}
+
+// -- PNG output, uncompressed deflate is plenty for thumbnails
+
+static uint32_t crc_table[256];
+
+static void crc_init()
+{
+	for (uint32_t i = 0; i < 256; i++) {
+		uint32_t c = i;
+		for (uint32_t k = 0; k < 8; k++) {
+			c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+		}
+		crc_table[i] = c;
+	}
+}
+
+static uint32_t crc_update(uint32_t crc, const uint8_t *data, size_t size)
+{
+	for (size_t i = 0; i < size; i++) {
+		crc = crc_table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+	}
+	return crc;
+}
+
+static void write_be32(uint8_t *dst, uint32_t v)
+{
+	dst[0] = (uint8_t)(v >> 24);
+	dst[1] = (uint8_t)(v >> 16);
+	dst[2] = (uint8_t)(v >> 8);
+	dst[3] = (uint8_t)v;
+}
+
+static void write_png_chunk(FILE *f, const char *type, const uint8_t *data, size_t size)
+{
+	uint8_t header[8];
+	write_be32(header, (uint32_t)size);
+	memcpy(header + 4, type, 4);
+	uint32_t crc = crc_update(0xffffffffu, header + 4, 4);
+	if (size > 0) {
+		crc = crc_update(crc, data, size);
+	}
+
+	uint8_t footer[4];
+	write_be32(footer, crc ^ 0xffffffffu);
+	fwrite(header, 1, 8, f);
+	if (size > 0) {
+		fwrite(data, 1, size, f);
+	}
+	fwrite(footer, 1, 4, f);
+}
+
+// `pixels` are RGBA8 rows stored bottom first, as returned by `getPixels`
+static bool write_png(const char *path, const uint8_t *pixels, uint32_t width, uint32_t height)
+{
+	size_t stride = (size_t)width * 4;
+	size_t raw_size = (stride + 1) * height;
+	size_t max_block = 65535;
+	size_t num_blocks = raw_size > 0 ? (raw_size + max_block - 1) / max_block : 1;
+	size_t zlib_size = 2 + num_blocks * 5 + raw_size + 4;
+
+	uint8_t *raw = (uint8_t*)malloc(raw_size);
+	uint8_t *zlib = (uint8_t*)malloc(zlib_size);
+	if (!raw || !zlib) {
+		free(raw);
+		free(zlib);
+		return false;
+	}
+
+	for (uint32_t y = 0; y < height; y++) {
+		uint8_t *dst = raw + y * (stride + 1);
+		dst[0] = 0; // Filter: None
+		memcpy(dst + 1, pixels + (size_t)(height - 1 - y) * stride, stride);
+	}
+
+	uint8_t *dst = zlib;
+	*dst++ = 0x78;
+	*dst++ = 0x01;
+	uint32_t adler_a = 1, adler_b = 0;
+	for (size_t offset = 0, block = 0; block < num_blocks; block++) {
+		size_t len = raw_size - offset < max_block ? raw_size - offset : max_block;
+		*dst++ = block + 1 == num_blocks ? 1 : 0;
+		*dst++ = (uint8_t)len;
+		*dst++ = (uint8_t)(len >> 8);
+		*dst++ = (uint8_t)~len;
+		*dst++ = (uint8_t)(~len >> 8);
+		memcpy(dst, raw + offset, len);
+		for (size_t i = 0; i < len; i++) {
+			adler_a = (adler_a + dst[i]) % 65521;
+			adler_b = (adler_b + adler_a) % 65521;
+		}
+		dst += len;
+		offset += len;
+	}
+	write_be32(dst, adler_b << 16 | adler_a);
+	dst += 4;
+
+	FILE *f = fopen(path, "wb");
+	if (f) {
+		static const uint8_t signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+		uint8_t ihdr[13];
+		write_be32(ihdr + 0, width);
+		write_be32(ihdr + 4, height);
+		ihdr[8] = 8;  // Bit depth
+		ihdr[9] = 6;  // Color type: RGBA
+		ihdr[10] = 0; // Compression
+		ihdr[11] = 0; // Filter
+		ihdr[12] = 0; // Interlace
+
+		fwrite(signature, 1, sizeof(signature), f);
+		write_png_chunk(f, "IHDR", ihdr, sizeof(ihdr));
+		write_png_chunk(f, "IDAT", zlib, (size_t)(dst - zlib));
+		write_png_chunk(f, "IEND", NULL, 0);
+		fclose(f);
+	}
+
+	free(raw);
+	free(zlib);
+	return f != NULL;
+}
+
+// -- RPC
+
+static jso_stream begin_request(const char *cmd)
+{
+	jso_stream s;
+	jso_init_growable(&s);
+	jso_object(&s);
+	jso_prop_string(&s, "cmd", cmd);
+	return s;
+}
+
+// Returns the parsed response or NULL if the command failed
+static jsi_value *submit_request(jso_stream *s)
+{
+	jso_end_object(s);
+	char *json = jso_close_growable(s);
+	const char *result = rpc_call(json, NULL);
+
+	jsi_args args = {
+		.store_integers_as_int64 = true,
+	};
+	jsi_value *value = jsi_parse_string(result, &args);
+	if (!value) return NULL;
+
+	const char *error = jsi_get_str(jsi_as_obj(value), "error", NULL);
+	if (error) {
+		fprintf(stderr, "  %s\n", error);
+		jsi_free(value);
+		return NULL;
+	}
+	return value;
+}
+
+static um_vec3 parse_vec3(jsi_obj *obj, const char *name)
+{
+	jsi_obj *v = jsi_get_obj(obj, name);
+	return um_v3(
+		(float)jsi_get_double(v, "x", 0.0),
+		(float)jsi_get_double(v, "y", 0.0),
+		(float)jsi_get_double(v, "z", 0.0));
+}
+
+static void serialize_vec3(jso_stream *s, const char *name, um_vec3 v)
+{
+	jso_prop_object(s, name);
+	jso_single_line(s);
+	jso_prop_double(s, "x", v.x);
+	jso_prop_double(s, "y", v.y);
+	jso_prop_double(s, "z", v.z);
+	jso_end_object(s);
+}
+
+typedef struct {
+	double load_time;
+	double prep_time;
+	double render_time;
+	int64_t triangles;
+} thumbnail_stats;
+
+static double seconds_since(uint64_t begin)
+{
+	return cputime_cpu_delta_to_sec(NULL, cputime_cpu_tick() - begin);
+}
+
+// Read `src_path` and start parsing it in the background as `scene_name`
+static bool start_load(const char *src_path, const char *scene_name)
+{
+	size_t data_size = 0;
+	void *data = read_file(src_path, &data_size);
+	if (!data) {
+		fprintf(stderr, "  Failed to read '%s'\n", src_path);
+		return false;
+	}
+
+	// `loadSceneAsync` takes ownership of `data` even on failure
+	jso_stream s = begin_request("loadSceneAsync");
+	jso_prop_string(&s, "name", scene_name);
+	jso_prop_int64(&s, "dataPointer", (int64_t)(intptr_t)data);
+	jso_prop_int64(&s, "size", (int64_t)data_size);
+	jsi_value *res = submit_request(&s);
+	if (!res) return false;
+	jsi_free(res);
+	return true;
+}
+
+// Wait for `start_load()` to finish parsing `scene_name`
+static bool finish_load(const char *scene_name)
+{
+	for (;;) {
+		jso_stream s = begin_request("pollScene");
+		jso_prop_string(&s, "sceneName", scene_name);
+		jsi_value *res = submit_request(&s);
+		if (!res) return false;
+		const char *state = jsi_get_str(jsi_as_obj(res), "state", "");
+		bool loading = !strcmp(state, "loading");
+		bool loaded = !strcmp(state, "loaded");
+		jsi_free(res);
+		if (!loading) return loaded;
+		sleep_ms(1);
+	}
+}
+
+static bool render_thumbnail(const char *scene_name, const char *dst_path, uint32_t size, thumbnail_stats *stats)
+{
+	// Load: wait for the background parse started by `start_load()`
+	uint64_t load_begin = cputime_cpu_tick();
+	if (!finish_load(scene_name)) return false;
+	stats->load_time = seconds_since(load_begin);
+
+	// Prep: build the GPU meshes and fetch the bounds to frame the camera
+	uint64_t prep_begin = cputime_cpu_tick();
+	um_vec3 bounds_min = um_zero3, bounds_max = um_zero3;
+	{
+		jso_stream s = begin_request("getSceneStats");
+		jso_prop_string(&s, "sceneName", scene_name);
+		jsi_value *res = submit_request(&s);
+		if (!res) return false;
+		jsi_obj *bounds = jsi_get_obj(jsi_as_obj(res), "bounds");
+		if (bounds) {
+			bounds_min = parse_vec3(bounds, "min");
+			bounds_max = parse_vec3(bounds, "max");
+		}
+		jsi_free(res);
+	}
+	stats->prep_time = seconds_since(prep_begin);
+
+	float fov = 30.0f;
+	um_vec3 center = um_mul3(um_add3(bounds_min, bounds_max), 0.5f);
+	float radius = um_max(um_length3(um_sub3(bounds_max, bounds_min)) * 0.5f, 0.001f);
+	float distance = radius / sinf(fov * 0.5f * UM_PI / 180.0f) * 1.1f;
+	um_vec3 eye = um_add3(center, um_mul3(um_normalize3(um_v3(1.0f, 0.6f, 1.0f)), distance));
+
+	uint64_t render_begin = cputime_cpu_tick();
+	{
+		jso_stream s = begin_request("render");
+		jso_prop_object(&s, "target");
+		jso_prop_int(&s, "targetIndex", 0);
+		jso_prop_int(&s, "width", (int)size);
+		jso_prop_int(&s, "height", (int)size);
+		jso_end_object(&s);
+		jso_prop_object(&s, "desc");
+		jso_prop_string(&s, "sceneName", scene_name);
+		jso_prop_object(&s, "camera");
+		serialize_vec3(&s, "position", eye);
+		serialize_vec3(&s, "target", center);
+		jso_prop_double(&s, "fieldOfView", fov);
+		jso_prop_double(&s, "nearPlane", um_max(distance - radius * 2.0f, distance * 0.001f));
+		jso_prop_double(&s, "farPlane", distance + radius * 2.0f);
+		jso_end_object(&s);
+		jso_end_object(&s);
+		jsi_value *res = submit_request(&s);
+		if (!res) return false;
+		jsi_obj *render_stats = jsi_get_obj(jsi_as_obj(res), "stats");
+		stats->triangles = jsi_get_int64(render_stats, "triangles", 0);
+		jsi_free(res);
+	}
+
+	bool ok = false;
+	{
+		jso_stream s = begin_request("getPixels");
+		jso_prop_int(&s, "targetIndex", 0);
+		jso_prop_int(&s, "width", (int)size);
+		jso_prop_int(&s, "height", (int)size);
+		jsi_value *res = submit_request(&s);
+		if (!res) return false;
+		const uint8_t *pixels = (const uint8_t*)(intptr_t)jsi_get_int64(jsi_as_obj(res), "dataPointer", 0);
+		stats->render_time = seconds_since(render_begin);
+		ok = pixels && write_png(dst_path, pixels, size, size);
+		if (!ok) fprintf(stderr, "  Failed to write '%s'\n", dst_path);
+		jsi_free(res);
+	}
+
+	return ok;
+}
+
+static void usage()
+{
+	fprintf(stderr, "Usage: thumbnail <input-dir> <output-dir> [--size N] [--threads N] [--prefetch N]\n");
+}
+
+int main(int argc, char **argv)
+{
+	const char *input_dir = NULL;
+	const char *output_dir = NULL;
+	uint32_t size = 256;
+	int num_threads = 0;
+	int num_prefetch = 2;
+
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "--size") && i + 1 < argc) {
+			size = (uint32_t)atoi(argv[++i]);
+		} else if (!strcmp(argv[i], "--threads") && i + 1 < argc) {
+			num_threads = atoi(argv[++i]);
+		} else if (!strcmp(argv[i], "--prefetch") && i + 1 < argc) {
+			num_prefetch = atoi(argv[++i]);
+		} else if (!input_dir) {
+			input_dir = argv[i];
+		} else if (!output_dir) {
+			output_dir = argv[i];
+		} else {
+			usage();
+			return 1;
+		}
+	}
+	if (!input_dir || !output_dir || size == 0 || size > 4096 || num_prefetch < 0 || num_prefetch > 8) {
+		usage();
+		return 1;
+	}
+
+	file_list files = { 0 };
+	if (!list_fbx_files(&files, input_dir)) {
+		fprintf(stderr, "Failed to open directory '%s'\n", input_dir);
+		return 1;
+	}
+	if (!make_directory(output_dir)) {
+		fprintf(stderr, "Failed to create directory '%s'\n", output_dir);
+		return 1;
+	}
+
+	cputime_init();
+	crc_init();
+
+	sg_setup(&(sg_desc) {
+		.context.color_format = SG_PIXELFORMAT_RGBA8,
+		.context.depth_format = SG_PIXELFORMAT_DEPTH_STENCIL,
+	});
+
+	{
+		jso_stream s = begin_request("init");
+		if (num_threads > 0) {
+			jso_prop_int(&s, "numThreads", num_threads);
+		}
+		jsi_value *res = submit_request(&s);
+		if (res) {
+			num_threads = (int)jsi_get_int64(jsi_as_obj(res), "numThreads", 1);
+			jsi_free(res);
+		}
+	}
+
+	printf("%zu files, %ux%u, %d threads, %d prefetched\n", files.count, size, size, num_threads, num_prefetch);
+
+	uint64_t total_begin = cputime_cpu_tick();
+	double total_load = 0.0, total_prep = 0.0, total_render = 0.0;
+	size_t num_ok = 0;
+
+	// File `i` is loaded as scene `i % num_slots`, so starting a load only ever
+	// replaces the scene of a file that has already been rendered.
+	size_t num_slots = (size_t)num_prefetch + 1;
+	bool *started = (bool*)calloc(files.count, sizeof(bool));
+	size_t num_started = 0;
+
+	for (size_t i = 0; i < files.count; i++) {
+		for (; num_started < files.count && num_started <= i + (size_t)num_prefetch; num_started++) {
+			char src_path[1024], scene_name[32];
+			snprintf(src_path, sizeof(src_path), "%s/%s", input_dir, files.names[num_started]);
+			snprintf(scene_name, sizeof(scene_name), "thumbnail%zu", num_started % num_slots);
+			started[num_started] = start_load(src_path, scene_name);
+		}
+
+		const char *name = files.names[i];
+		char dst_path[1024], scene_name[32];
+		snprintf(dst_path, sizeof(dst_path), "%s/%.*s.png", output_dir, (int)(strlen(name) - 4), name);
+		snprintf(scene_name, sizeof(scene_name), "thumbnail%zu", i % num_slots);
+
+		thumbnail_stats stats = { 0 };
+		printf("%s\n", name);
+		fflush(stdout);
+		if (!started[i] || !render_thumbnail(scene_name, dst_path, size, &stats)) continue;
+
+		printf("  load %8.2fms  prep %8.2fms  render %8.2fms  %lld triangles\n",
+			stats.load_time * 1e3, stats.prep_time * 1e3, stats.render_time * 1e3, (long long)stats.triangles);
+		total_load += stats.load_time;
+		total_prep += stats.prep_time;
+		total_render += stats.render_time;
+		num_ok++;
+	}
+	free(started);
+
+	{
+		jso_stream s = begin_request("freeResources");
+		jso_prop_boolean(&s, "scenes", true);
+		jsi_value *res = submit_request(&s);
+		if (res) jsi_free(res);
+	}
+
+	double total_time = seconds_since(total_begin);
+	printf("\n%zu/%zu thumbnails in %.2fs (%.2f files/s)\n", num_ok, files.count, total_time,
+		total_time > 0.0 ? (double)num_ok / total_time : 0.0);
+	printf("  load %.2fs  prep %.2fs  render %.2fs\n", total_load, total_prep, total_render);
+
+	for (size_t i = 0; i < files.count; i++) {
+		free(files.names[i]);
+	}
+	free(files.names);
+
+	sg_shutdown();
+	return num_ok == files.count ? 0 : 1;
+}
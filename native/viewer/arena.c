@@ -131,7 +131,7 @@ arena_t *arena_create(arena_t *parent)
             return NULL;
         }
     } else {
-        a = (arenaimp_t*)malloc(sizeof(a) + ARENAIMP_EXTRA_SIZE);
+        a = (arenaimp_t*)malloc(sizeof(arenaimp_t) + ARENAIMP_EXTRA_SIZE);
         if (!a) return NULL;
         memset(a, 0, sizeof(arenaimp_t));
     }
@@ -164,14 +164,17 @@ void arena_free(arena_t *arena)
 	arenaimp_t *a = (arenaimp_t*)arena;
     if (!a) return;
     assert(a->magic == ARENAIMP_MAGIC_ARENA);
-    a->magic = ARENAIMP_MAGIC_FREE;
 
+    // Child arenas cancel their slot in the parent when freed, so the arena
+    // must stay valid and the next slot must be read before running the defer.
     size_t slot = a->active_defer_head;
-    arenaimp_defer_slot *defers = a->defers;
     while (slot != SIZE_MAX) {
-        defers[slot].fn(defers[slot].user);
-        slot = defers[slot].next;
+        arenaimp_defer_slot *ds = &a->defers[slot];
+        size_t next = ds->next;
+        ds->fn(ds->user);
+        slot = next;
     }
+    a->magic = ARENAIMP_MAGIC_FREE;
 
     arenaimp_big_header *alloc = a->big_head.next;
     arenaimp_big_header *last = &a->big_tail;
@@ -352,9 +355,11 @@ void *aalloc_uninit_size(arena_t *arena, size_t size, size_t count)
 				arenaimp_small_header *alloc = (arenaimp_small_header*)new_page;
                 alloc->active.capacity = total;
 
-                if (page_size - total_small > a->size - a->pos) {
+                // Reserve the whole chunk, the block may be reused for any size
+                // in its class once freed. This also keeps the next block aligned.
+                if (page_size - chunk > a->size - a->pos) {
 					a->page = (char*)new_page;
-					a->pos = total_small;
+					a->pos = chunk;
 					a->size = page_size;
                 }
                 return alloc + 1;
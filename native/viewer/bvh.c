@@ -0,0 +1,320 @@
+#include "bvh.h"
+#include <string.h>
+#include <float.h>
+
+enum {
+	BVH_NUM_BINS = 16,
+	BVH_MAX_LEAF_TRIANGLES = 4,
+	BVH_MAX_DEPTH = 64,
+};
+
+typedef struct {
+	um_vec3 min, max;
+} bvh_bounds;
+
+typedef struct {
+	bvh_bounds bounds;
+	uint32_t count;
+} bvh_bin;
+
+typedef struct {
+	bvh_node *nodes;
+	size_t num_nodes;
+	const um_vec3 *positions;
+	bvh_bounds *tri_bounds;
+	um_vec3 *centroids;
+	uint32_t *order;
+} bvh_builder;
+
+static bvh_bounds bvh_empty_bounds()
+{
+	return (bvh_bounds){ um_dup3(FLT_MAX), um_dup3(-FLT_MAX) };
+}
+
+static void bvh_bounds_add(bvh_bounds *b, const bvh_bounds *a)
+{
+	b->min = um_min3(b->min, a->min);
+	b->max = um_max3(b->max, a->max);
+}
+
+static float bvh_bounds_area(const bvh_bounds *b)
+{
+	um_vec3 d = um_sub3(b->max, b->min);
+	if (d.x < 0.0f || d.y < 0.0f || d.z < 0.0f) return 0.0f;
+	return d.x*d.y + d.y*d.z + d.z*d.x;
+}
+
+static void bvh_build_node(bvh_builder *bb, size_t node_ix, uint32_t begin, uint32_t end, uint32_t depth)
+{
+	bvh_node *node = &bb->nodes[node_ix];
+
+	bvh_bounds bounds = bvh_empty_bounds();
+	bvh_bounds centroid_bounds = bvh_empty_bounds();
+	for (uint32_t i = begin; i < end; i++) {
+		uint32_t tri = bb->order[i];
+		bvh_bounds_add(&bounds, &bb->tri_bounds[tri]);
+		centroid_bounds.min = um_min3(centroid_bounds.min, bb->centroids[tri]);
+		centroid_bounds.max = um_max3(centroid_bounds.max, bb->centroids[tri]);
+	}
+	node->min = bounds.min;
+	node->max = bounds.max;
+
+	uint32_t count = end - begin;
+	if (count <= BVH_MAX_LEAF_TRIANGLES || depth >= BVH_MAX_DEPTH) {
+		node->index = begin;
+		node->count = count;
+		return;
+	}
+
+	// Find the best split plane over binned centroids of all three axes
+	float leaf_cost = (float)count * bvh_bounds_area(&bounds);
+	float best_cost = FLT_MAX;
+	int best_axis = -1;
+	uint32_t best_bin = 0;
+
+	for (int axis = 0; axis < 3; axis++) {
+		float lo = centroid_bounds.min.v[axis], hi = centroid_bounds.max.v[axis];
+		if (!(hi > lo)) continue;
+		float scale = (float)BVH_NUM_BINS / (hi - lo);
+
+		bvh_bin bins[BVH_NUM_BINS];
+		for (size_t i = 0; i < BVH_NUM_BINS; i++) {
+			bins[i].bounds = bvh_empty_bounds();
+			bins[i].count = 0;
+		}
+		for (uint32_t i = begin; i < end; i++) {
+			uint32_t tri = bb->order[i];
+			int bin = (int)((bb->centroids[tri].v[axis] - lo) * scale);
+			if (bin >= BVH_NUM_BINS) bin = BVH_NUM_BINS - 1;
+			bins[bin].count++;
+			bvh_bounds_add(&bins[bin].bounds, &bb->tri_bounds[tri]);
+		}
+
+		// Sweep from the right to get the cost of each suffix
+		float right_area[BVH_NUM_BINS];
+		uint32_t right_count[BVH_NUM_BINS];
+		bvh_bounds acc = bvh_empty_bounds();
+		uint32_t acc_count = 0;
+		for (size_t i = BVH_NUM_BINS - 1; i > 0; i--) {
+			bvh_bounds_add(&acc, &bins[i].bounds);
+			acc_count += bins[i].count;
+			right_area[i] = bvh_bounds_area(&acc);
+			right_count[i] = acc_count;
+		}
+
+		acc = bvh_empty_bounds();
+		acc_count = 0;
+		for (size_t i = 0; i < BVH_NUM_BINS - 1; i++) {
+			bvh_bounds_add(&acc, &bins[i].bounds);
+			acc_count += bins[i].count;
+			if (acc_count == 0 || right_count[i + 1] == 0) continue;
+			float cost = (float)acc_count * bvh_bounds_area(&acc) + (float)right_count[i + 1] * right_area[i + 1];
+			if (cost < best_cost) {
+				best_cost = cost;
+				best_axis = axis;
+				best_bin = (uint32_t)i;
+			}
+		}
+	}
+
+	uint32_t mid = begin;
+	if (best_axis >= 0 && best_cost < leaf_cost) {
+		float lo = centroid_bounds.min.v[best_axis], hi = centroid_bounds.max.v[best_axis];
+		float scale = (float)BVH_NUM_BINS / (hi - lo);
+		uint32_t j = end;
+		for (uint32_t i = begin; i < j; ) {
+			uint32_t tri = bb->order[i];
+			int bin = (int)((bb->centroids[tri].v[best_axis] - lo) * scale);
+			if (bin >= BVH_NUM_BINS) bin = BVH_NUM_BINS - 1;
+			if ((uint32_t)bin <= best_bin) {
+				i++;
+			} else {
+				j--;
+				bb->order[i] = bb->order[j];
+				bb->order[j] = tri;
+			}
+		}
+		mid = j;
+	} else if (count > BVH_MAX_LEAF_TRIANGLES * 4) {
+		// Splitting doesn't pay off by SAH or all centroids coincide, split
+		// in the middle anyway to keep leaves small enough to scan.
+		mid = begin + count / 2;
+	}
+
+	if (mid == begin || mid == end) {
+		node->index = begin;
+		node->count = count;
+		return;
+	}
+
+	size_t left_ix = bb->num_nodes;
+	bb->num_nodes += 2;
+	node->index = (uint32_t)left_ix;
+	node->count = 0;
+
+	bvh_build_node(bb, left_ix + 0, begin, mid, depth + 1);
+	bvh_build_node(bb, left_ix + 1, mid, end, depth + 1);
+}
+
+bool bvh_build(bvh_t *bvh, arena_t *arena, const um_vec3 *positions, size_t num_triangles)
+{
+	memset(bvh, 0, sizeof(bvh_t));
+	if (num_triangles == 0 || num_triangles >= UINT32_MAX / 2) return false;
+
+	arena_t tmp;
+	arena_init(&tmp, NULL);
+
+	bvh_builder bb = { 0 };
+	bb.positions = positions;
+	bb.nodes = aalloc_uninit(arena, bvh_node, num_triangles * 2);
+	bb.tri_bounds = aalloc_uninit(&tmp, bvh_bounds, num_triangles);
+	bb.centroids = aalloc_uninit(&tmp, um_vec3, num_triangles);
+	bb.order = aalloc_uninit(arena, uint32_t, num_triangles);
+	if (!bb.nodes || !bb.tri_bounds || !bb.centroids || !bb.order) {
+		arena_free(&tmp);
+		return false;
+	}
+
+	for (size_t i = 0; i < num_triangles; i++) {
+		um_vec3 a = positions[i*3 + 0], b = positions[i*3 + 1], c = positions[i*3 + 2];
+		bb.tri_bounds[i].min = um_min3(um_min3(a, b), c);
+		bb.tri_bounds[i].max = um_max3(um_max3(a, b), c);
+		bb.centroids[i] = um_mul3(um_add3(bb.tri_bounds[i].min, bb.tri_bounds[i].max), 0.5f);
+		bb.order[i] = (uint32_t)i;
+	}
+
+	bb.num_nodes = 1;
+	bvh_build_node(&bb, 0, 0, (uint32_t)num_triangles, 0);
+
+	// Store corners in leaf order so leaves can be scanned linearly
+	um_vec3 *sorted = aalloc_uninit(arena, um_vec3, num_triangles * 3);
+	if (!sorted) {
+		arena_free(&tmp);
+		return false;
+	}
+	for (size_t i = 0; i < num_triangles; i++) {
+		memcpy(sorted + i*3, positions + bb.order[i]*3, 3 * sizeof(um_vec3));
+	}
+
+	bvh->nodes = bb.nodes;
+	bvh->num_nodes = bb.num_nodes;
+	bvh->positions = sorted;
+	bvh->triangle_ids = bb.order;
+	bvh->num_triangles = num_triangles;
+
+	arena_free(&tmp);
+	return true;
+}
+
+bool bvh_copy(bvh_t *dst, arena_t *arena, const bvh_t *src)
+{
+	memset(dst, 0, sizeof(bvh_t));
+	if (!src->nodes) return false;
+
+	bvh_node *nodes = aalloc_copy(arena, bvh_node, src->num_nodes, src->nodes);
+	um_vec3 *positions = aalloc_copy(arena, um_vec3, src->num_triangles * 3, src->positions);
+	uint32_t *triangle_ids = aalloc_copy(arena, uint32_t, src->num_triangles, src->triangle_ids);
+	if (!nodes || !positions || !triangle_ids) return false;
+
+	dst->nodes = nodes;
+	dst->num_nodes = src->num_nodes;
+	dst->positions = positions;
+	dst->triangle_ids = triangle_ids;
+	dst->num_triangles = src->num_triangles;
+	return true;
+}
+
+size_t bvh_memory_size(const bvh_t *bvh)
+{
+	return bvh->num_nodes * sizeof(bvh_node) + bvh->num_triangles * (3 * sizeof(um_vec3) + sizeof(uint32_t));
+}
+
+static bool bvh_ray_box(const bvh_node *node, um_vec3 origin, um_vec3 rcp_dir, float max_t, float *p_t)
+{
+	float t0 = 0.0f, t1 = max_t;
+	for (int axis = 0; axis < 3; axis++) {
+		float a = (node->min.v[axis] - origin.v[axis]) * rcp_dir.v[axis];
+		float b = (node->max.v[axis] - origin.v[axis]) * rcp_dir.v[axis];
+		if (a > b) { float t = a; a = b; b = t; }
+		// NaN from `0 * inf` compares false and keeps the previous bounds
+		if (a > t0) t0 = a;
+		if (b < t1) t1 = b;
+	}
+	*p_t = t0;
+	return t0 <= t1;
+}
+
+bool bvh_ray_bounds(um_vec3 min, um_vec3 max, um_vec3 origin, um_vec3 direction, float max_t)
+{
+	bvh_node node = { .min = min, .max = max };
+	float t;
+	return bvh_ray_box(&node, origin, um_rcp3(direction), max_t, &t);
+}
+
+bool bvh_raycast(const bvh_t *bvh, um_vec3 origin, um_vec3 direction, bvh_hit *hit)
+{
+	if (!bvh->nodes) return false;
+
+	um_vec3 rcp_dir = um_rcp3(direction);
+	bool found = false;
+
+	uint32_t stack[BVH_MAX_DEPTH * 2 + 2];
+	size_t depth = 0;
+
+	float root_t;
+	if (!bvh_ray_box(&bvh->nodes[0], origin, rcp_dir, hit->t, &root_t)) return false;
+	stack[depth++] = 0;
+
+	while (depth > 0) {
+		const bvh_node *node = &bvh->nodes[stack[--depth]];
+
+		if (node->count > 0) {
+			for (uint32_t i = node->index; i < node->index + node->count; i++) {
+				// Möller-Trumbore
+				um_vec3 a = bvh->positions[i*3 + 0];
+				um_vec3 e1 = um_sub3(bvh->positions[i*3 + 1], a);
+				um_vec3 e2 = um_sub3(bvh->positions[i*3 + 2], a);
+				um_vec3 p = um_cross3(direction, e2);
+				float det = um_dot3(e1, p);
+				if (um_abs(det) < 1e-20f) continue;
+				float rcp_det = 1.0f / det;
+				um_vec3 s = um_sub3(origin, a);
+				float u = um_dot3(s, p) * rcp_det;
+				if (u < 0.0f || u > 1.0f) continue;
+				um_vec3 q = um_cross3(s, e1);
+				float v = um_dot3(direction, q) * rcp_det;
+				if (v < 0.0f || u + v > 1.0f) continue;
+				float t = um_dot3(e2, q) * rcp_det;
+				if (t < 0.0f || t >= hit->t) continue;
+
+				hit->t = t;
+				hit->u = u;
+				hit->v = v;
+				hit->triangle_id = bvh->triangle_ids[i];
+				found = true;
+			}
+			continue;
+		}
+
+		// Push the farther child first so the nearer one is visited first
+		uint32_t left = node->index, right = node->index + 1;
+		float left_t, right_t;
+		bool hit_left = bvh_ray_box(&bvh->nodes[left], origin, rcp_dir, hit->t, &left_t);
+		bool hit_right = bvh_ray_box(&bvh->nodes[right], origin, rcp_dir, hit->t, &right_t);
+		if (hit_left && hit_right) {
+			if (left_t <= right_t) {
+				stack[depth++] = right;
+				stack[depth++] = left;
+			} else {
+				stack[depth++] = left;
+				stack[depth++] = right;
+			}
+		} else if (hit_left) {
+			stack[depth++] = left;
+		} else if (hit_right) {
+			stack[depth++] = right;
+		}
+	}
+
+	return found;
+}
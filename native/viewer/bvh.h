@@ -0,0 +1,48 @@
+#pragma once
+
+#include "arena.h"
+#include "external/umath.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef struct bvh_node {
+	um_vec3 min;
+	uint32_t index; // Leaf: first triangle, internal: left child (right child is `index + 1`)
+	um_vec3 max;
+	uint32_t count; // Leaf: number of triangles, internal: 0
+} bvh_node;
+
+typedef struct bvh_t {
+	bvh_node *nodes;
+	size_t num_nodes;
+
+	// Triangle corners in leaf order and the original index of each triangle
+	um_vec3 *positions;
+	uint32_t *triangle_ids;
+	size_t num_triangles;
+} bvh_t;
+
+typedef struct bvh_hit {
+	uint32_t triangle_id;
+	float t;
+	float u, v; // Barycentric weights of the second and third corner
+} bvh_hit;
+
+// Build a binned SAH BVH over `num_triangles` triangles stored as three
+// consecutive corners in `positions`. All memory is allocated from `arena`.
+bool bvh_build(bvh_t *bvh, arena_t *arena, const um_vec3 *positions, size_t num_triangles);
+
+// Copy `src` to `dst` allocating all memory from `arena`.
+bool bvh_copy(bvh_t *dst, arena_t *arena, const bvh_t *src);
+
+// Size of the memory referenced by `bvh` in bytes.
+size_t bvh_memory_size(const bvh_t *bvh);
+
+// Find the closest intersection of `origin + t * direction` for `0 <= t < hit->t`.
+// Initialize `hit->t` to the maximum distance. Returns `true` and updates `hit`
+// if a closer triangle was found. Triangles are treated as double sided.
+bool bvh_raycast(const bvh_t *bvh, um_vec3 origin, um_vec3 direction, bvh_hit *hit);
+
+// Returns `true` if `origin + t * direction` enters the box `min..max` for some `0 <= t <= max_t`.
+bool bvh_ray_bounds(um_vec3 min, um_vec3 max, um_vec3 origin, um_vec3 direction, float max_t);
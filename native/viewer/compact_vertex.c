@@ -0,0 +1,71 @@
+#include "compact_vertex.h"
+#include <math.h>
+#include <float.h>
+
+cv_bounds cv_make_bounds(um_vec3 min, um_vec3 max)
+{
+	cv_bounds bounds;
+	bounds.offset = um_mul3(um_add3(min, max), 0.5f);
+	bounds.scale = um_max3(um_mul3(um_sub3(max, min), 0.5f), um_dup3(FLT_MIN));
+	return bounds;
+}
+
+um_vec3 cv_position_tolerance(const cv_bounds *bounds)
+{
+	um_vec3 abs_offset = um_v3(um_abs(bounds->offset.x), um_abs(bounds->offset.y), um_abs(bounds->offset.z));
+	return um_add3(
+		um_mul3(bounds->scale, 2.0f / 32768.0f),
+		um_mul3(um_add3(abs_offset, bounds->scale), 4.0f * FLT_EPSILON));
+}
+
+int16_t cv_quantize_snorm16(float v)
+{
+	return (int16_t)lrintf(um_clamp(v, -1.0f, 1.0f) * 32767.0f);
+}
+
+float cv_dequantize_snorm16(int16_t v)
+{
+	return um_max((float)v * (1.0f / 32767.0f), -1.0f);
+}
+
+void cv_encode_position(int16_t dst[3], um_vec3 position, const cv_bounds *bounds)
+{
+	um_vec3 p = um_divv3(um_sub3(position, bounds->offset), bounds->scale);
+	dst[0] = cv_quantize_snorm16(p.x);
+	dst[1] = cv_quantize_snorm16(p.y);
+	dst[2] = cv_quantize_snorm16(p.z);
+}
+
+um_vec3 cv_decode_position(const int16_t src[3], const cv_bounds *bounds)
+{
+	um_vec3 p = um_v3(cv_dequantize_snorm16(src[0]), cv_dequantize_snorm16(src[1]), cv_dequantize_snorm16(src[2]));
+	return um_add3(bounds->offset, um_mulv3(p, bounds->scale));
+}
+
+void cv_encode_normal(int16_t dst[2], um_vec3 normal)
+{
+	um_vec3 n = um_normalize3(normal);
+	float sum = um_abs(n.x) + um_abs(n.y) + um_abs(n.z);
+	um_vec2 e = um_zero2;
+	if (sum > 0.0f) {
+		e = um_v2(n.x / sum, n.y / sum);
+		if (n.z < 0.0f) {
+			e = um_v2(
+				(1.0f - um_abs(e.y)) * (e.x >= 0.0f ? 1.0f : -1.0f),
+				(1.0f - um_abs(e.x)) * (e.y >= 0.0f ? 1.0f : -1.0f));
+		}
+	}
+	dst[0] = cv_quantize_snorm16(e.x);
+	dst[1] = cv_quantize_snorm16(e.y);
+}
+
+// Must match `octDecode()` in `mesh.glsl`
+um_vec3 cv_decode_normal(const int16_t src[2])
+{
+	float ex = cv_dequantize_snorm16(src[0]), ey = cv_dequantize_snorm16(src[1]);
+	um_vec3 n = um_v3(ex, ey, 1.0f - um_abs(ex) - um_abs(ey));
+	float t = um_max(-n.z, 0.0f);
+	n.x += n.x >= 0.0f ? -t : t;
+	n.y += n.y >= 0.0f ? -t : t;
+	return um_normalize3(n);
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "external/umath.h"
+#include <stdint.h>
+
+// Quantized vertex attributes, decoded on the GPU by `mesh_compact_vertex` in `mesh.glsl`
+
+// Round-trip error bound of a unit normal through `cv_encode_normal()`,
+// measured to be about 6.5e-5 over random and axis-aligned directions.
+#define CV_MAX_NORMAL_ERROR 1e-4f
+
+// Positions are stored as SHORT4N relative to the bounds, `p = offset + q * scale`
+typedef struct cv_bounds {
+	um_vec3 offset;
+	um_vec3 scale;
+} cv_bounds;
+
+cv_bounds cv_make_bounds(um_vec3 min, um_vec3 max);
+
+// Largest per-axis round-trip error of positions within `bounds`: One SHORT4N step
+// of the extent plus float rounding in `offset + q * scale`.
+um_vec3 cv_position_tolerance(const cv_bounds *bounds);
+
+int16_t cv_quantize_snorm16(float v);
+float cv_dequantize_snorm16(int16_t v);
+
+void cv_encode_position(int16_t dst[3], um_vec3 position, const cv_bounds *bounds);
+um_vec3 cv_decode_position(const int16_t src[3], const cv_bounds *bounds);
+
+// Octahedral encoding as SHORT2N, zero normals decode to an arbitrary unit vector
+void cv_encode_normal(int16_t dst[2], um_vec3 normal);
+um_vec3 cv_decode_normal(const int16_t src[2]);
@@ -33,6 +33,11 @@ extern "C" {
 		#include <intrin.h>
 		#define JSI_SSE_CTZ(dst, mask) _BitScanForward((unsigned long*)&(dst), (mask))
 		#define JSI_USE_SSE 1
+	#elif (defined(__GNUC__) || defined(__clang__)) && defined(__SSE2__)
+		// Also covers Emscripten with `-msimd128 -msse2`
+		#include <emmintrin.h>
+		#define JSI_SSE_CTZ(dst, mask) ((dst) = (uint32_t)__builtin_ctz((unsigned)(mask)))
+		#define JSI_USE_SSE 1
 	#endif
 #endif
 
@@ -74,6 +79,9 @@ typedef struct {
 	size_t result_pos, result_size;
 	size_t result_min_alloc_size;
 
+	// `jsi_args.in_situ`: Strings are written here in already parsed input
+	char *in_situ_pos;
+
 	size_t newline_offset;
 	size_t line_index;
 
@@ -204,6 +212,7 @@ jsi_noinline static void
 jsi_refill(jsi_parser *p)
 {
 	p->data_offset += p->end - p->data;
+	p->in_situ_pos = NULL;
 
 	size_t size = 0;
 	if (p->refill_fn) {
@@ -589,16 +598,30 @@ jsi_noinline static const char *
 jsi_copy_string(jsi_parser *p, const char *ptr, const char *end, jsi_value *value)
 {
 	size_t begin_offset = p->data_offset + (ptr - p->data) - 1;
-	char *dst_begin = p->result_page + p->result_pos;
-	char *dst_end = p->result_page + p->result_size;
-	if (dst_end - dst_begin < 8) {
-		jsi_copy_range range = { dst_begin, dst_begin, dst_end };
-		if (!jsi_result_grow_copy(p, &range)) return 0;
-		dst_begin = range.begin; dst_end = range.end;
+	char *dst_begin, *dst_end;
+	int in_situ = 0;
+	if (p->in_situ_pos) {
+		// Unescaping never writes more than it reads, so the string can be written
+		// over the input if its length prefix fits before the first character.
+		size_t fixup = (4 - (size_t)((uintptr_t)p->in_situ_pos & 3u)) & 3u;
+		if (ptr - p->in_situ_pos >= (ptrdiff_t)(fixup + 4)) {
+			in_situ = 1;
+			dst_begin = p->in_situ_pos + fixup + 4;
+			dst_end = (char*)end;
+		}
+	}
+	if (!in_situ) {
+		dst_begin = p->result_page + p->result_pos;
+		dst_end = p->result_page + p->result_size;
+		if (dst_end - dst_begin < 8) {
+			jsi_copy_range range = { dst_begin, dst_begin, dst_end };
+			if (!jsi_result_grow_copy(p, &range)) return 0;
+			dst_begin = range.begin; dst_end = range.end;
+		}
+		size_t misalign = (size_t)((uintptr_t)dst_begin & 3u);
+		size_t fixup = (4 - misalign) & 3u;
+		dst_begin += fixup + 4;
 	}
-	size_t misalign = (size_t)((uintptr_t)dst_begin & 3u);
-	size_t fixup = (4 - misalign) & 3u;
-	dst_begin += fixup + 4;
 	char *dst_ptr = dst_begin;
 
 	#if JSI_USE_SSE
@@ -611,7 +634,6 @@ jsi_copy_string(jsi_parser *p, const char *ptr, const char *end, jsi_value *valu
 		#if JSI_USE_SSE
 		while (end - ptr > 16 && dst_end - dst_ptr > 16) {
 			__m128i chars = _mm_loadu_si128((const __m128i*)ptr);
-			_mm_storeu_si128((__m128i*)dst_ptr, chars);
 			__m128i isquot = _mm_cmpeq_epi8(chars, sse_quot);
 			__m128i islow = _mm_cmpeq_epi8(_mm_max_epu8(chars, sse_low), sse_low);
 			__m128i isslash = _mm_cmpeq_epi8(chars, sse_slash);
@@ -621,43 +643,54 @@ jsi_copy_string(jsi_parser *p, const char *ptr, const char *end, jsi_value *valu
 			// Ignore special characters outside of the string
 			specmask &= quotmask - 1;
 
-			uint32_t index;
-			if (specmask != 0) {
-				JSI_SSE_CTZ(index, specmask);
-				ptr += index;
-				dst_ptr += index;
-				break;
-			} else if (quotmask != 0) {
-				JSI_SSE_CTZ(index, quotmask);
-				ptr += index;
-				dst_ptr += index;
-				p->ptr = ptr + 1;
-				((uint32_t*)dst_begin)[-1] = (uint32_t)(dst_ptr - dst_begin);
-				*dst_ptr++ = '\0';
-				p->result_pos = dst_ptr - p->result_page;
-				return dst_begin;
-			} else {
+			if ((specmask | quotmask) == 0) {
+				_mm_storeu_si128((__m128i*)dst_ptr, chars);
 				ptr += 16;
 				dst_ptr += 16;
+				continue;
 			}
+
+			// Writing in situ must not clobber the input past the end of the string
+			uint32_t index;
+			JSI_SSE_CTZ(index, specmask ? specmask : quotmask);
+			if (in_situ) {
+				memmove(dst_ptr, ptr, index);
+			} else {
+				_mm_storeu_si128((__m128i*)dst_ptr, chars);
+			}
+			ptr += index;
+			dst_ptr += index;
+			if (specmask != 0) break;
+
+			p->ptr = ptr + 1;
+			((uint32_t*)dst_begin)[-1] = (uint32_t)(dst_ptr - dst_begin);
+			*dst_ptr++ = '\0';
+			if (in_situ) {
+				p->in_situ_pos = dst_ptr;
+			} else {
+				p->result_pos = dst_ptr - p->result_page;
+			}
+			return dst_begin;
 		}
 		#else
 		while (end - ptr > 4 && dst_end - dst_ptr > 4) {
+			// Store each character only after checking it so that writing in situ
+			// never clobbers the input past the end of the string
 			char a = ptr[0], b = ptr[1], c = ptr[2], d = ptr[3];
-			dst_ptr[0] = a;
-			dst_ptr[1] = b;
-			dst_ptr[2] = c;
-			dst_ptr[3] = d;
 			if (jsi_stop_char_tab[(unsigned char)a]) { ptr += 0; dst_ptr += 0; break; }
+			dst_ptr[0] = a;
 			if (jsi_stop_char_tab[(unsigned char)b]) { ptr += 1; dst_ptr += 1; break; }
+			dst_ptr[1] = b;
 			if (jsi_stop_char_tab[(unsigned char)c]) { ptr += 2; dst_ptr += 2; break; }
+			dst_ptr[2] = c;
 			if (jsi_stop_char_tab[(unsigned char)d]) { ptr += 3; dst_ptr += 3; break; }
+			dst_ptr[3] = d;
 			ptr += 4;
 			dst_ptr += 4;
 		}
 		#endif
 
-		if (dst_end - dst_ptr < 8) {
+		if (!in_situ && dst_end - dst_ptr < 8) {
 			jsi_copy_range range = { dst_begin, dst_ptr, dst_end };
 			if (!jsi_result_grow_copy(p, &range)) return 0;
 			dst_begin = range.begin; dst_ptr = range.ptr; dst_end = range.end;
@@ -685,7 +718,11 @@ jsi_copy_string(jsi_parser *p, const char *ptr, const char *end, jsi_value *valu
 			((uint32_t*)dst_begin)[-1] = (uint32_t)(dst_ptr - dst_begin);
 			*dst_ptr++ = '\0';
 			p->ptr = ptr;
-			p->result_pos = dst_ptr - p->result_page;
+			if (in_situ) {
+				p->in_situ_pos = dst_ptr;
+			} else {
+				p->result_pos = dst_ptr - p->result_page;
+			}
 			return dst_begin;
 		} else if ((unsigned)c < 32) {
 			if (c == '\0') {
@@ -1297,6 +1334,7 @@ jsi_parse(jsi_parser *p, jsi_args *args)
 	if (p->max_depth < 1) p->max_depth = 1;
 	p->depth_left = p->max_depth;
 	p->store_integers_as_int64 = p->args->store_integers_as_int64;
+	p->in_situ_pos = p->args->in_situ && !p->refill_fn ? (char*)p->data : NULL;
 
 	if (p->ptr == p->end) {
 		jsi_refill(p);
@@ -74,6 +74,12 @@ typedef struct jsi_args {
 	unsigned implicit_root_object : 1;
 	unsigned implicit_root_array : 1;
 	unsigned store_integers_as_int64 : 1;
+
+	// Unescape strings over the input instead of copying them to the result when
+	// there is room, only for `jsi_parse_memory()` and `jsi_parse_string()`.
+	// The input must be writable and outlive the result, it is clobbered by parsing.
+	unsigned in_situ : 1;
+
 	jsi_dialect dialect;
 
 } jsi_args;
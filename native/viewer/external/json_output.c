@@ -4,6 +4,7 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdint.h>
 #include <assert.h>
 
 // Output
@@ -211,54 +212,359 @@ void jso_boolean(jso_stream *s, int value)
 	}
 }
 
-void jso_int(jso_stream *s, int value)
+// Number formatting, all of these write at most 32 characters without a NUL terminator
+
+static const char jso_digit_pairs[] =
+	"00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+	"40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+	"8081828384858687888990919293949596979899";
+
+static size_t jso_format_uint64(char *dst, uint64_t value)
+{
+	char buf[20];
+	char *p = buf + sizeof(buf);
+	while (value >= 100) {
+		uint32_t pair = (uint32_t)(value % 100) * 2;
+		value /= 100;
+		p -= 2;
+		p[0] = jso_digit_pairs[pair];
+		p[1] = jso_digit_pairs[pair + 1];
+	}
+	if (value >= 10) {
+		uint32_t pair = (uint32_t)value * 2;
+		p -= 2;
+		p[0] = jso_digit_pairs[pair];
+		p[1] = jso_digit_pairs[pair + 1];
+	} else {
+		*--p = (char)('0' + value);
+	}
+	size_t length = (size_t)(buf + sizeof(buf) - p);
+	memcpy(dst, p, length);
+	return length;
+}
+
+static size_t jso_format_int64(char *dst, int64_t value)
+{
+	if (value >= 0) return jso_format_uint64(dst, (uint64_t)value);
+	dst[0] = '-';
+	return 1 + jso_format_uint64(dst + 1, 0 - (uint64_t)value);
+}
+
+// Shortest round-trip floating point formatting using Grisu2 from "Printing
+// Floating-Point Numbers Quickly and Accurately with Integers" by Florian Loitsch.
+// The output always parses back to the same value, but for a small fraction of
+// inputs it may be a digit longer than the shortest possible representation.
+
+typedef struct {
+	uint64_t f;
+	int e;
+} jso_diy_fp;
+
+// Normalized 64-bit approximations of 10^k for k = -348, -340, ..., 340
+static const uint64_t jso_cached_pow10_f[] = {
+	UINT64_C(0xfa8fd5a0081c0288), UINT64_C(0xbaaee17fa23ebf76), UINT64_C(0x8b16fb203055ac76),
+	UINT64_C(0xcf42894a5dce35ea), UINT64_C(0x9a6bb0aa55653b2d), UINT64_C(0xe61acf033d1a45df),
+	UINT64_C(0xab70fe17c79ac6ca), UINT64_C(0xff77b1fcbebcdc4f), UINT64_C(0xbe5691ef416bd60c),
+	UINT64_C(0x8dd01fad907ffc3c), UINT64_C(0xd3515c2831559a83), UINT64_C(0x9d71ac8fada6c9b5),
+	UINT64_C(0xea9c227723ee8bcb), UINT64_C(0xaecc49914078536d), UINT64_C(0x823c12795db6ce57),
+	UINT64_C(0xc21094364dfb5637), UINT64_C(0x9096ea6f3848984f), UINT64_C(0xd77485cb25823ac7),
+	UINT64_C(0xa086cfcd97bf97f4), UINT64_C(0xef340a98172aace5), UINT64_C(0xb23867fb2a35b28e),
+	UINT64_C(0x84c8d4dfd2c63f3b), UINT64_C(0xc5dd44271ad3cdba), UINT64_C(0x936b9fcebb25c996),
+	UINT64_C(0xdbac6c247d62a584), UINT64_C(0xa3ab66580d5fdaf6), UINT64_C(0xf3e2f893dec3f126),
+	UINT64_C(0xb5b5ada8aaff80b8), UINT64_C(0x87625f056c7c4a8b), UINT64_C(0xc9bcff6034c13053),
+	UINT64_C(0x964e858c91ba2655), UINT64_C(0xdff9772470297ebd), UINT64_C(0xa6dfbd9fb8e5b88f),
+	UINT64_C(0xf8a95fcf88747d94), UINT64_C(0xb94470938fa89bcf), UINT64_C(0x8a08f0f8bf0f156b),
+	UINT64_C(0xcdb02555653131b6), UINT64_C(0x993fe2c6d07b7fac), UINT64_C(0xe45c10c42a2b3b06),
+	UINT64_C(0xaa242499697392d3), UINT64_C(0xfd87b5f28300ca0e), UINT64_C(0xbce5086492111aeb),
+	UINT64_C(0x8cbccc096f5088cc), UINT64_C(0xd1b71758e219652c), UINT64_C(0x9c40000000000000),
+	UINT64_C(0xe8d4a51000000000), UINT64_C(0xad78ebc5ac620000), UINT64_C(0x813f3978f8940984),
+	UINT64_C(0xc097ce7bc90715b3), UINT64_C(0x8f7e32ce7bea5c70), UINT64_C(0xd5d238a4abe98068),
+	UINT64_C(0x9f4f2726179a2245), UINT64_C(0xed63a231d4c4fb27), UINT64_C(0xb0de65388cc8ada8),
+	UINT64_C(0x83c7088e1aab65db), UINT64_C(0xc45d1df942711d9a), UINT64_C(0x924d692ca61be758),
+	UINT64_C(0xda01ee641a708dea), UINT64_C(0xa26da3999aef774a), UINT64_C(0xf209787bb47d6b85),
+	UINT64_C(0xb454e4a179dd1877), UINT64_C(0x865b86925b9bc5c2), UINT64_C(0xc83553c5c8965d3d),
+	UINT64_C(0x952ab45cfa97a0b3), UINT64_C(0xde469fbd99a05fe3), UINT64_C(0xa59bc234db398c25),
+	UINT64_C(0xf6c69a72a3989f5c), UINT64_C(0xb7dcbf5354e9bece), UINT64_C(0x88fcf317f22241e2),
+	UINT64_C(0xcc20ce9bd35c78a5), UINT64_C(0x98165af37b2153df), UINT64_C(0xe2a0b5dc971f303a),
+	UINT64_C(0xa8d9d1535ce3b396), UINT64_C(0xfb9b7cd9a4a7443c), UINT64_C(0xbb764c4ca7a44410),
+	UINT64_C(0x8bab8eefb6409c1a), UINT64_C(0xd01fef10a657842c), UINT64_C(0x9b10a4e5e9913129),
+	UINT64_C(0xe7109bfba19c0c9d), UINT64_C(0xac2820d9623bf429), UINT64_C(0x80444b5e7aa7cf85),
+	UINT64_C(0xbf21e44003acdd2d), UINT64_C(0x8e679c2f5e44ff8f), UINT64_C(0xd433179d9c8cb841),
+	UINT64_C(0x9e19db92b4e31ba9), UINT64_C(0xeb96bf6ebadf77d9), UINT64_C(0xaf87023b9bf0ee6b),
+};
+
+static const int16_t jso_cached_pow10_e[] = {
+	-1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980,
+	-954, -927, -901, -874, -847, -821, -794, -768, -741, -715,
+	-688, -661, -635, -608, -582, -555, -529, -502, -475, -449,
+	-422, -396, -369, -343, -316, -289, -263, -236, -210, -183,
+	-157, -130, -103, -77, -50, -24, 3, 30, 56, 83,
+	109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+	375, 402, 428, 455, 481, 508, 534, 561, 588, 614,
+	641, 667, 694, 720, 747, 774, 800, 827, 853, 880,
+	907, 933, 960, 986, 1013, 1039, 1066,
+};
+
+static const uint64_t jso_pow10_u64[] = {
+	UINT64_C(1), UINT64_C(10), UINT64_C(100), UINT64_C(1000), UINT64_C(10000),
+	UINT64_C(100000), UINT64_C(1000000), UINT64_C(10000000), UINT64_C(100000000),
+	UINT64_C(1000000000), UINT64_C(10000000000), UINT64_C(100000000000),
+	UINT64_C(1000000000000), UINT64_C(10000000000000), UINT64_C(100000000000000),
+	UINT64_C(1000000000000000), UINT64_C(10000000000000000), UINT64_C(100000000000000000),
+	UINT64_C(1000000000000000000), UINT64_C(10000000000000000000),
+};
+
+static jso_diy_fp jso_fp_mul(jso_diy_fp a, jso_diy_fp b)
+{
+	const uint64_t mask = 0xffffffffu;
+	uint64_t ah = a.f >> 32, al = a.f & mask;
+	uint64_t bh = b.f >> 32, bl = b.f & mask;
+	uint64_t hh = ah * bh, lh = al * bh, hl = ah * bl, ll = al * bl;
+	uint64_t mid = (ll >> 32) + (lh & mask) + (hl & mask) + (UINT64_C(1) << 31);
+	jso_diy_fp r = { hh + (lh >> 32) + (hl >> 32) + (mid >> 32), a.e + b.e + 64 };
+	return r;
+}
+
+static jso_diy_fp jso_fp_normalize(jso_diy_fp x)
+{
+	while (!(x.f >> 63)) {
+		x.f <<= 1;
+		x.e--;
+	}
+	return x;
+}
+
+static void jso_grisu_round(char *digits, int length, uint64_t delta, uint64_t rest, uint64_t ten_kappa, uint64_t wp_w)
+{
+	while (rest < wp_w && delta - rest >= ten_kappa
+		&& (rest + ten_kappa < wp_w || wp_w - rest > rest + ten_kappa - wp_w)) {
+		digits[length - 1]--;
+		rest += ten_kappa;
+	}
+}
+
+// Writes the decimal digits of `f * 2^e` to `digits` so that `value = digits * 10^k`,
+// `significand_bits` is the number of explicitly stored mantissa bits of the source type.
+// Returns the number of digits (at most 17 for doubles).
+static int jso_grisu2(char *digits, uint64_t f, int e, int significand_bits, bool lower_closer, int *p_k)
+{
+	// Boundaries halfway to the neighboring representable values
+	jso_diy_fp w_plus = { (f << 1) + 1, e - 1 };
+	while (!(w_plus.f >> (significand_bits + 1))) {
+		w_plus.f <<= 1;
+		w_plus.e--;
+	}
+	w_plus.f <<= 62 - significand_bits;
+	w_plus.e -= 62 - significand_bits;
+
+	jso_diy_fp w_minus;
+	if (lower_closer) {
+		w_minus.f = (f << 2) - 1;
+		w_minus.e = e - 2;
+	} else {
+		w_minus.f = (f << 1) - 1;
+		w_minus.e = e - 1;
+	}
+	w_minus.f <<= w_minus.e - w_plus.e;
+	w_minus.e = w_plus.e;
+
+	// Scale by a cached power of ten so that the exponent lands in [-60, -32]
+	double dk = (-61 - w_plus.e) * 0.30102999566398114 + 347.0;
+	int ik = (int)dk;
+	if (dk - ik > 0.0) ik++;
+	int index = (ik >> 3) + 1;
+	*p_k = -(-348 + index * 8);
+	jso_diy_fp c_mk = { jso_cached_pow10_f[index], jso_cached_pow10_e[index] };
+
+	jso_diy_fp v = { f, e };
+	jso_diy_fp w = jso_fp_mul(jso_fp_normalize(v), c_mk);
+	jso_diy_fp wp = jso_fp_mul(w_plus, c_mk);
+	jso_diy_fp wm = jso_fp_mul(w_minus, c_mk);
+	wm.f++;
+	wp.f--;
+
+	// Generate digits of `wp` until we are within `delta` of it
+	uint64_t delta = wp.f - wm.f;
+	uint64_t wp_w = wp.f - w.f;
+	int shift = -wp.e;
+	uint64_t one = UINT64_C(1) << shift;
+	uint32_t p1 = (uint32_t)(wp.f >> shift);
+	uint64_t p2 = wp.f & (one - 1);
+
+	int kappa = 1;
+	while (kappa < 10 && p1 >= jso_pow10_u64[kappa]) kappa++;
+
+	int length = 0;
+	while (kappa > 0) {
+		uint32_t div = (uint32_t)jso_pow10_u64[kappa - 1];
+		uint32_t d = p1 / div;
+		p1 %= div;
+		if (d || length) digits[length++] = (char)('0' + d);
+		kappa--;
+		uint64_t rest = ((uint64_t)p1 << shift) + p2;
+		if (rest <= delta) {
+			*p_k += kappa;
+			jso_grisu_round(digits, length, delta, rest, jso_pow10_u64[kappa] << shift, wp_w);
+			return length;
+		}
+	}
+
+	for (;;) {
+		p2 *= 10;
+		delta *= 10;
+		char d = (char)(p2 >> shift);
+		if (d || length) digits[length++] = (char)('0' + d);
+		p2 &= one - 1;
+		kappa--;
+		if (p2 < delta) {
+			*p_k += kappa;
+			uint64_t scale = -kappa < 20 ? jso_pow10_u64[-kappa] : 0;
+			jso_grisu_round(digits, length, delta, p2, one, wp_w * scale);
+			return length;
+		}
+	}
+}
+
+// Lays out `digits * 10^k` the same way as JavaScript `Number.prototype.toString()`
+static size_t jso_format_digits(char *dst, const char *digits, int length, int k)
+{
+	char *p = dst;
+	int point = length + k;
+	if (length <= point && point <= 21) {
+		memcpy(p, digits, (size_t)length);
+		p += length;
+		for (int i = length; i < point; i++) *p++ = '0';
+	} else if (0 < point && point <= 21) {
+		memcpy(p, digits, (size_t)point);
+		p += point;
+		*p++ = '.';
+		memcpy(p, digits + point, (size_t)(length - point));
+		p += length - point;
+	} else if (-6 < point && point <= 0) {
+		*p++ = '0';
+		*p++ = '.';
+		for (int i = point; i < 0; i++) *p++ = '0';
+		memcpy(p, digits, (size_t)length);
+		p += length;
+	} else {
+		*p++ = digits[0];
+		if (length > 1) {
+			*p++ = '.';
+			memcpy(p, digits + 1, (size_t)(length - 1));
+			p += length - 1;
+		}
+		int exp = point - 1;
+		*p++ = 'e';
+		*p++ = exp < 0 ? '-' : '+';
+		p += jso_format_uint64(p, (uint64_t)(exp < 0 ? -exp : exp));
+	}
+	return (size_t)(p - dst);
+}
+
+// JSON has no representation for NaN or infinities, they are written as `null`
+// like `JSON.stringify()` does.
+static size_t jso_format_double(char *dst, double value)
+{
+	if (value > -9007199254740992.0 && value < 9007199254740992.0) {
+		int64_t int_value = (int64_t)value;
+		if ((double)int_value == value) return jso_format_int64(dst, int_value);
+	}
+
+	uint64_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	uint64_t mantissa = bits & ((UINT64_C(1) << 52) - 1);
+	int biased_exp = (int)(bits >> 52) & 0x7ff;
+	if (biased_exp == 0x7ff) {
+		memcpy(dst, "null", 4);
+		return 4;
+	}
+
+	char *p = dst;
+	if (bits >> 63) *p++ = '-';
+
+	uint64_t f = biased_exp ? mantissa | (UINT64_C(1) << 52) : mantissa;
+	int e = biased_exp ? biased_exp - 1075 : -1074;
+	char digits[20];
+	int k = 0;
+	int length = jso_grisu2(digits, f, e, 52, mantissa == 0 && biased_exp > 1, &k);
+	p += jso_format_digits(p, digits, length, k);
+	return (size_t)(p - dst);
+}
+
+// Like `jso_format_double()` but only as many digits as needed to round-trip a float
+static size_t jso_format_float(char *dst, float value)
+{
+	if (value > -16777216.0f && value < 16777216.0f) {
+		int32_t int_value = (int32_t)value;
+		if ((float)int_value == value) return jso_format_int64(dst, int_value);
+	}
+
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	uint32_t mantissa = bits & ((UINT32_C(1) << 23) - 1);
+	int biased_exp = (int)(bits >> 23) & 0xff;
+	if (biased_exp == 0xff) {
+		memcpy(dst, "null", 4);
+		return 4;
+	}
+
+	char *p = dst;
+	if (bits >> 31) *p++ = '-';
+
+	uint64_t f = biased_exp ? mantissa | (UINT32_C(1) << 23) : mantissa;
+	int e = biased_exp ? biased_exp - 150 : -149;
+	char digits[20];
+	int k = 0;
+	int length = jso_grisu2(digits, f, e, 23, mantissa == 0 && biased_exp > 1, &k);
+	p += jso_format_digits(p, digits, length, k);
+	return (size_t)(p - dst);
+}
+
+static void jso_number(jso_stream *s, const char *str, size_t length)
 {
 	if (s->capacity - s->pos < JSO_BUFFER_MIN_SIZE) s->flush_fn(s);
 	if (s->add_comma) s->data[s->pos++] = ',';
 	if (s->pretty) jso_prettify(s);
 	s->add_comma = 1;
-	s->pos += snprintf(s->data + s->pos, s->capacity - s->pos, "%d", value);
+	memcpy(s->data + s->pos, str, length);
+	s->pos += length;
 	assert(s->pos <= s->capacity);
 }
 
+void jso_int(jso_stream *s, int value)
+{
+	char buf[32];
+	jso_number(s, buf, jso_format_int64(buf, value));
+}
+
 void jso_uint(jso_stream *s, unsigned value)
 {
-	if (s->capacity - s->pos < JSO_BUFFER_MIN_SIZE) s->flush_fn(s);
-	if (s->add_comma) s->data[s->pos++] = ',';
-	if (s->pretty) jso_prettify(s);
-	s->add_comma = 1;
-	s->pos += snprintf(s->data + s->pos, s->capacity - s->pos, "%u", value);
-	assert(s->pos <= s->capacity);
+	char buf[32];
+	jso_number(s, buf, jso_format_uint64(buf, value));
 }
 
 void jso_int64(jso_stream *s, long long value)
 {
-	if (s->capacity - s->pos < JSO_BUFFER_MIN_SIZE) s->flush_fn(s);
-	if (s->add_comma) s->data[s->pos++] = ',';
-	if (s->pretty) jso_prettify(s);
-	s->add_comma = 1;
-	s->pos += snprintf(s->data + s->pos, s->capacity - s->pos, "%lld", value);
-	assert(s->pos <= s->capacity);
+	char buf[32];
+	jso_number(s, buf, jso_format_int64(buf, value));
 }
 
 void jso_uint64(jso_stream *s, unsigned long long value)
 {
-	if (s->capacity - s->pos < JSO_BUFFER_MIN_SIZE) s->flush_fn(s);
-	if (s->add_comma) s->data[s->pos++] = ',';
-	if (s->pretty) jso_prettify(s);
-	s->add_comma = 1;
-	s->pos += snprintf(s->data + s->pos, s->capacity - s->pos, "%llud", value);
-	assert(s->pos <= s->capacity);
+	char buf[32];
+	jso_number(s, buf, jso_format_uint64(buf, value));
+}
+
+void jso_float(jso_stream *s, float value)
+{
+	char buf[32];
+	jso_number(s, buf, jso_format_float(buf, value));
 }
 
 void jso_double(jso_stream *s, double value)
 {
-	if (s->capacity - s->pos < JSO_BUFFER_MIN_SIZE) s->flush_fn(s);
-	if (s->add_comma) s->data[s->pos++] = ',';
-	if (s->pretty) jso_prettify(s);
-	s->add_comma = 1;
-	s->pos += snprintf(s->data + s->pos, s->capacity - s->pos, "%f", value);
-	assert(s->pos <= s->capacity);
+	char buf[32];
+	jso_number(s, buf, jso_format_double(buf, value));
 }
 
 static void jso_raw_string(jso_stream *s, const char *value)
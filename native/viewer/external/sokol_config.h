@@ -1,6 +1,8 @@
 #pragma once
 
-#if defined(_WIN32)
+#if defined(VIEWER_HEADLESS)
+	#define SOKOL_DUMMY_BACKEND
+#elif defined(_WIN32)
 	// #define SOKOL_D3D11
 	#define SOKOL_GLCORE33
 #elif defined(__EMSCRIPTEN__)
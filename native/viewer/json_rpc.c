@@ -5,10 +5,12 @@
 #include "arena.h"
 #include "viewer.h"
 #include "serialization.h"
+#include "thread_pool.h"
 #include "ufbx.h"
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #if defined(_WIN32)
 	#define NOMINMAX
@@ -19,6 +21,22 @@ static bool g_pretty = false;
 static bool g_verbose = false;
 static uint64_t g_start_cpu_tick = 0;
 
+// Responses are written into a buffer that is reused between calls and grown
+// geometrically, a call returns a pointer into it. The responses of a batch are
+// written back to back starting from `g_response_end`.
+#define RPC_INITIAL_RESPONSE_SIZE (64 * 1024)
+static char *g_response = NULL;
+static size_t g_response_capacity = 0;
+static size_t g_response_end = 0;
+static char g_response_fail_memory[JSO_BUFFER_MIN_SIZE * 2];
+static char g_out_of_memory_response[] = "{\"error\":\"Out of memory\"}";
+
+// Heap allocations for parsing requests and writing responses, reported as
+// `rpc.allocations` for the current call and in `getMemoryStats` in total
+static size_t g_call_allocations = 0;
+static size_t g_total_allocations = 0;
+static size_t g_total_calls = 0;
+
 void log_printf(const char *fmt, ...)
 {
 	va_list args;
@@ -38,26 +56,90 @@ void log_printf(const char *fmt, ...)
 	va_end(args);
 }
 
+static bool rpc_reserve_response(size_t size)
+{
+	if (size <= g_response_capacity) return true;
+	size_t capacity = g_response_capacity ? g_response_capacity : RPC_INITIAL_RESPONSE_SIZE;
+	while (capacity < size) capacity *= 2;
+	char *data = (char*)realloc(g_response, capacity);
+	if (!data) return false;
+	g_call_allocations++;
+	g_response = data;
+	g_response_capacity = capacity;
+	return true;
+}
+
+static void rpc_response_flush(jso_stream *s)
+{
+	if (!s->failed && rpc_reserve_response(s->capacity * 2)) {
+		s->data = g_response;
+		s->capacity = g_response_capacity;
+	} else {
+		// Discard the rest of the response, `end_response()` returns NULL
+		s->data = g_response_fail_memory;
+		s->capacity = sizeof(g_response_fail_memory);
+		s->pos = 0;
+		s->failed = true;
+	}
+}
+
+// Appends to the response buffer and keeps it NUL-terminated
+static bool rpc_append_response(const char *str, size_t length)
+{
+	if (!rpc_reserve_response(g_response_end + length + 1)) return false;
+	memcpy(g_response + g_response_end, str, length);
+	g_response_end += length;
+	g_response[g_response_end] = '\0';
+	return true;
+}
+
 jso_stream begin_response()
 {
-	uint64_t cpu_tick = cputime_cpu_tick();
-	cputime_end_init();
 	jso_stream s;
-	jso_init_growable(&s);
+	jso_init_custom(&s);
+	s.flush_fn = &rpc_response_flush;
+	if (rpc_reserve_response(RPC_INITIAL_RESPONSE_SIZE)) {
+		s.data = g_response;
+		s.capacity = g_response_capacity;
+		s.pos = g_response_end;
+	} else {
+		rpc_response_flush(&s);
+	}
 	s.pretty = g_pretty;
 	jso_object(&s);
 	jso_single_line(&s);
-	jso_prop_object(&s, "rpc");
-	double sec = cputime_cpu_delta_to_sec(NULL, cpu_tick - g_start_cpu_tick);
-	jso_prop_double(&s, "duration", sec);
-	jso_end_object(&s);
 	return s;
 }
 
 char *end_response(jso_stream *s)
 {
+	// Written last so that the duration includes serializing the response
+	uint64_t cpu_tick = cputime_cpu_tick();
+	cputime_end_init();
+	jso_prop_object(s, "rpc");
+	double sec = cputime_cpu_delta_to_sec(NULL, cpu_tick - g_start_cpu_tick);
+	jso_prop_double(s, "duration", sec);
+	jso_prop_uint64(s, "allocations", g_call_allocations);
+	jso_end_object(s);
+	jso_end_object(s);
+
+	if (s->capacity - s->pos < 1) s->flush_fn(s);
+	s->data[s->pos] = '\0';
+	if (s->failed) return NULL;
+
+	char *response = s->data + g_response_end;
+	g_response_end = s->pos;
+	return response;
+}
+
+// Viewer vectors are single precision, so only write the digits a float needs
+static void jso_prop_um_vec3(jso_stream *s, const char *name, um_vec3 value)
+{
+	jso_prop_object(s, name);
+	jso_prop_float(s, "x", value.x);
+	jso_prop_float(s, "y", value.y);
+	jso_prop_float(s, "z", value.z);
 	jso_end_object(s);
-	return jso_close_growable(s);
 }
 
 char *fmt_error(const char *fmt, ...)
@@ -76,24 +158,231 @@ char *fmt_error(const char *fmt, ...)
 
 enum {
 	MAX_NAME_LEN = 64,
-	MAX_LODAED_SCENES = 16,
+	MAX_LOADED_SCENES = 16, // Scenes with a `vi_scene` at once
+	RPC_PARSE_BUFFER_SIZE = 16 * 1024,
 };
 
+#define RPC_DEFAULT_SCENE_MEMORY_BUDGET ((size_t)512 * 1024 * 1024)
+
+// Scene being parsed on a background job by `loadSceneAsync`
 typedef struct {
+	tp_job *job;
+	void *data; // Owned, freed with `free()`
+	size_t size;
+	vi_scene_opts vi_opts;
+
+	// Written by the job
+	ufbx_scene *fbx_scene;
+	ufbx_error error;
+} rpc_scene_load;
+
+typedef struct rpc_scene rpc_scene;
+struct rpc_scene {
 	arena_t *arena;
 	const char *name;
+	uint32_t hash;
 	ufbx_scene *fbx_scene;
 	vi_scene *vi_scene;
-} rpc_scene;
+	vi_scene_opts vi_opts;
+	void *table; // `serialize_scene_table()`, built on demand
+	size_t table_size;
+
+	// Unloaded to stay within the memory budget, needs to be loaded again
+	bool evicted;
+
+	// Pending `loadSceneAsync`, replaces `fbx_scene` once polled after finishing
+	rpc_scene_load *load;
 
-typedef alist_t(rpc_scene) rpc_scene_list;
+	// Counted in `rpcg.stats.memory_used`, see `rpc_update_scene_memory()`
+	size_t fbx_memory;
+	vi_scene_memory vi_memory;
+
+	rpc_scene *hash_next;
+	rpc_scene *prev, *next;
+};
 
 typedef struct {
-	rpc_scene_list scenes;
+	size_t num_scenes;
+	size_t num_resident;    // Scenes with a `vi_scene`
+	size_t evictions;       // `vi_scene` freed to stay within the limits
+	size_t unloads;         // Whole scenes unloaded to stay within the budget
+	size_t memory_used;
+	size_t memory_budget;
+} rpc_scene_stats;
+
+// Scenes are never removed from the registry so `rpc_scene` pointers stay valid,
+// evicted scenes only keep their name.
+typedef struct {
+	rpc_scene **buckets;
+	size_t num_buckets;
+
+	// Most recently rendered or loaded first
+	rpc_scene *lru_head, *lru_tail;
+
+	rpc_scene_stats stats;
 	void *pixel_buffer;
+	void *vertex_buffer;
+
+	// Value tree of the request being handled, larger requests spill to the heap
+	uint64_t parse_buffer[RPC_PARSE_BUFFER_SIZE / sizeof(uint64_t)];
 } rpc_globals;
 
-static rpc_globals rpcg;
+static rpc_globals rpcg = {
+	.stats.memory_budget = RPC_DEFAULT_SCENE_MEMORY_BUDGET,
+};
+
+static uint32_t rpc_hash_name(const char *name)
+{
+	uint32_t hash = 0x811c9dc5u;
+	for (const char *c = name; *c; c++) {
+		hash = (hash ^ (uint8_t)*c) * 0x01000193u;
+	}
+	return hash;
+}
+
+static rpc_scene **rpc_scene_bucket(uint32_t hash)
+{
+	return &rpcg.buckets[hash & (rpcg.num_buckets - 1)];
+}
+
+static void rpc_scene_unlink(rpc_scene *scene)
+{
+	if (scene->prev) scene->prev->next = scene->next;
+	else rpcg.lru_head = scene->next;
+	if (scene->next) scene->next->prev = scene->prev;
+	else rpcg.lru_tail = scene->prev;
+	scene->prev = scene->next = NULL;
+}
+
+static void rpc_scene_push_front(rpc_scene *scene)
+{
+	scene->prev = NULL;
+	scene->next = rpcg.lru_head;
+	if (rpcg.lru_head) rpcg.lru_head->prev = scene;
+	else rpcg.lru_tail = scene;
+	rpcg.lru_head = scene;
+}
+
+static void rpc_touch_scene(rpc_scene *scene)
+{
+	if (rpcg.lru_head == scene) return;
+	rpc_scene_unlink(scene);
+	rpc_scene_push_front(scene);
+}
+
+static rpc_scene *find_scene(const char *name)
+{
+	if (rpcg.num_buckets == 0) return NULL;
+	uint32_t hash = rpc_hash_name(name);
+	for (rpc_scene *scene = *rpc_scene_bucket(hash); scene; scene = scene->hash_next) {
+		if (scene->hash == hash && !strcmp(scene->name, name)) {
+			return scene;
+		}
+	}
+	return NULL;
+}
+
+static bool rpc_grow_scene_buckets()
+{
+	if (rpcg.stats.num_scenes < rpcg.num_buckets) return true;
+
+	size_t old_num_buckets = rpcg.num_buckets;
+	rpc_scene **old_buckets = rpcg.buckets;
+	size_t num_buckets = old_num_buckets ? old_num_buckets * 2 : 16;
+	rpc_scene **buckets = aalloc(NULL, rpc_scene*, num_buckets);
+	if (!buckets) return false;
+
+	rpcg.buckets = buckets;
+	rpcg.num_buckets = num_buckets;
+	for (size_t i = 0; i < old_num_buckets; i++) {
+		rpc_scene *scene = old_buckets[i];
+		while (scene) {
+			rpc_scene *next = scene->hash_next;
+			rpc_scene **bucket = rpc_scene_bucket(scene->hash);
+			scene->hash_next = *bucket;
+			*bucket = scene;
+			scene = next;
+		}
+	}
+	afree(NULL, old_buckets);
+	return true;
+}
+
+static rpc_scene *rpc_add_scene(const char *name)
+{
+	if (!rpc_grow_scene_buckets()) return NULL;
+
+	arena_t *arena = arena_create(NULL);
+	rpc_scene *scene = aalloc(arena, rpc_scene, 1);
+	if (!scene) {
+		arena_free(arena);
+		return NULL;
+	}
+	scene->arena = arena;
+	scene->name = aalloc_copy_str(arena, name);
+	scene->hash = rpc_hash_name(name);
+
+	rpc_scene **bucket = rpc_scene_bucket(scene->hash);
+	scene->hash_next = *bucket;
+	*bucket = scene;
+	rpc_scene_push_front(scene);
+	rpcg.stats.num_scenes++;
+	return scene;
+}
+
+// Re-measure the memory used by `scene`, call after anything in it is created or freed
+static void rpc_update_scene_memory(rpc_scene *scene)
+{
+	rpcg.stats.memory_used -= scene->fbx_memory + scene->vi_memory.cpu + scene->vi_memory.gpu;
+
+	scene->fbx_memory = scene->table_size;
+	if (scene->fbx_scene) {
+		scene->fbx_memory += scene->fbx_scene->metadata.result_memory_used;
+	}
+	scene->vi_memory = scene->vi_scene ? vi_get_scene_memory(scene->vi_scene) : (vi_scene_memory){ 0 };
+
+	rpcg.stats.memory_used += scene->fbx_memory + scene->vi_memory.cpu + scene->vi_memory.gpu;
+}
+
+static void rpc_free_vi_scene(rpc_scene *scene)
+{
+	if (!scene->vi_scene) return;
+	vi_free_scene(scene->vi_scene);
+	scene->vi_scene = NULL;
+	rpcg.stats.num_resident--;
+	rpc_update_scene_memory(scene);
+}
+
+static void rpc_unload_scene(rpc_scene *scene)
+{
+	rpc_free_vi_scene(scene);
+	ufbx_free_scene(scene->fbx_scene);
+	scene->fbx_scene = NULL;
+	afree(scene->arena, scene->table);
+	scene->table = NULL;
+	scene->table_size = 0;
+	rpc_update_scene_memory(scene);
+}
+
+// Free least recently rendered scenes other than `keep` until within the limits.
+// Viewer scenes are cheap to re-create from the FBX scene so they are freed first.
+static void rpc_enforce_scene_budget(rpc_scene *keep)
+{
+	for (rpc_scene *scene = rpcg.lru_tail; scene; scene = scene->prev) {
+		if (rpcg.stats.num_resident <= MAX_LOADED_SCENES && rpcg.stats.memory_used <= rpcg.stats.memory_budget) return;
+		if (scene == keep || !scene->vi_scene) continue;
+		rpc_free_vi_scene(scene);
+		rpcg.stats.evictions++;
+	}
+
+	for (rpc_scene *scene = rpcg.lru_tail; scene; scene = scene->prev) {
+		if (rpcg.stats.memory_used <= rpcg.stats.memory_budget) return;
+		if (scene == keep || !scene->fbx_scene) continue;
+		rpc_unload_scene(scene);
+		scene->evicted = true;
+		rpcg.stats.unloads++;
+	}
+}
 
 char *rpc_cmd_init(arena_t *tmp, jsi_obj *args)
 {
@@ -102,9 +391,126 @@ char *rpc_cmd_init(arena_t *tmp, jsi_obj *args)
 
 	vi_setup();
 
+	jsi_value *scene_memory_budget = jsi_get(args, "sceneMemoryBudget");
+	if (scene_memory_budget) {
+		rpcg.stats.memory_budget = (size_t)jsi_as_int64(scene_memory_budget, 0);
+		rpc_enforce_scene_budget(NULL);
+	}
+
+	jsi_value *mesh_cache_budget = jsi_get(args, "meshCacheBudget");
+	if (mesh_cache_budget) {
+		vi_set_mesh_cache_budget((size_t)jsi_as_int64(mesh_cache_budget, 0));
+	}
+
+	// Restart the pool started by `vi_setup()` with an explicit worker count, 0 for one per core
+	jsi_value *num_threads = jsi_get(args, "numThreads");
+	if (num_threads) {
+		tp_shutdown();
+		tp_setup((size_t)jsi_as_int64(num_threads, 0));
+	}
+
 	jso_stream s = begin_response();
 	jso_prop_boolean(&s, "pretty", g_pretty);
 	jso_prop_boolean(&s, "verbose", g_verbose);
+	jso_prop_int(&s, "numThreads", (int)tp_num_threads());
+	return end_response(&s);
+}
+
+// Scene options shared by `loadScene` and `loadSceneAsync`
+static vi_scene_opts rpc_get_scene_opts(jsi_obj *args)
+{
+	vi_scene_opts opts = { 0 };
+	opts.compact_vertices = jsi_get_bool(args, "compactVertices", false);
+	opts.optimize_vertex_cache = jsi_get_bool(args, "optimizeVertexCache", true);
+	return opts;
+}
+
+// Replace the FBX scene of `scene`, takes ownership of `fbx_scene`
+static void rpc_set_fbx_scene(rpc_scene *scene, ufbx_scene *fbx_scene, const vi_scene_opts *vi_opts)
+{
+	rpc_unload_scene(scene);
+	rpc_touch_scene(scene);
+
+	scene->fbx_scene = fbx_scene;
+	scene->evicted = false;
+	scene->vi_opts = *vi_opts;
+	rpc_update_scene_memory(scene);
+	rpc_enforce_scene_budget(scene);
+}
+
+static void rpc_free_load(rpc_scene *scene)
+{
+	rpc_scene_load *load = scene->load;
+	if (!load) return;
+	tp_job_join(load->job);
+	ufbx_free_scene(load->fbx_scene);
+	free(load->data);
+	afree(scene->arena, load);
+	scene->load = NULL;
+}
+
+static void rpc_cancel_load(rpc_scene *scene)
+{
+	if (!scene->load) return;
+	tp_job_cancel(scene->load->job);
+	rpc_free_load(scene);
+}
+
+static ufbx_progress_result rpc_load_progress(void *user, const ufbx_progress *progress)
+{
+	tp_job *job = (tp_job*)user;
+	tp_job_set_progress(job, progress->bytes_read, progress->bytes_total);
+	return tp_job_cancelled(job) ? UFBX_PROGRESS_CANCEL : UFBX_PROGRESS_CONTINUE;
+}
+
+static void rpc_load_task(tp_job *job, void *user)
+{
+	rpc_scene_load *load = (rpc_scene_load*)user;
+	ufbx_load_opts opts = {
+		.allow_null_material = true,
+		.progress_cb = { &rpc_load_progress, job },
+	};
+	load->fbx_scene = ufbx_load_memory(load->data, load->size, &opts, &load->error);
+}
+
+// Finish a completed `loadSceneAsync` and report the state of the scene
+static char *rpc_poll_scene(arena_t *tmp, rpc_scene *scene)
+{
+	rpc_scene_load *load = scene->load;
+	if (load && !tp_job_done(load->job)) {
+		uint64_t bytes_read = 0, bytes_total = 0;
+		tp_job_get_progress(load->job, &bytes_read, &bytes_total);
+
+		jso_stream s = begin_response();
+		jso_prop_string(&s, "state", "loading");
+		jso_prop_int64(&s, "bytesRead", (int64_t)bytes_read);
+		jso_prop_int64(&s, "bytesTotal", (int64_t)(bytes_total ? bytes_total : load->size));
+		return end_response(&s);
+	}
+
+	if (load) {
+		ufbx_scene *fbx_scene = load->fbx_scene;
+		load->fbx_scene = NULL;
+		if (!fbx_scene) {
+			char *buf = aalloc(tmp, char, 4096);
+			ufbx_format_error(buf, 4096, &load->error);
+			rpc_free_load(scene);
+			return fmt_error("Failed to load scene:\n%s", buf);
+		}
+
+		vi_scene_opts vi_opts = load->vi_opts;
+		rpc_free_load(scene);
+		rpc_set_fbx_scene(scene, fbx_scene, &vi_opts);
+	}
+
+	jso_stream s = begin_response();
+	if (scene->fbx_scene) {
+		jso_prop_string(&s, "state", "loaded");
+		jso_prop(&s, "scene");
+		serialize_scene_summary(&s, scene->fbx_scene);
+	} else {
+		jso_prop_string(&s, "state", scene->evicted ? "evicted" : "unloaded");
+	}
 	return end_response(&s);
 }
 
@@ -116,19 +522,6 @@ char *rpc_cmd_load_scene(arena_t *tmp, jsi_obj *args)
 	size_t size = (size_t)jsi_get_int64(args, "size", 0);
 	if (!data || !size) return fmt_error("Bad data range: { %p, %zu }", data, size);
 
-	rpc_scene *scene = NULL;
-	for (size_t i = 0; i < rpcg.scenes.count; i++) {
-		if (!strcmp(rpcg.scenes.data[i].name, name)) {
-			scene = &rpcg.scenes.data[i];
-			break;
-		}
-	}
-	if (!scene) {
-		scene = alist_push(NULL, rpc_scene, &rpcg.scenes);
-		scene->arena = arena_create(NULL);
-		scene->name = aalloc_copy_str(scene->arena, name);
-	}
-
 	ufbx_load_opts opts = {
 		.allow_null_material = true,
 	};
@@ -136,18 +529,85 @@ char *rpc_cmd_load_scene(arena_t *tmp, jsi_obj *args)
 	ufbx_scene *fbx_scene = ufbx_load_memory(data, size, &opts, &error);
 	if (!fbx_scene) {
 		char *buf = aalloc(tmp, char, 4096);
-		ufbx_format_error(buf, sizeof(buf), &error);
+		ufbx_format_error(buf, 4096, &error);
 		return fmt_error("Failed to load scene:\n%s", buf);
 	}
 
-	scene->fbx_scene = fbx_scene;
+	// Replace a scene previously loaded with the same name
+	rpc_scene *scene = find_scene(name);
+	if (!scene) {
+		scene = rpc_add_scene(name);
+		if (!scene) {
+			ufbx_free_scene(fbx_scene);
+			return fmt_error("Failed to allocate scene");
+		}
+	}
+	rpc_cancel_load(scene);
+	vi_scene_opts vi_opts = rpc_get_scene_opts(args);
+	rpc_set_fbx_scene(scene, fbx_scene, &vi_opts);
 
 	jso_stream s = begin_response();
 	jso_prop(&s, "scene");
-	serialize_scene(&s, fbx_scene);
+	serialize_scene_summary(&s, fbx_scene);
 	return end_response(&s);
 }
 
+// Like `loadScene` but parses the file on a background thread, poll the progress
+// with `pollScene`. Takes ownership of `dataPointer` which must be allocated with
+// `malloc()` and is freed even on failure. The previous scene with the same name
+// stays usable until the new one is polled after finishing.
+char *rpc_cmd_load_scene_async(arena_t *tmp, jsi_obj *args)
+{
+	void *data = (void*)jsi_get_int64(args, "dataPointer", 0);
+	size_t size = (size_t)jsi_get_int64(args, "size", 0);
+	const char *name = jsi_get_str(args, "name", NULL);
+	if (!name) {
+		free(data);
+		return fmt_error("Missing field: 'name'");
+	}
+	if (!data || !size) {
+		char *error = fmt_error("Bad data range: { %p, %zu }", data, size);
+		free(data);
+		return error;
+	}
+
+	rpc_scene *scene = find_scene(name);
+	if (!scene) scene = rpc_add_scene(name);
+	if (!scene) {
+		free(data);
+		return fmt_error("Failed to allocate scene");
+	}
+	rpc_cancel_load(scene);
+
+	rpc_scene_load *load = aalloc(scene->arena, rpc_scene_load, 1);
+	if (!load) {
+		free(data);
+		return fmt_error("Failed to allocate scene");
+	}
+	load->data = data;
+	load->size = size;
+	load->vi_opts = rpc_get_scene_opts(args);
+	scene->load = load;
+
+	// Runs to completion here if threads are not available
+	load->job = tp_job_start(&rpc_load_task, load);
+	if (!load->job) {
+		rpc_free_load(scene);
+		return fmt_error("Failed to start loading");
+	}
+
+	return rpc_poll_scene(tmp, scene);
+}
+
+char *rpc_cmd_poll_scene(arena_t *tmp, jsi_obj *args)
+{
+	const char *name = jsi_get_str(args, "sceneName", NULL);
+	if (!name) return fmt_error("Missing field: 'sceneName'");
+	rpc_scene *scene = find_scene(name);
+	if (!scene) return fmt_error("Scene not found: '%s'", name);
+	return rpc_poll_scene(tmp, scene);
+}
+
 static um_vec3 get_vec3(jsi_obj *parent, const char *name, um_vec3 def)
 {
 	jsi_obj *obj = jsi_get_obj(parent, name);
@@ -161,42 +621,58 @@ static um_vec3 get_vec3(jsi_obj *parent, const char *name, um_vec3 def)
 	}
 }
 
-static rpc_scene *find_scene(const char *name)
+// Create the viewer scene of a loaded `scene` if it is not resident, returns false on failure
+static bool rpc_ensure_vi_scene(rpc_scene *scene)
 {
-	for (size_t i = 0; i < rpcg.scenes.count; i++) {
-		if (!strcmp(rpcg.scenes.data[i].name, name)) {
-			return &rpcg.scenes.data[i];
-		}
-	}
-	return NULL;
+	rpc_touch_scene(scene);
+	if (scene->vi_scene) return true;
+
+	scene->vi_scene = vi_make_scene(scene->fbx_scene, &scene->vi_opts);
+	if (!scene->vi_scene) return false;
+	rpcg.stats.num_resident++;
+	rpc_update_scene_memory(scene);
+	rpc_enforce_scene_budget(scene);
+	return true;
 }
 
-char *rpc_cmd_render(arena_t *tmp, jsi_obj *args)
+// Shared by the JSON and binary render commands, returns an error response on failure
+static char *rpc_render(const char *scene_name, const vi_target *target, const vi_desc *desc, vi_render_stats *stats)
 {
-	jsi_obj *target = jsi_get_obj(args, "target");
-	jsi_obj *desc = jsi_get_obj(args, "desc");
-	if (!target) return fmt_error("Missing field: 'target'");
-	if (!desc) return fmt_error("Missing field: 'desc'");
+	vi_setup();
 
-	vi_target vtarget = {
-		.target_index = (uint32_t)jsi_get_int(target, "targetIndex", 0),
-		.width = (uint32_t)jsi_get_int(target, "width", 256),
-		.height = (uint32_t)jsi_get_int(target, "height", 256),
-		.samples = (uint32_t)jsi_get_int(target, "samples", 1),
-		.pixel_scale = (float)jsi_get_double(target, "pixelScale", 1.0),
-	};
+	rpc_scene *scene = find_scene(scene_name);
+	if (!scene) return fmt_error("Scene not found: '%s'", scene_name);
+	if (scene->evicted) return fmt_error("Scene evicted: '%s'", scene_name);
+	if (!scene->fbx_scene) return fmt_error("Scene not loaded");
 
-	vi_setup();
+	if (!rpc_ensure_vi_scene(scene)) return fmt_error("Failed to create scene");
 
-	const char *name = jsi_get_str(desc, "sceneName", NULL);
-	if (!name) return fmt_error("Missing field: 'name'");
-	rpc_scene *scene = find_scene(name);
-	if (!scene) return fmt_error("Scene not found: '%s'", name);
+	vi_render(scene->vi_scene, target, desc);
+	*stats = vi_get_render_stats(scene->vi_scene);
 
-	if (!scene->vi_scene) {
-		scene->vi_scene = vi_make_scene(scene->fbx_scene);
+	// Rendering may evaluate a new `fbx_state`
+	rpc_update_scene_memory(scene);
+	rpc_enforce_scene_budget(scene);
+	return NULL;
+}
+
+static bool rpc_get_pixels(uint32_t target, uint32_t width, uint32_t height)
+{
+	size_t required_size = (size_t)width * (size_t)height * 4;
+	size_t capacity = aalloc_capacity_bytes(rpcg.pixel_buffer);
+	if (capacity < required_size) {
+		afree(NULL, rpcg.pixel_buffer);
+		rpcg.pixel_buffer = aalloc(NULL, char, required_size);
 	}
 
+	vi_setup();
+
+	return vi_get_pixels(target, width, height, rpcg.pixel_buffer);
+}
+
+// Parse a viewer description shared by `render` and `pick`
+static void rpc_parse_desc(arena_t *tmp, jsi_obj *desc, vi_desc *vdesc)
+{
 	ufbx_prop_override *overrides = NULL;
 	size_t num_overrides = 0;
 	jsi_arr *js_overrides = jsi_get_arr(desc, "overrides");
@@ -227,7 +703,7 @@ char *rpc_cmd_render(arena_t *tmp, jsi_obj *args)
 
 	jsi_obj *camera = jsi_get_obj(desc, "camera");
 	jsi_obj *animation = jsi_get_obj(desc, "animation");
-	vi_desc vdesc = {
+	*vdesc = (vi_desc){
 		.camera_pos = get_vec3(camera, "position", um_v3(4.0f, 4.0f, 4.0f)),
 		.camera_target = get_vec3(camera, "target", um_zero3),
 		.field_of_view = (float)jsi_get_double(camera, "fieldOfView", 50.0f),
@@ -239,10 +715,47 @@ char *rpc_cmd_render(arena_t *tmp, jsi_obj *args)
 		.overrides = overrides,
 		.num_overrides = num_overrides,
 	};
+}
+
+char *rpc_cmd_render(arena_t *tmp, jsi_obj *args)
+{
+	jsi_obj *target = jsi_get_obj(args, "target");
+	jsi_obj *desc = jsi_get_obj(args, "desc");
+	if (!target) return fmt_error("Missing field: 'target'");
+	if (!desc) return fmt_error("Missing field: 'desc'");
+
+	vi_target vtarget = {
+		.target_index = (uint32_t)jsi_get_int(target, "targetIndex", 0),
+		.width = (uint32_t)jsi_get_int(target, "width", 256),
+		.height = (uint32_t)jsi_get_int(target, "height", 256),
+		.samples = (uint32_t)jsi_get_int(target, "samples", 1),
+		.pixel_scale = (float)jsi_get_double(target, "pixelScale", 1.0),
+	};
+
+	const char *name = jsi_get_str(desc, "sceneName", NULL);
+	if (!name) return fmt_error("Missing field: 'name'");
 
-	vi_render(scene->vi_scene, &vtarget, &vdesc);
+	vi_desc vdesc;
+	rpc_parse_desc(tmp, desc, &vdesc);
+
+	vi_render_stats stats;
+	char *error = rpc_render(name, &vtarget, &vdesc, &stats);
+	if (error) return error;
 
 	jso_stream s = begin_response();
+	jso_prop_object(&s, "stats");
+	jso_prop_int(&s, "drawCalls", (int)stats.draw_calls);
+	jso_prop_int(&s, "instancedDrawCalls", (int)stats.instanced_draw_calls);
+	jso_prop_int(&s, "instances", (int)stats.instances);
+	jso_prop_int(&s, "triangles", (int)stats.triangles);
+	jso_prop_int(&s, "culledDrawCalls", (int)stats.culled_draw_calls);
+	jso_prop_int(&s, "culledInstances", (int)stats.culled_instances);
+	jso_prop_int(&s, "pipelineChanges", (int)stats.pipeline_changes);
+	jso_prop_int(&s, "bindingChanges", (int)stats.binding_changes);
+	jso_prop_int(&s, "uniformChanges", (int)stats.uniform_changes);
+	jso_prop_int(&s, "evaluations", (int)stats.evaluations);
+	jso_prop_int(&s, "globalBufferUploads", (int)stats.global_buffer_uploads);
+	jso_end_object(&s);
 	return end_response(&s);
 }
 
@@ -266,16 +779,7 @@ char *rpc_cmd_get_pixels(arena_t *tmp, jsi_obj *args)
 	uint32_t width = (uint32_t)jsi_get_int(args, "width", 0);
 	uint32_t height = (uint32_t)jsi_get_int(args, "height", 0);
 
-	size_t required_size = (size_t)width * (size_t)height * 4;
-	size_t capacity = aalloc_capacity_bytes(rpcg.pixel_buffer);
-	if (capacity < required_size) {
-		afree(NULL, rpcg.pixel_buffer);
-		rpcg.pixel_buffer = aalloc(NULL, char, required_size);
-	}
-
-	vi_setup();
-
-	if (!vi_get_pixels(target, width, height, rpcg.pixel_buffer)) {
+	if (!rpc_get_pixels(target, width, height)) {
 		return fmt_error("Failed to get pixels");
 	}
 
@@ -289,12 +793,11 @@ char *rpc_cmd_free_resources(arena_t *tmp, jsi_obj *args)
 	bool scenes = jsi_get_bool(args, "scenes", false);
 	bool targets = jsi_get_bool(args, "targets", false);
 	bool globals = jsi_get_bool(args, "globals", false);
+	bool mesh_cache = jsi_get_bool(args, "meshCache", false);
 
 	if (scenes) {
-		for (size_t i = 0; i < rpcg.scenes.count; i++) {
-			rpc_scene *scene = &rpcg.scenes.data[i];
-			vi_free_scene(scene->vi_scene);
-			scene->vi_scene = NULL;
+		for (rpc_scene *scene = rpcg.lru_head; scene; scene = scene->next) {
+			rpc_free_vi_scene(scene);
 		}
 	}
 
@@ -306,6 +809,10 @@ char *rpc_cmd_free_resources(arena_t *tmp, jsi_obj *args)
 		vi_shutdown();
 	}
 
+	if (mesh_cache) {
+		vi_clear_mesh_cache();
+	}
+
 	jso_stream s = begin_response();
 	return end_response(&s);
 }
@@ -344,6 +851,308 @@ char *rpc_cmd_get_vertex(arena_t *tmp, jsi_obj *args)
 	return end_response(&s);
 }
 
+// Fills `rpcg.vertex_buffer` with structure-of-arrays vertex data for `count` indices
+// starting from `begin`: vertex indices as `uint32_t[count]` followed by positions,
+// normals and UVs as tightly packed floats, missing attributes are left out.
+// The buffer is reused by the next call.
+char *rpc_cmd_get_vertex_range(arena_t *tmp, jsi_obj *args)
+{
+	const char *name = jsi_get_str(args, "sceneName", NULL);
+	size_t element_id = (size_t)jsi_get_int64(args, "elementId", -1);
+	size_t begin = (size_t)jsi_get_int64(args, "begin", 0);
+	size_t count = (size_t)jsi_get_int64(args, "count", 0);
+
+	if (!name) return fmt_error("Missing field: 'sceneName'");
+	rpc_scene *scene = find_scene(name);
+	if (!scene) return fmt_error("Scene not found: '%s'", name);
+	if (!scene->fbx_scene) return fmt_error("Scene not loaded");
+
+	ufbx_scene *fbx_scene = scene->fbx_scene;
+	if (element_id >= fbx_scene->elements.count) return fmt_error("Bad element id: %zu", element_id);
+	ufbx_element *element = fbx_scene->elements.data[element_id];
+	if (element->type != UFBX_ELEMENT_MESH) return fmt_error("Element is not a mesh");
+	ufbx_mesh *mesh = (ufbx_mesh*)element;
+
+	begin = begin < mesh->num_indices ? begin : mesh->num_indices;
+	count = count < mesh->num_indices - begin ? count : mesh->num_indices - begin;
+
+	bool has_normal = mesh->vertex_normal.exists;
+	bool has_uv = mesh->vertex_uv.exists;
+
+	size_t position_offset = count * sizeof(uint32_t);
+	size_t normal_offset = position_offset + count * sizeof(float) * 3;
+	size_t uv_offset = normal_offset + (has_normal ? count * sizeof(float) * 3 : 0);
+	size_t required_size = uv_offset + (has_uv ? count * sizeof(float) * 2 : 0);
+
+	size_t capacity = aalloc_capacity_bytes(rpcg.vertex_buffer);
+	if (capacity < required_size) {
+		afree(NULL, rpcg.vertex_buffer);
+		rpcg.vertex_buffer = aalloc(NULL, char, required_size);
+		if (!rpcg.vertex_buffer) return fmt_error("Failed to allocate vertex buffer");
+	}
+
+	char *data = (char*)rpcg.vertex_buffer;
+	uint32_t *dst_vertex_index = (uint32_t*)data;
+	float *dst_position = (float*)(data + position_offset);
+	float *dst_normal = (float*)(data + normal_offset);
+	float *dst_uv = (float*)(data + uv_offset);
+
+	for (size_t i = 0; i < count; i++) {
+		size_t index = begin + i;
+		dst_vertex_index[i] = mesh->vertex_indices.data[index];
+
+		ufbx_vec3 pos = ufbx_get_vertex_vec3(&mesh->vertex_position, index);
+		dst_position[i*3 + 0] = (float)pos.x;
+		dst_position[i*3 + 1] = (float)pos.y;
+		dst_position[i*3 + 2] = (float)pos.z;
+
+		if (has_normal) {
+			ufbx_vec3 normal = ufbx_get_vertex_vec3(&mesh->vertex_normal, index);
+			dst_normal[i*3 + 0] = (float)normal.x;
+			dst_normal[i*3 + 1] = (float)normal.y;
+			dst_normal[i*3 + 2] = (float)normal.z;
+		}
+
+		if (has_uv) {
+			ufbx_vec2 uv = ufbx_get_vertex_vec2(&mesh->vertex_uv, index);
+			dst_uv[i*2 + 0] = (float)uv.x;
+			dst_uv[i*2 + 1] = (float)uv.y;
+		}
+	}
+
+	// Offsets are in bytes from `dataPointer`
+	jso_stream s = begin_response();
+	jso_prop_int64(&s, "dataPointer", (int64_t)(uintptr_t)data);
+	jso_prop_int64(&s, "begin", (int64_t)begin);
+	jso_prop_int64(&s, "count", (int64_t)count);
+	jso_prop_int64(&s, "positionOffset", (int64_t)position_offset);
+	if (has_normal) {
+		jso_prop_int64(&s, "normalOffset", (int64_t)normal_offset);
+	}
+	if (has_uv) {
+		jso_prop_int64(&s, "uvOffset", (int64_t)uv_offset);
+	}
+	return end_response(&s);
+}
+
+char *rpc_cmd_pick(arena_t *tmp, jsi_obj *args)
+{
+	const char *name = jsi_get_str(args, "sceneName", NULL);
+	if (!name) return fmt_error("Missing field: 'sceneName'");
+	rpc_scene *scene = find_scene(name);
+	if (!scene) return fmt_error("Scene not found: '%s'", name);
+	if (!scene->vi_scene) return fmt_error("Scene not rendered");
+
+	// Pixel coordinates from the top-left corner of the target
+	double x = jsi_get_double(args, "x", 0.0);
+	double y = jsi_get_double(args, "y", 0.0);
+	double width = jsi_get_double(args, "width", 1.0);
+	double height = jsi_get_double(args, "height", 1.0);
+	if (!(width > 0.0 && height > 0.0)) return fmt_error("Bad target size: %f x %f", width, height);
+
+	float clip_x = (float)(x / width * 2.0 - 1.0);
+	float clip_y = (float)(1.0 - y / height * 2.0);
+
+	// Pick from the view of `desc` if given as the scene may have been rendered
+	// last by a different viewer, otherwise use the view of the last render.
+	jsi_obj *desc = jsi_get_obj(args, "desc");
+	if (desc) {
+		vi_target vtarget = {
+			.width = width >= 1.0 ? (uint32_t)width : 1,
+			.height = height >= 1.0 ? (uint32_t)height : 1,
+			.pixel_scale = 1.0f,
+		};
+		vi_desc vdesc;
+		rpc_parse_desc(tmp, desc, &vdesc);
+		vi_set_view(scene->vi_scene, &vtarget, &vdesc);
+	}
+
+	vi_pick_result result;
+	bool hit = vi_pick(scene->vi_scene, clip_x, clip_y, &result);
+
+	jso_stream s = begin_response();
+	jso_prop_boolean(&s, "hit", hit);
+	if (hit) {
+		jso_prop_int(&s, "elementId", (int)result.mesh_element_id);
+		jso_prop_int(&s, "nodeId", (int)result.node_element_id);
+		jso_prop_int(&s, "faceIndex", (int)result.face_index);
+		jso_prop_int(&s, "index", (int)result.index);
+		jso_prop_array(&s, "indices");
+		jso_single_line(&s);
+		for (size_t i = 0; i < 3; i++) {
+			jso_int(&s, (int)result.indices[i]);
+		}
+		jso_end_array(&s);
+		jso_prop_um_vec3(&s, "barycentric", result.barycentric);
+		jso_prop_um_vec3(&s, "position", result.position);
+		jso_prop_float(&s, "distance", result.distance);
+	}
+	return end_response(&s);
+}
+
+char *rpc_cmd_get_scene_stats(arena_t *tmp, jsi_obj *args)
+{
+	const char *name = jsi_get_str(args, "sceneName", NULL);
+	if (!name) return fmt_error("Missing field: 'sceneName'");
+	rpc_scene *scene = find_scene(name);
+	if (!scene) return fmt_error("Scene not found: '%s'", name);
+	if (!scene->fbx_scene) return fmt_error("Scene not loaded");
+
+	vi_setup();
+
+	if (!rpc_ensure_vi_scene(scene)) return fmt_error("Failed to create scene");
+
+	size_t num_parts = vi_get_part_stats(scene->vi_scene, NULL, 0);
+	vi_part_stats *parts = aalloc(tmp, vi_part_stats, num_parts);
+	vi_get_part_stats(scene->vi_scene, parts, num_parts);
+
+	um_vec3 bounds_min, bounds_max;
+	bool has_bounds = vi_get_scene_bounds(scene->vi_scene, &bounds_min, &bounds_max);
+
+	jso_stream s = begin_response();
+	if (has_bounds) {
+		jso_prop_object(&s, "bounds");
+		jso_prop_um_vec3(&s, "min", bounds_min);
+		jso_prop_um_vec3(&s, "max", bounds_max);
+		jso_end_object(&s);
+	}
+	jso_prop_array(&s, "parts");
+	for (size_t i = 0; i < num_parts; i++) {
+		vi_part_stats *part = &parts[i];
+		jso_object(&s);
+		jso_single_line(&s);
+		jso_prop_int(&s, "meshId", (int)part->mesh_element_id);
+		jso_prop_int(&s, "materialId", (int)part->material_id);
+		jso_prop_int(&s, "numIndices", (int)part->num_indices);
+		jso_prop_int(&s, "numVertices", (int)part->num_vertices);
+		jso_prop_float(&s, "acmr", part->acmr);
+		jso_prop_float(&s, "atvr", part->atvr);
+		jso_prop_float(&s, "originalAcmr", part->original_acmr);
+		jso_prop_float(&s, "originalAtvr", part->original_atvr);
+		jso_prop_int(&s, "vertexSize", (int)part->vertex_size);
+		jso_prop_float(&s, "maxPositionError", part->max_position_error);
+		jso_prop_float(&s, "maxNormalError", part->max_normal_error);
+		jso_end_object(&s);
+	}
+	jso_end_array(&s);
+
+	vi_mesh_cache_stats cache = vi_get_mesh_cache_stats();
+	jso_prop_object(&s, "meshCache");
+	jso_single_line(&s);
+	jso_prop_int64(&s, "hits", (int64_t)cache.hits);
+	jso_prop_int64(&s, "misses", (int64_t)cache.misses);
+	jso_prop_int64(&s, "evictions", (int64_t)cache.evictions);
+	jso_prop_int64(&s, "numEntries", (int64_t)cache.num_entries);
+	jso_prop_int64(&s, "memoryUsed", (int64_t)cache.memory_used);
+	jso_prop_int64(&s, "memoryBudget", (int64_t)cache.memory_budget);
+	jso_end_object(&s);
+	return end_response(&s);
+}
+
+char *rpc_cmd_get_memory_stats(arena_t *tmp, jsi_obj *args)
+{
+	jso_stream s = begin_response();
+	jso_prop_int64(&s, "memoryUsed", (int64_t)rpcg.stats.memory_used);
+	jso_prop_int64(&s, "memoryBudget", (int64_t)rpcg.stats.memory_budget);
+	jso_prop_int64(&s, "numScenes", (int64_t)rpcg.stats.num_scenes);
+	jso_prop_int64(&s, "numResident", (int64_t)rpcg.stats.num_resident);
+	jso_prop_int64(&s, "maxResident", (int64_t)MAX_LOADED_SCENES);
+	jso_prop_int64(&s, "evictions", (int64_t)rpcg.stats.evictions);
+	jso_prop_int64(&s, "unloads", (int64_t)rpcg.stats.unloads);
+
+	jso_prop_object(&s, "requests");
+	jso_single_line(&s);
+	jso_prop_int64(&s, "calls", (int64_t)g_total_calls);
+	jso_prop_int64(&s, "allocations", (int64_t)g_total_allocations);
+	jso_prop_int64(&s, "responseBufferSize", (int64_t)g_response_capacity);
+	jso_end_object(&s);
+
+	// Most recently rendered first
+	jso_prop_array(&s, "scenes");
+	for (rpc_scene *scene = rpcg.lru_head; scene; scene = scene->next) {
+		jso_object(&s);
+		jso_single_line(&s);
+		jso_prop_string(&s, "name", scene->name);
+		jso_prop_boolean(&s, "loaded", scene->fbx_scene != NULL);
+		jso_prop_boolean(&s, "resident", scene->vi_scene != NULL);
+		jso_prop_boolean(&s, "evicted", scene->evicted);
+		jso_prop_int64(&s, "fbxMemory", (int64_t)scene->fbx_memory);
+		jso_prop_int64(&s, "cpuMemory", (int64_t)scene->vi_memory.cpu);
+		jso_prop_int64(&s, "gpuMemory", (int64_t)scene->vi_memory.gpu);
+		jso_end_object(&s);
+	}
+	jso_end_array(&s);
+
+	vi_mesh_cache_stats cache = vi_get_mesh_cache_stats();
+	jso_prop_object(&s, "meshCache");
+	jso_single_line(&s);
+	jso_prop_int64(&s, "memoryUsed", (int64_t)cache.memory_used);
+	jso_prop_int64(&s, "memoryBudget", (int64_t)cache.memory_budget);
+	jso_end_object(&s);
+	return end_response(&s);
+}
+
+char *rpc_cmd_get_elements(arena_t *tmp, jsi_obj *args)
+{
+	const char *name = jsi_get_str(args, "sceneName", NULL);
+	if (!name) return fmt_error("Missing field: 'sceneName'");
+	rpc_scene *scene = find_scene(name);
+	if (!scene) return fmt_error("Scene not found: '%s'", name);
+	if (!scene->fbx_scene) return fmt_error("Scene not loaded");
+
+	size_t num_elements = scene->fbx_scene->elements.count;
+	size_t begin = (size_t)jsi_get_int64(args, "begin", 0);
+	size_t count = (size_t)jsi_get_int64(args, "count", (int64_t)num_elements);
+	if (begin > num_elements) begin = num_elements;
+	if (count > num_elements - begin) count = num_elements - begin;
+
+	uint32_t flags = SERIALIZE_ELEMENT_DATA;
+	jsi_arr *fields = jsi_get_arr(args, "fields");
+	if (fields) {
+		flags = 0;
+		for (size_t i = 0; i < fields->num_values; i++) {
+			const char *field = jsi_as_str(&fields->values[i], "");
+			if (!strcmp(field, "props")) {
+				flags |= SERIALIZE_ELEMENT_PROPS;
+			} else if (!strcmp(field, "data")) {
+				flags |= SERIALIZE_ELEMENT_DATA;
+			} else {
+				return fmt_error("Unknown element field: '%s'", field);
+			}
+		}
+	}
+
+	jso_stream s = begin_response();
+	jso_prop_int64(&s, "begin", (int64_t)begin);
+	jso_prop_array(&s, "elements");
+	for (size_t i = 0; i < count; i++) {
+		serialize_element(&s, scene->fbx_scene->elements.data[begin + i], flags);
+	}
+	jso_end_array(&s);
+	return end_response(&s);
+}
+
+char *rpc_cmd_get_scene_table(arena_t *tmp, jsi_obj *args)
+{
+	const char *name = jsi_get_str(args, "sceneName", NULL);
+	if (!name) return fmt_error("Missing field: 'sceneName'");
+	rpc_scene *scene = find_scene(name);
+	if (!scene) return fmt_error("Scene not found: '%s'", name);
+	if (!scene->fbx_scene) return fmt_error("Scene not loaded");
+
+	if (!scene->table) {
+		scene->table_size = serialize_scene_table(scene->arena, scene->fbx_scene, &scene->table);
+		if (!scene->table) return fmt_error("Failed to serialize scene table");
+		rpc_update_scene_memory(scene);
+	}
+
+	// Valid until the scene is reloaded
+	jso_stream s = begin_response();
+	jso_prop_int64(&s, "dataPointer", (int64_t)(uintptr_t)scene->table);
+	jso_prop_int64(&s, "size", (int64_t)scene->table_size);
+	return end_response(&s);
+}
+
 char *rpc_handle(arena_t *tmp, jsi_value *value)
 {
 	jsi_obj *obj = jsi_as_obj(value);
@@ -354,6 +1163,10 @@ char *rpc_handle(arena_t *tmp, jsi_value *value)
 		return rpc_cmd_init(tmp, obj);
 	} else if (!strcmp(cmd, "loadScene")) {
 		return rpc_cmd_load_scene(tmp, obj);
+	} else if (!strcmp(cmd, "loadSceneAsync")) {
+		return rpc_cmd_load_scene_async(tmp, obj);
+	} else if (!strcmp(cmd, "pollScene")) {
+		return rpc_cmd_poll_scene(tmp, obj);
 	} else if (!strcmp(cmd, "render")) {
 		return rpc_cmd_render(tmp, obj);
 	} else if (!strcmp(cmd, "present")) {
@@ -364,40 +1177,255 @@ char *rpc_handle(arena_t *tmp, jsi_value *value)
 		return rpc_cmd_free_resources(tmp, obj);
 	} else if (!strcmp(cmd, "getVertex")) {
 		return rpc_cmd_get_vertex(tmp, obj);
+	} else if (!strcmp(cmd, "getVertexRange")) {
+		return rpc_cmd_get_vertex_range(tmp, obj);
+	} else if (!strcmp(cmd, "pick")) {
+		return rpc_cmd_pick(tmp, obj);
+	} else if (!strcmp(cmd, "getSceneStats")) {
+		return rpc_cmd_get_scene_stats(tmp, obj);
+	} else if (!strcmp(cmd, "getMemoryStats")) {
+		return rpc_cmd_get_memory_stats(tmp, obj);
+	} else if (!strcmp(cmd, "getElements")) {
+		return rpc_cmd_get_elements(tmp, obj);
+	} else if (!strcmp(cmd, "getSceneTable")) {
+		return rpc_cmd_get_scene_table(tmp, obj);
 	} else {
 		return fmt_error("Unknown cmd: '%s'\n", cmd);
 	}
 }
 
-char *rpc_call(char *input)
+// Handle an array of commands with a shared temporary arena, the response is an
+// array of the individual responses, each with its own `rpc.duration`
+// Writes the responses into the response buffer one after another
+static char *rpc_handle_batch(arena_t *tmp, jsi_arr *batch)
+{
+	size_t begin = g_response_end;
+	if (!rpc_append_response("[", 1)) return NULL;
+	for (size_t i = 0; i < batch->num_values; i++) {
+		if (i > 0 && !rpc_append_response(",", 1)) return NULL;
+		g_start_cpu_tick = cputime_cpu_tick();
+		if (!rpc_handle(tmp, &batch->values[i])) {
+			if (!rpc_append_response("null", 4)) return NULL;
+		}
+	}
+	if (!rpc_append_response("]", 1)) return NULL;
+	return g_response + begin;
+}
+
+static void *rpc_parse_alloc(void *user, size_t size)
+{
+	g_call_allocations++;
+	return malloc(size);
+}
+
+static void *rpc_parse_realloc(void *user, void *ptr, size_t new_size, size_t old_size)
+{
+	g_call_allocations++;
+	return realloc(ptr, new_size);
+}
+
+static void rpc_parse_free(void *user, void *ptr, size_t size)
+{
+	free(ptr);
+}
+
+static const char *rpc_finish_call(char *result, size_t *p_length)
+{
+	if (!result) result = g_out_of_memory_response;
+	if (g_verbose) {
+		log_printf("RPC response: %s\n", result);
+	}
+	g_total_calls++;
+	g_total_allocations += g_call_allocations;
+	if (p_length) {
+		*p_length = result == g_out_of_memory_response ? strlen(result) : (size_t)(g_response + g_response_end - result);
+	}
+	return result;
+}
+
+const char *rpc_call(char *input, size_t *p_length)
 {
 	if (g_verbose) {
 		log_printf("RPC request: %s\n", input);
 	}
 
+	g_response_end = 0;
+	g_call_allocations = 0;
+
+	// Strings in `value` point into `input` so it must be freed after handling
+	jsi_allocator allocator = {
+		.alloc_fn = &rpc_parse_alloc,
+		.realloc_fn = &rpc_parse_realloc,
+		.free_fn = &rpc_parse_free,
+	};
 	jsi_args args = {
+		.result_buffer = rpcg.parse_buffer,
+		.result_size = sizeof(rpcg.parse_buffer),
+		.result_allocator = allocator,
+		.temp_allocator = allocator,
 		.store_integers_as_int64 = true,
+		.in_situ = true,
 	};
 	jsi_value *value = jsi_parse_string(input, &args);
-	free(input);
 
 	cputime_begin_init();
 	g_start_cpu_tick = cputime_cpu_tick();
 
 	if (!value) {
-		return fmt_error("Failed to parse JSON: %zu:%zu: %s",
-			args.error.line, args.error.column, args.error.description);
+		free(input);
+		return rpc_finish_call(fmt_error("Failed to parse JSON: %zu:%zu: %s",
+			args.error.line, args.error.column, args.error.description), p_length);
 	}
 
 	arena_t tmp;
 	arena_init(&tmp, NULL);
-	char *result = rpc_handle(&tmp, value);
+	jsi_arr *batch = value->type == jsi_type_array ? value->array : NULL;
+	char *result = batch ? rpc_handle_batch(&tmp, batch) : rpc_handle(&tmp, value);
 	arena_free(&tmp);
 
+	jsi_free(value);
+	free(input);
+	return rpc_finish_call(result, p_length);
+}
+
+// -- Binary commands
+
+// Returns a string at `offset` bytes from `base` if it is terminated within `size`
+static const char *rpc_bin_string(const void *base, uint32_t size, uint32_t offset)
+{
+	if (offset >= size) return NULL;
+	const char *str = (const char*)base + offset;
+	if (!memchr(str, '\0', size - offset)) return NULL;
+	return str;
+}
+
+static char *rpc_bin_cmd_render(arena_t *tmp, rpc_bin_render *cmd)
+{
+	uint32_t size = cmd->header.size;
+	if (size < sizeof(rpc_bin_render)) return fmt_error("Bad render command size: %u", size);
+
+	const char *name = rpc_bin_string(cmd, size, cmd->scene_name_offset);
+	if (!name) return fmt_error("Bad field: 'sceneNameOffset'");
+
+	vi_target vtarget = {
+		.target_index = cmd->target_index,
+		.width = cmd->width,
+		.height = cmd->height,
+		.samples = cmd->samples,
+		.pixel_scale = cmd->pixel_scale,
+	};
+
+	ufbx_prop_override *overrides = NULL;
+	size_t num_overrides = cmd->num_overrides;
+	if (num_overrides > 0) {
+		size_t offset = cmd->overrides_offset;
+		if (offset % sizeof(uint32_t) != 0 || offset > size || (size - offset) / sizeof(rpc_bin_override) < num_overrides) {
+			return fmt_error("Bad field: 'overridesOffset'");
+		}
+
+		const rpc_bin_override *src = (const rpc_bin_override*)((const char*)cmd + offset);
+		overrides = aalloc(tmp, ufbx_prop_override, num_overrides);
+		for (size_t i = 0; i < num_overrides; i++) {
+			const char *prop_name = rpc_bin_string(cmd, size, src[i].name_offset);
+			if (!prop_name) return fmt_error("Bad field: 'overrides[%zu].nameOffset'", i);
+			overrides[i].element_id = src[i].element_id;
+			overrides[i].prop_name = prop_name;
+			overrides[i].value.x = src[i].value[0];
+			overrides[i].value.y = src[i].value[1];
+			overrides[i].value.z = src[i].value[2];
+		}
+
+		ufbx_prepare_prop_overrides(overrides, num_overrides);
+	}
+
+	vi_desc vdesc = {
+		.camera_pos = um_v3(cmd->camera_position[0], cmd->camera_position[1], cmd->camera_position[2]),
+		.camera_target = um_v3(cmd->camera_target[0], cmd->camera_target[1], cmd->camera_target[2]),
+		.field_of_view = cmd->field_of_view,
+		.near_plane = cmd->near_plane,
+		.far_plane = cmd->far_plane,
+		.selected_element_id = (uint32_t)cmd->selected_element,
+		.highlight_vertex_index = (uint32_t)cmd->highlight_vertex_index,
+		.time = cmd->time,
+		.overrides = overrides,
+		.num_overrides = num_overrides,
+	};
+
+	vi_render_stats stats;
+	char *error = rpc_render(name, &vtarget, &vdesc, &stats);
+	if (error) return error;
+
+	cmd->stats = (rpc_bin_render_stats){
+		.draw_calls = (uint32_t)stats.draw_calls,
+		.instanced_draw_calls = (uint32_t)stats.instanced_draw_calls,
+		.instances = (uint32_t)stats.instances,
+		.triangles = (uint32_t)stats.triangles,
+		.culled_draw_calls = (uint32_t)stats.culled_draw_calls,
+		.culled_instances = (uint32_t)stats.culled_instances,
+		.pipeline_changes = (uint32_t)stats.pipeline_changes,
+		.binding_changes = (uint32_t)stats.binding_changes,
+		.uniform_changes = (uint32_t)stats.uniform_changes,
+		.evaluations = (uint32_t)stats.evaluations,
+		.global_buffer_uploads = (uint32_t)stats.global_buffer_uploads,
+	};
+	return NULL;
+}
+
+static char *rpc_bin_cmd_present(arena_t *tmp, rpc_bin_target *cmd)
+{
+	if (cmd->header.size < sizeof(rpc_bin_target)) return fmt_error("Bad present command size: %u", cmd->header.size);
+
+	vi_setup();
+
+	vi_present(cmd->target_index, cmd->width, cmd->height);
+	return NULL;
+}
+
+static char *rpc_bin_cmd_get_pixels(arena_t *tmp, rpc_bin_target *cmd)
+{
+	if (cmd->header.size < sizeof(rpc_bin_target)) return fmt_error("Bad getPixels command size: %u", cmd->header.size);
+
+	if (!rpc_get_pixels(cmd->target_index, cmd->width, cmd->height)) {
+		return fmt_error("Failed to get pixels");
+	}
+
+	cmd->data_pointer = (uint64_t)(uintptr_t)rpcg.pixel_buffer;
+	return NULL;
+}
+
+const char *rpc_call_binary(void *input)
+{
+	rpc_bin_header *header = (rpc_bin_header*)input;
 	if (g_verbose) {
-		log_printf("RPC response: %s\n", result);
+		log_printf("RPC binary request: %u\n", header->cmd);
 	}
 
-	jsi_free(value);
-	return result;
+	g_response_end = 0;
+	g_call_allocations = 0;
+
+	cputime_begin_init();
+	g_start_cpu_tick = cputime_cpu_tick();
+
+	arena_t tmp;
+	arena_init(&tmp, NULL);
+
+	char *result = NULL;
+	switch (header->cmd) {
+	case RPC_BIN_RENDER: result = rpc_bin_cmd_render(&tmp, (rpc_bin_render*)input); break;
+	case RPC_BIN_PRESENT: result = rpc_bin_cmd_present(&tmp, (rpc_bin_target*)input); break;
+	case RPC_BIN_GET_PIXELS: result = rpc_bin_cmd_get_pixels(&tmp, (rpc_bin_target*)input); break;
+	default: result = fmt_error("Unknown binary cmd: %u", header->cmd); break;
+	}
+
+	arena_free(&tmp);
+
+	cputime_end_init();
+	header->duration = cputime_cpu_delta_to_sec(NULL, cputime_cpu_tick() - g_start_cpu_tick);
+
+	if (!result) {
+		g_total_calls++;
+		g_total_allocations += g_call_allocations;
+		return NULL;
+	}
+	return rpc_finish_call(result, NULL);
 }
@@ -1,4 +1,83 @@
 #pragma once
 
-char *rpc_call(char *input);
+#include <stddef.h>
+#include <stdint.h>
 
+// Takes ownership of a JSON command `{ "cmd": ... }` or an array of commands,
+// returns the response (or an array of responses) and its length to `p_length`.
+// The response is owned by the RPC layer and only valid until the next call.
+const char *rpc_call(char *input, size_t *p_length);
+
+// Binary fast path for the commands issued every frame. The caller writes one of
+// the `rpc_bin_*` structs below into memory and passes a pointer to it, outputs
+// are written back into the same struct. Strings are NUL-terminated and referred
+// to by a byte offset from the start of the command, they and other variable
+// length data must be within `rpc_bin_header.size` bytes.
+// Returns NULL on success, or an error response like `rpc_call()`.
+const char *rpc_call_binary(void *input);
+
+enum {
+	RPC_BIN_RENDER = 1,
+	RPC_BIN_PRESENT = 2,
+	RPC_BIN_GET_PIXELS = 3,
+};
+
+typedef struct {
+	uint32_t cmd;    // RPC_BIN_*
+	uint32_t size;   // Total size of the command in bytes
+	double duration; // Output: Seconds spent in the call
+} rpc_bin_header;
+
+typedef struct {
+	uint32_t element_id;
+	uint32_t name_offset;
+	float value[3];
+} rpc_bin_override;
+
+typedef struct {
+	uint32_t draw_calls;
+	uint32_t instanced_draw_calls;
+	uint32_t instances;
+	uint32_t triangles;
+	uint32_t culled_draw_calls;
+	uint32_t culled_instances;
+	uint32_t pipeline_changes;
+	uint32_t binding_changes;
+	uint32_t uniform_changes;
+	uint32_t evaluations;
+	uint32_t global_buffer_uploads;
+	uint32_t padding_0;
+} rpc_bin_render_stats;
+
+// Byte offsets are fixed so that they can be written from JavaScript, see `script/viewer/rpc.js`
+typedef struct {
+	rpc_bin_header header;          // 0
+	uint32_t target_index;          // 16
+	uint32_t width;                 // 20
+	uint32_t height;                // 24
+	uint32_t samples;               // 28
+	float pixel_scale;              // 32
+	uint32_t scene_name_offset;     // 36
+	float camera_position[3];       // 40
+	float camera_target[3];         // 52
+	float field_of_view;            // 64
+	float near_plane;               // 68
+	float far_plane;                // 72
+	int32_t selected_element;       // 76
+	int32_t highlight_vertex_index; // 80
+	uint32_t num_overrides;         // 84
+	uint32_t overrides_offset;      // 88, array of `rpc_bin_override`
+	uint32_t padding_0;             // 92
+	double time;                    // 96
+	rpc_bin_render_stats stats;     // 104, output
+} rpc_bin_render;
+
+// Used for both `RPC_BIN_PRESENT` and `RPC_BIN_GET_PIXELS`
+typedef struct {
+	rpc_bin_header header; // 0
+	uint32_t target_index; // 16
+	uint32_t width;        // 20
+	uint32_t height;       // 24
+	uint32_t padding_0;    // 28
+	uint64_t data_pointer; // 32, output for `RPC_BIN_GET_PIXELS`
+} rpc_bin_target;
@@ -1,4 +1,5 @@
 #include "serialization.h"
+#include <string.h>
 
 const char *prop_type_str(ufbx_prop_type type)
 {
@@ -33,6 +34,7 @@ const char *element_type_str(ufbx_element_type type)
 	case UFBX_ELEMENT_MARKER: return "marker";
 	case UFBX_ELEMENT_LINE_CURVE: return "line_curve";
 	case UFBX_ELEMENT_NURBS_CURVE: return "nurbs_curve";
+	case UFBX_ELEMENT_NURBS_SURFACE: return "nurbs_surface";
 	case UFBX_ELEMENT_NURBS_TRIM_SURFACE: return "nurbs_trim_surface";
 	case UFBX_ELEMENT_NURBS_TRIM_BOUNDARY: return "nurbs_trim_boundary";
 	case UFBX_ELEMENT_PROCEDURAL_GEOMETRY: return "procedural_geometry";
@@ -318,14 +320,22 @@ void serialize_element_metadata_object(jso_stream *s, ufbx_metadata_object* elem
 {
 }
 
-void serialize_element(jso_stream *s, ufbx_element *elem)
+void serialize_element(jso_stream *s, ufbx_element *elem, uint32_t flags)
 {
 	jso_object(s);
 	jso_prop_ustring(s, "name", elem->name);
 	jso_prop_string(s, "type", element_type_str(elem->type));
 	jso_prop_int(s, "id", (int)elem->element_id);
-	jso_prop(s, "props");
-	serialize_props(s, &elem->props);
+
+	if (flags & SERIALIZE_ELEMENT_PROPS) {
+		jso_prop(s, "props");
+		serialize_props(s, &elem->props);
+	}
+
+	if (!(flags & SERIALIZE_ELEMENT_DATA)) {
+		jso_end_object(s);
+		return;
+	}
 
     switch (elem->type) {
 	case UFBX_ELEMENT_UNKNOWN: serialize_element_unknown(s, (ufbx_unknown*)elem); break;
@@ -374,24 +384,300 @@ void serialize_element(jso_stream *s, ufbx_element *elem)
 	jso_end_object(s);
 }
 
-void serialize_scene(jso_stream *s, ufbx_scene *scene)
+void serialize_scene_summary(jso_stream *s, ufbx_scene *scene)
 {
 	jso_object(s);
 
-	jso_prop_object(s, "settings");
-	jso_prop(s, "props");
-	serialize_props(s, &scene->settings.props);
-	jso_end_object(s);
-
 	if (scene->root_node) {
 		jso_prop_int(s, "rootNode", (int)scene->root_node->element_id);
 	}
-
-	jso_prop_array(s, "elements");
-	for (size_t i = 0; i < scene->elements.count; i++) {
-		serialize_element(s, scene->elements.data[i]);
+	jso_prop_int(s, "numElements", (int)scene->elements.count);
+
+	jso_prop_object(s, "elementCounts");
+	jso_single_line(s);
+	for (int type = 0; type < UFBX_ELEMENT_TYPE_COUNT; type++) {
+		size_t count = scene->elements_by_type[type].count;
+		if (count > 0) {
+			jso_prop_int(s, element_type_str((ufbx_element_type)type), (int)count);
+		}
 	}
-	jso_end_array(s);
+	jso_end_object(s);
 
 	jso_end_object(s);
 }
+
+// -- Binary scene table
+
+typedef struct {
+	arena_t *arena;
+
+	alist_t(uint32_t) string_begin;
+	alist_t(char) string_data;
+	uint32_t *string_slots; // String index + 1, zero if empty
+	size_t num_string_slots;
+
+	alist_t(uint32_t) link_ids;
+	alist_t(uint32_t) link_kinds;
+
+	uint32_t kind_attribs, kind_children, kind_materials, kind_deformers;
+	uint32_t kind_clusters, kind_bone, kind_channels, kind_keyframes, kind_textures;
+} scene_table_builder;
+
+static uint32_t scene_table_hash(const char *str, size_t length)
+{
+	uint32_t h = 2166136261u;
+	for (size_t i = 0; i < length; i++) {
+		h = (h ^ (uint8_t)str[i]) * 16777619u;
+	}
+	return h;
+}
+
+static bool scene_table_string_equal(scene_table_builder *b, uint32_t index, const char *str, size_t length)
+{
+	uint32_t begin = b->string_begin.data[index];
+	uint32_t end = b->string_begin.data[index + 1];
+	return end - begin == length && !memcmp(b->string_data.data + begin, str, length);
+}
+
+static void scene_table_rehash(scene_table_builder *b, size_t num_slots)
+{
+	afree(b->arena, b->string_slots);
+	b->string_slots = aalloc(b->arena, uint32_t, num_slots);
+	b->num_string_slots = num_slots;
+
+	size_t num_strings = b->string_begin.count - 1;
+	for (size_t i = 0; i < num_strings; i++) {
+		uint32_t begin = b->string_begin.data[i], end = b->string_begin.data[i + 1];
+		size_t slot = scene_table_hash(b->string_data.data + begin, end - begin) & (num_slots - 1);
+		while (b->string_slots[slot] != 0) {
+			slot = (slot + 1) & (num_slots - 1);
+		}
+		b->string_slots[slot] = (uint32_t)i + 1;
+	}
+}
+
+static uint32_t scene_table_string_len(scene_table_builder *b, const char *str, size_t length)
+{
+	size_t mask = b->num_string_slots - 1;
+	size_t slot = scene_table_hash(str, length) & mask;
+	for (;;) {
+		uint32_t entry = b->string_slots[slot];
+		if (entry == 0) break;
+		if (scene_table_string_equal(b, entry - 1, str, length)) return entry - 1;
+		slot = (slot + 1) & mask;
+	}
+
+	uint32_t index = (uint32_t)(b->string_begin.count - 1);
+	char *dst = alist_push_n(b->arena, char, &b->string_data, length);
+	if (length > 0) memcpy(dst, str, length);
+	*alist_push(b->arena, uint32_t, &b->string_begin) = (uint32_t)b->string_data.count;
+	b->string_slots[slot] = index + 1;
+
+	// Keep the load factor below one half
+	if ((size_t)index * 2 >= b->num_string_slots) {
+		scene_table_rehash(b, b->num_string_slots * 2);
+	}
+	return index;
+}
+
+static uint32_t scene_table_string(scene_table_builder *b, const char *str)
+{
+	return scene_table_string_len(b, str, strlen(str));
+}
+
+static void scene_table_link(scene_table_builder *b, uint32_t kind, ufbx_element *elem)
+{
+	if (!elem) return;
+	*alist_push(b->arena, uint32_t, &b->link_ids) = elem->element_id;
+	*alist_push(b->arena, uint32_t, &b->link_kinds) = kind;
+}
+
+// Same references as the "data" of `serialize_element()`
+static void scene_table_element_links(scene_table_builder *b, ufbx_element *elem)
+{
+	switch (elem->type) {
+	case UFBX_ELEMENT_NODE: {
+		ufbx_node *node = (ufbx_node*)elem;
+		for (size_t i = 0; i < node->all_attribs.count; i++) {
+			scene_table_link(b, b->kind_attribs, node->all_attribs.data[i]);
+		}
+		for (size_t i = 0; i < node->children.count; i++) {
+			scene_table_link(b, b->kind_children, &node->children.data[i]->element);
+		}
+	} break;
+	case UFBX_ELEMENT_MESH: {
+		ufbx_mesh *mesh = (ufbx_mesh*)elem;
+		for (size_t i = 0; i < mesh->materials.count; i++) {
+			ufbx_material *material = mesh->materials.data[i].material;
+			scene_table_link(b, b->kind_materials, material ? &material->element : NULL);
+		}
+		for (size_t i = 0; i < mesh->all_deformers.count; i++) {
+			scene_table_link(b, b->kind_deformers, mesh->all_deformers.data[i]);
+		}
+	} break;
+	case UFBX_ELEMENT_SKIN_DEFORMER: {
+		ufbx_skin_deformer *skin = (ufbx_skin_deformer*)elem;
+		for (size_t i = 0; i < skin->clusters.count; i++) {
+			scene_table_link(b, b->kind_clusters, &skin->clusters.data[i]->element);
+		}
+	} break;
+	case UFBX_ELEMENT_SKIN_CLUSTER: {
+		ufbx_skin_cluster *cluster = (ufbx_skin_cluster*)elem;
+		scene_table_link(b, b->kind_bone, cluster->bone_node ? &cluster->bone_node->element : NULL);
+	} break;
+	case UFBX_ELEMENT_BLEND_DEFORMER: {
+		ufbx_blend_deformer *blend = (ufbx_blend_deformer*)elem;
+		for (size_t i = 0; i < blend->channels.count; i++) {
+			scene_table_link(b, b->kind_channels, &blend->channels.data[i]->element);
+		}
+	} break;
+	case UFBX_ELEMENT_BLEND_CHANNEL: {
+		ufbx_blend_channel *channel = (ufbx_blend_channel*)elem;
+		for (size_t i = 0; i < channel->keyframes.count; i++) {
+			ufbx_blend_shape *shape = channel->keyframes.data[i].shape;
+			scene_table_link(b, b->kind_keyframes, shape ? &shape->element : NULL);
+		}
+	} break;
+	case UFBX_ELEMENT_MATERIAL: {
+		ufbx_material *material = (ufbx_material*)elem;
+		for (size_t i = 0; i < material->textures.count; i++) {
+			scene_table_link(b, b->kind_textures, &material->textures.data[i].texture->element);
+		}
+	} break;
+	default: break;
+	}
+}
+
+static uint32_t scene_table_section(uint32_t *p_offset, size_t size, uint32_t align)
+{
+	uint32_t offset = (*p_offset + align - 1) & ~(align - 1);
+	*p_offset = offset + (uint32_t)((size + 3) & ~(size_t)3);
+	return offset;
+}
+
+// Empty arrays may be NULL so skip them instead of passing NULL to `memcpy()`
+static void scene_table_copy(char *data, uint32_t offset, const void *src, size_t size)
+{
+	if (size > 0) {
+		memcpy(data + offset, src, size);
+	}
+}
+
+size_t serialize_scene_table(arena_t *arena, ufbx_scene *scene, void **p_data)
+{
+	arena_t tmp;
+	arena_init(&tmp, NULL);
+
+	scene_table_builder b = { &tmp };
+	*alist_push(&tmp, uint32_t, &b.string_begin) = 0;
+	scene_table_rehash(&b, 256);
+
+	b.kind_attribs = scene_table_string(&b, "attribs");
+	b.kind_children = scene_table_string(&b, "children");
+	b.kind_materials = scene_table_string(&b, "materials");
+	b.kind_deformers = scene_table_string(&b, "deformers");
+	b.kind_clusters = scene_table_string(&b, "clusters");
+	b.kind_bone = scene_table_string(&b, "bone");
+	b.kind_channels = scene_table_string(&b, "channels");
+	b.kind_keyframes = scene_table_string(&b, "keyframes");
+	b.kind_textures = scene_table_string(&b, "textures");
+
+	size_t num_elements = scene->elements.count;
+	size_t num_props = 0;
+	for (size_t i = 0; i < num_elements; i++) {
+		num_props += scene->elements.data[i]->props.props.count;
+	}
+
+	uint32_t *element_names = aalloc(&tmp, uint32_t, num_elements);
+	uint32_t *element_types = aalloc(&tmp, uint32_t, num_elements);
+	uint32_t *element_parents = aalloc(&tmp, uint32_t, num_elements);
+	uint32_t *link_begin = aalloc(&tmp, uint32_t, num_elements + 1);
+	uint32_t *prop_begin = aalloc(&tmp, uint32_t, num_elements + 1);
+	uint32_t *prop_names = aalloc(&tmp, uint32_t, num_props);
+	uint32_t *prop_types = aalloc(&tmp, uint32_t, num_props);
+	uint32_t *prop_value_strs = aalloc(&tmp, uint32_t, num_props);
+	double *prop_values = aalloc(&tmp, double, num_props * 3);
+
+	size_t prop_index = 0;
+	for (size_t i = 0; i < num_elements; i++) {
+		ufbx_element *elem = scene->elements.data[i];
+		element_names[i] = scene_table_string_len(&b, elem->name.data, elem->name.length);
+		element_types[i] = scene_table_string(&b, element_type_str(elem->type));
+
+		ufbx_node *node = elem->type == UFBX_ELEMENT_NODE ? (ufbx_node*)elem : NULL;
+		element_parents[i] = node && node->parent ? node->parent->element_id : ~0u;
+
+		link_begin[i] = (uint32_t)b.link_ids.count;
+		scene_table_element_links(&b, elem);
+
+		prop_begin[i] = (uint32_t)prop_index;
+		for (size_t pi = 0; pi < elem->props.props.count; pi++) {
+			ufbx_prop *prop = &elem->props.props.data[pi];
+			prop_names[prop_index] = scene_table_string_len(&b, prop->name.data, prop->name.length);
+			prop_types[prop_index] = scene_table_string(&b, prop_type_str(prop->type));
+			prop_value_strs[prop_index] = scene_table_string_len(&b, prop->value_str.data, prop->value_str.length);
+			prop_values[prop_index * 3 + 0] = (double)prop->value_vec3.x;
+			prop_values[prop_index * 3 + 1] = (double)prop->value_vec3.y;
+			prop_values[prop_index * 3 + 2] = (double)prop->value_vec3.z;
+			prop_index++;
+		}
+	}
+	link_begin[num_elements] = (uint32_t)b.link_ids.count;
+	prop_begin[num_elements] = (uint32_t)prop_index;
+
+	size_t num_links = b.link_ids.count;
+	size_t num_strings = b.string_begin.count - 1;
+
+	scene_table_header header = {
+		.magic = SCENE_TABLE_MAGIC,
+		.version = SCENE_TABLE_VERSION,
+		.root_node = scene->root_node ? scene->root_node->element_id : ~0u,
+		.num_elements = (uint32_t)num_elements,
+		.num_links = (uint32_t)num_links,
+		.num_props = (uint32_t)num_props,
+		.num_strings = (uint32_t)num_strings,
+		.string_data_size = (uint32_t)b.string_data.count,
+	};
+
+	uint32_t size = (uint32_t)sizeof(scene_table_header);
+	header.element_names = scene_table_section(&size, num_elements * sizeof(uint32_t), 4);
+	header.element_types = scene_table_section(&size, num_elements * sizeof(uint32_t), 4);
+	header.element_parents = scene_table_section(&size, num_elements * sizeof(uint32_t), 4);
+	header.link_begin = scene_table_section(&size, (num_elements + 1) * sizeof(uint32_t), 4);
+	header.link_ids = scene_table_section(&size, num_links * sizeof(uint32_t), 4);
+	header.link_kinds = scene_table_section(&size, num_links * sizeof(uint32_t), 4);
+	header.prop_begin = scene_table_section(&size, (num_elements + 1) * sizeof(uint32_t), 4);
+	header.prop_names = scene_table_section(&size, num_props * sizeof(uint32_t), 4);
+	header.prop_types = scene_table_section(&size, num_props * sizeof(uint32_t), 4);
+	header.prop_value_strs = scene_table_section(&size, num_props * sizeof(uint32_t), 4);
+	header.prop_values = scene_table_section(&size, num_props * 3 * sizeof(double), 8);
+	header.string_begin = scene_table_section(&size, (num_strings + 1) * sizeof(uint32_t), 4);
+	header.string_data = scene_table_section(&size, b.string_data.count, 4);
+
+	char *data = aalloc(arena, char, size);
+	if (!data) {
+		arena_free(&tmp);
+		*p_data = NULL;
+		return 0;
+	}
+
+	memcpy(data, &header, sizeof(header));
+	scene_table_copy(data, header.element_names, element_names, num_elements * sizeof(uint32_t));
+	scene_table_copy(data, header.element_types, element_types, num_elements * sizeof(uint32_t));
+	scene_table_copy(data, header.element_parents, element_parents, num_elements * sizeof(uint32_t));
+	scene_table_copy(data, header.link_begin, link_begin, (num_elements + 1) * sizeof(uint32_t));
+	scene_table_copy(data, header.link_ids, b.link_ids.data, num_links * sizeof(uint32_t));
+	scene_table_copy(data, header.link_kinds, b.link_kinds.data, num_links * sizeof(uint32_t));
+	scene_table_copy(data, header.prop_begin, prop_begin, (num_elements + 1) * sizeof(uint32_t));
+	scene_table_copy(data, header.prop_names, prop_names, num_props * sizeof(uint32_t));
+	scene_table_copy(data, header.prop_types, prop_types, num_props * sizeof(uint32_t));
+	scene_table_copy(data, header.prop_value_strs, prop_value_strs, num_props * sizeof(uint32_t));
+	scene_table_copy(data, header.prop_values, prop_values, num_props * 3 * sizeof(double));
+	scene_table_copy(data, header.string_begin, b.string_begin.data, (num_strings + 1) * sizeof(uint32_t));
+	scene_table_copy(data, header.string_data, b.string_data.data, b.string_data.count);
+
+	arena_free(&tmp);
+
+	*p_data = data;
+	return size;
+}
@@ -1,7 +1,9 @@
 #pragma once
 
 #include "external/json_output.h"
+#include "arena.h"
 #include "ufbx.h"
+#include <stdint.h>
 
 static void jso_prop_vec2(jso_stream *s, const char *name, ufbx_vec2 value)
 {
@@ -25,5 +27,50 @@ static void jso_prop_ustring(jso_stream *s, const char *key, ufbx_string str)
 	jso_prop_string_len(s, key, str.data, str.length);
 }
 
-void serialize_scene(jso_stream *s, ufbx_scene *scene);
+typedef enum {
+	SERIALIZE_ELEMENT_PROPS = 0x1, // `props` array
+	SERIALIZE_ELEMENT_DATA = 0x2,  // Type specific references and fields
+} serialize_element_flags;
 
+// Element counts and the root node, elements are fetched separately
+void serialize_scene_summary(jso_stream *s, ufbx_scene *scene);
+void serialize_element(jso_stream *s, ufbx_element *elem, uint32_t flags);
+void serialize_props(jso_stream *s, ufbx_props *props);
+
+
+// Compact binary encoding of the element hierarchy and props. Strings are
+// deduplicated into a table and referred to by index, including the element and
+// prop type names. All offsets are in bytes from the start of the header and
+// every array is 4-byte aligned (8-byte for doubles), see `script/viewer/scene-table.js`
+// for the decoder.
+#define SCENE_TABLE_MAGIC 0x74626675u // "ufbt"
+#define SCENE_TABLE_VERSION 2u
+
+typedef struct {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t root_node;       // ~0u if none
+	uint32_t num_elements;
+	uint32_t num_links;
+	uint32_t num_props;
+	uint32_t num_strings;
+	uint32_t string_data_size;
+
+	uint32_t element_names;   // uint32_t[num_elements], string index
+	uint32_t element_types;   // uint32_t[num_elements], string index
+	uint32_t element_parents; // uint32_t[num_elements], parent node or ~0u
+	uint32_t link_begin;      // uint32_t[num_elements + 1], index to `link_*`
+	uint32_t link_ids;        // uint32_t[num_links], referenced element
+	uint32_t link_kinds;      // uint32_t[num_links], string index of the field eg. "children"
+	uint32_t prop_begin;      // uint32_t[num_elements + 1], index to `prop_*`
+	uint32_t prop_names;      // uint32_t[num_props], string index
+	uint32_t prop_types;      // uint32_t[num_props], string index
+	uint32_t prop_value_strs; // uint32_t[num_props], string index
+	uint32_t prop_values;     // double[num_props * 3], `ufbx_prop.value_vec3`
+	uint32_t string_begin;    // uint32_t[num_strings + 1], offset into `string_data`
+	uint32_t string_data;     // char[string_data_size], UTF-8 without terminators
+} scene_table_header;
+
+// Returns the size of the table allocated from `arena` to `*p_data`, or 0 and
+// sets `*p_data` to NULL if out of memory
+size_t serialize_scene_table(arena_t *arena, ufbx_scene *scene, void **p_data);
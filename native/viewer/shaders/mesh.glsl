@@ -3,11 +3,7 @@
 @ctype vec4 um_vec4
 @ctype mat4 um_mat
 
-@vs mesh_vertex
-
-layout(location=0) in vec3 a_position;
-layout(location=1) in vec3 a_normal;
-layout(location=2) in int a_vertex_index;
+@block mesh_deform
 
 out vec3 v_normal;
 out vec2 v_barycentric;
@@ -16,6 +12,8 @@ out float v_highlight;
 uniform ubo_mesh_vertex {
     mat4 u_geometry_to_world;
     mat4 u_world_to_clip;
+    vec4 u_position_offset;
+    vec4 u_position_scale;
     float u_highlight;
     float ui_highlight_cluster;
     float ui_highlight_channel;
@@ -50,15 +48,10 @@ vec4 quatMul(vec4 a, vec4 b)
         a.w*b.w - a.x*b.x - a.y*b.y - a.z*b.z);
 }
 
-void main()
+void deformVertex(mat4 geometry_to_world, float highlight, vec3 geo_pos, vec3 geo_normal, int packed_index)
 {
-    vec3 geo_pos = a_position;
-    vec3 geo_normal = a_normal;
-
-    mat4 geometry_to_world = u_geometry_to_world;
-
-    int bary_index = a_vertex_index & 3;
-    int vertex_index = a_vertex_index >> 2;
+    int bary_index = packed_index & 3;
+    int vertex_index = packed_index >> 2;
 
     vec4 deform_info = bufferRead(u_deform_buffer, vertex_index);
     float dq_weight = clamp(fract(deform_info.x) * 2.0, 0.0, 1.0);
@@ -70,8 +63,6 @@ void main()
         geometry_to_world = mat4(vec4(0.0), vec4(0.0), vec4(0.0), vec4(0.0));
     }
 
-    float highlight = u_highlight;
-
     vec4 q0 = vec4(0.0), qe = vec4(0.0), qs = vec4(0.0);
 
     for (int bone_ix = 0; bone_ix < num_bones; bone_ix++) {
@@ -181,6 +172,101 @@ void main()
 
 @end
 
+@block mesh_compact
+
+// See `vi_compact_vertex`: Position normalized to the part bounds and an
+// octahedral encoded normal, both as signed normalized 16-bit integers.
+layout(location=0) in vec4 a_position;
+layout(location=1) in vec2 a_normal;
+layout(location=2) in int a_vertex_index;
+
+vec3 octDecode(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
+
+@end
+
+@block mesh_instance
+
+// See `vi_instance`: Per-instance `geometry_to_world` columns and node highlight
+layout(location=3) in vec4 a_geometry_to_world_0;
+layout(location=4) in vec4 a_geometry_to_world_1;
+layout(location=5) in vec4 a_geometry_to_world_2;
+layout(location=6) in vec4 a_geometry_to_world_3;
+layout(location=7) in float a_instance_highlight;
+
+mat4 instanceGeometryToWorld()
+{
+    return mat4(a_geometry_to_world_0, a_geometry_to_world_1, a_geometry_to_world_2, a_geometry_to_world_3);
+}
+
+@end
+
+@vs mesh_vertex
+
+layout(location=0) in vec3 a_position;
+layout(location=1) in vec3 a_normal;
+layout(location=2) in int a_vertex_index;
+
+@include_block mesh_deform
+
+void main()
+{
+    deformVertex(u_geometry_to_world, u_highlight, a_position, a_normal, a_vertex_index);
+}
+
+@end
+
+@vs mesh_compact_vertex
+
+@include_block mesh_compact
+@include_block mesh_deform
+
+void main()
+{
+    vec3 geo_pos = u_position_offset.xyz + a_position.xyz * u_position_scale.xyz;
+    deformVertex(u_geometry_to_world, u_highlight, geo_pos, octDecode(a_normal), a_vertex_index);
+}
+
+@end
+
+@vs mesh_instanced_vertex
+
+layout(location=0) in vec3 a_position;
+layout(location=1) in vec3 a_normal;
+layout(location=2) in int a_vertex_index;
+
+@include_block mesh_instance
+@include_block mesh_deform
+
+void main()
+{
+    float highlight = u_highlight + a_instance_highlight;
+    deformVertex(instanceGeometryToWorld(), highlight, a_position, a_normal, a_vertex_index);
+}
+
+@end
+
+@vs mesh_compact_instanced_vertex
+
+@include_block mesh_compact
+@include_block mesh_instance
+@include_block mesh_deform
+
+void main()
+{
+    vec3 geo_pos = u_position_offset.xyz + a_position.xyz * u_position_scale.xyz;
+    float highlight = u_highlight + a_instance_highlight;
+    deformVertex(instanceGeometryToWorld(), highlight, geo_pos, octDecode(a_normal), a_vertex_index);
+}
+
+@end
+
 @fs mesh_pixel
 
 #extension GL_OES_standard_derivatives : enable
@@ -219,4 +305,7 @@ void main()
 @end
 
 @program mesh mesh_vertex mesh_pixel
+@program mesh_compact mesh_compact_vertex mesh_pixel
+@program mesh_instanced mesh_instanced_vertex mesh_pixel
+@program mesh_compact_instanced mesh_compact_instanced_vertex mesh_pixel
 
@@ -0,0 +1,330 @@
+#include "soft_raster.h"
+#include "thread_pool.h"
+#include <string.h>
+#include <math.h>
+
+// Clip polygons against `0 <= z <= w` and a guard band of `|x|, |y| <= SR_GUARD_BAND * w`
+// so that the screen space coordinates stay in a range where float edge functions work.
+#define SR_GUARD_BAND 16.0f
+#define SR_MAX_CLIP_VERTICES (3 + 6)
+
+typedef struct {
+	float x[3], y[3];  // Screen space in pixels, Y up
+	float z[3];        // Depth `z / w`
+	float inv_w[3];
+	uint32_t state_id;
+	uint32_t varying_offset; // `3 * num_varyings` in `sr_context.varyings`, premultiplied by `inv_w`
+	int32_t min_x, min_y, max_x, max_y;
+} sr_triangle;
+
+typedef alist_t(uint32_t) sr_bin;
+
+struct sr_context {
+	arena_t *arena;
+	sr_target *target;
+	uint32_t tiles_x, tiles_y;
+
+	alist_t(sr_state) states;
+	alist_t(sr_triangle) triangles;
+	alist_t(float) varyings;
+	sr_bin *bins;
+};
+
+sr_context *sr_begin(arena_t *arena, sr_target *target)
+{
+	sr_context *ctx = aalloc(arena, sr_context, 1);
+	ctx->arena = arena;
+	ctx->target = target;
+	ctx->tiles_x = (target->width + SR_TILE_SIZE - 1) / SR_TILE_SIZE;
+	ctx->tiles_y = (target->height + SR_TILE_SIZE - 1) / SR_TILE_SIZE;
+	ctx->bins = aalloc(arena, sr_bin, ctx->tiles_x * ctx->tiles_y);
+	return ctx;
+}
+
+uint32_t sr_add_state(sr_context *ctx, const sr_state *state)
+{
+	uint32_t id = (uint32_t)ctx->states.count;
+	sr_state *dst = alist_push(ctx->arena, sr_state, &ctx->states);
+	*dst = *state;
+	if (state->uniforms_size > 0) {
+		dst->uniforms = aalloc_copy_size(ctx->arena, 1, state->uniforms_size, state->uniforms);
+	}
+	return id;
+}
+
+static float sr_plane_distance(const sr_vertex *v, uint32_t plane)
+{
+	const um_vec4 p = v->position;
+	switch (plane) {
+	case 0: return p.z;
+	case 1: return p.w - p.z;
+	case 2: return SR_GUARD_BAND * p.w + p.x;
+	case 3: return SR_GUARD_BAND * p.w - p.x;
+	case 4: return SR_GUARD_BAND * p.w + p.y;
+	default: return SR_GUARD_BAND * p.w - p.y;
+	}
+}
+
+static void sr_lerp_vertex(sr_vertex *dst, const sr_vertex *a, const sr_vertex *b, float t, uint32_t num_varyings)
+{
+	dst->position = um_lerp4(a->position, b->position, t);
+	for (uint32_t i = 0; i < num_varyings; i++) {
+		dst->varyings[i] = a->varyings[i] + (b->varyings[i] - a->varyings[i]) * t;
+	}
+}
+
+// Sutherland-Hodgman clip of the polygon in `verts`, returns the number of resulting vertices
+static size_t sr_clip_polygon(sr_vertex *verts, size_t num_verts, uint32_t num_varyings)
+{
+	sr_vertex tmp[SR_MAX_CLIP_VERTICES];
+	for (uint32_t plane = 0; plane < 6 && num_verts > 0; plane++) {
+		size_t num_out = 0;
+		for (size_t i = 0; i < num_verts; i++) {
+			const sr_vertex *a = &verts[i];
+			const sr_vertex *b = &verts[(i + 1) % num_verts];
+			float da = sr_plane_distance(a, plane);
+			float db = sr_plane_distance(b, plane);
+			if (da >= 0.0f) {
+				tmp[num_out++] = *a;
+			}
+			if ((da >= 0.0f) != (db >= 0.0f) && num_out < SR_MAX_CLIP_VERTICES) {
+				sr_lerp_vertex(&tmp[num_out++], a, b, da / (da - db), num_varyings);
+			}
+		}
+		memcpy(verts, tmp, num_out * sizeof(sr_vertex));
+		num_verts = num_out;
+	}
+	return num_verts;
+}
+
+static void sr_setup_triangle(sr_context *ctx, uint32_t state_id, const sr_state *state, const sr_vertex *a, const sr_vertex *b, const sr_vertex *c)
+{
+	const sr_vertex *verts[3] = { a, b, c };
+	sr_target *target = ctx->target;
+	float half_w = 0.5f * (float)target->width, half_h = 0.5f * (float)target->height;
+
+	sr_triangle tri;
+	for (uint32_t i = 0; i < 3; i++) {
+		um_vec4 p = verts[i]->position;
+		float inv_w = 1.0f / p.w;
+		tri.x[i] = (p.x * inv_w + 1.0f) * half_w;
+		tri.y[i] = (p.y * inv_w + 1.0f) * half_h;
+		tri.z[i] = p.z * inv_w;
+		tri.inv_w[i] = inv_w;
+	}
+
+	float area = (tri.x[1] - tri.x[0]) * (tri.y[2] - tri.y[0]) - (tri.x[2] - tri.x[0]) * (tri.y[1] - tri.y[0]);
+	if (!(area != 0.0f)) return;
+	if (state->cull_back && area < 0.0f) return;
+
+	float min_x = um_min(um_min(tri.x[0], tri.x[1]), tri.x[2]);
+	float min_y = um_min(um_min(tri.y[0], tri.y[1]), tri.y[2]);
+	float max_x = um_max(um_max(tri.x[0], tri.x[1]), tri.x[2]);
+	float max_y = um_max(um_max(tri.y[0], tri.y[1]), tri.y[2]);
+	tri.min_x = (int32_t)um_max(floorf(min_x), 0.0f);
+	tri.min_y = (int32_t)um_max(floorf(min_y), 0.0f);
+	tri.max_x = (int32_t)um_min(ceilf(max_x), (float)target->width - 1.0f);
+	tri.max_y = (int32_t)um_min(ceilf(max_y), (float)target->height - 1.0f);
+	if (tri.min_x > tri.max_x || tri.min_y > tri.max_y) return;
+
+	uint32_t num_varyings = state->num_varyings;
+	tri.state_id = state_id;
+	tri.varying_offset = (uint32_t)ctx->varyings.count;
+	float *dst = alist_push_n(ctx->arena, float, &ctx->varyings, num_varyings * 3);
+	for (uint32_t i = 0; i < 3; i++) {
+		for (uint32_t vi = 0; vi < num_varyings; vi++) {
+			dst[i * num_varyings + vi] = verts[i]->varyings[vi] * tri.inv_w[i];
+		}
+	}
+
+	uint32_t tri_ix = (uint32_t)ctx->triangles.count;
+	*alist_push(ctx->arena, sr_triangle, &ctx->triangles) = tri;
+
+	uint32_t tx0 = (uint32_t)tri.min_x / SR_TILE_SIZE, tx1 = (uint32_t)tri.max_x / SR_TILE_SIZE;
+	uint32_t ty0 = (uint32_t)tri.min_y / SR_TILE_SIZE, ty1 = (uint32_t)tri.max_y / SR_TILE_SIZE;
+	for (uint32_t ty = ty0; ty <= ty1; ty++) {
+		for (uint32_t tx = tx0; tx <= tx1; tx++) {
+			sr_bin *bin = &ctx->bins[ty * ctx->tiles_x + tx];
+			*alist_push(ctx->arena, uint32_t, bin) = tri_ix;
+		}
+	}
+}
+
+void sr_draw(sr_context *ctx, uint32_t state_id, const sr_vertex *vertices, const uint32_t *indices, size_t num_indices)
+{
+	const sr_state *state = &ctx->states.data[state_id];
+	uint32_t num_varyings = state->num_varyings;
+
+	for (size_t i = 0; i + 3 <= num_indices; i += 3) {
+		const sr_vertex *a = &vertices[indices[i + 0]];
+		const sr_vertex *b = &vertices[indices[i + 1]];
+		const sr_vertex *c = &vertices[indices[i + 2]];
+
+		// Fast path for triangles that don't need clipping
+		bool inside = true;
+		for (uint32_t plane = 0; plane < 6; plane++) {
+			if (sr_plane_distance(a, plane) < 0.0f || sr_plane_distance(b, plane) < 0.0f || sr_plane_distance(c, plane) < 0.0f) {
+				inside = false;
+				break;
+			}
+		}
+		if (inside) {
+			sr_setup_triangle(ctx, state_id, state, a, b, c);
+			continue;
+		}
+
+		sr_vertex poly[SR_MAX_CLIP_VERTICES];
+		poly[0] = *a;
+		poly[1] = *b;
+		poly[2] = *c;
+		size_t num_poly = sr_clip_polygon(poly, 3, num_varyings);
+		for (size_t pi = 2; pi < num_poly; pi++) {
+			sr_setup_triangle(ctx, state_id, state, &poly[0], &poly[pi - 1], &poly[pi]);
+		}
+	}
+}
+
+static uint8_t sr_unorm8(float v)
+{
+	v = v < 0.0f ? 0.0f : v > 1.0f ? 1.0f : v;
+	return (uint8_t)(v * 255.0f + 0.5f);
+}
+
+static void sr_raster_triangle(sr_context *ctx, const sr_triangle *tri, int32_t x0, int32_t y0, int32_t x1, int32_t y1)
+{
+	sr_target *target = ctx->target;
+	const sr_state *state = &ctx->states.data[tri->state_id];
+	uint32_t num_varyings = state->num_varyings;
+	const float *attribs = ctx->varyings.data + tri->varying_offset;
+
+	// Edge `i` is opposite to vertex `i`, normalized to be positive inside
+	float a[3], b[3], c[3];
+	bool top_left[3];
+	float area = (tri->x[1] - tri->x[0]) * (tri->y[2] - tri->y[0]) - (tri->x[2] - tri->x[0]) * (tri->y[1] - tri->y[0]);
+	float sign = area < 0.0f ? -1.0f : 1.0f;
+	for (uint32_t i = 0; i < 3; i++) {
+		uint32_t i0 = (i + 1) % 3, i1 = (i + 2) % 3;
+		float dx = tri->x[i1] - tri->x[i0], dy = tri->y[i1] - tri->y[i0];
+		a[i] = -dy * sign;
+		b[i] = dx * sign;
+		c[i] = (dy * tri->x[i0] - dx * tri->y[i0]) * sign;
+		top_left[i] = a[i] > 0.0f || (a[i] == 0.0f && b[i] < 0.0f);
+	}
+	float inv_area = 1.0f / (area * sign);
+
+	float vary[SR_MAX_VARYINGS], vary_dx[SR_MAX_VARYINGS], vary_dy[SR_MAX_VARYINGS];
+	sr_fragment frag;
+	frag.varyings = vary;
+	frag.ddx = state->derivatives ? vary_dx : NULL;
+	frag.ddy = state->derivatives ? vary_dy : NULL;
+
+	for (int32_t y = y0; y <= y1; y++) {
+		float py = (float)y + 0.5f;
+		float px = (float)x0 + 0.5f;
+		float e0 = a[0] * px + b[0] * py + c[0];
+		float e1 = a[1] * px + b[1] * py + c[1];
+		float e2 = a[2] * px + b[2] * py + c[2];
+
+		for (int32_t x = x0; x <= x1; x++, e0 += a[0], e1 += a[1], e2 += a[2]) {
+			if (e0 < 0.0f || e1 < 0.0f || e2 < 0.0f) continue;
+			if ((e0 == 0.0f && !top_left[0]) || (e1 == 0.0f && !top_left[1]) || (e2 == 0.0f && !top_left[2])) continue;
+
+			size_t offset = (size_t)y * target->width + (size_t)x;
+			float l0 = e0 * inv_area, l1 = e1 * inv_area, l2 = e2 * inv_area;
+
+			float z = l0 * tri->z[0] + l1 * tri->z[1] + l2 * tri->z[2];
+			float *p_depth = &target->depth[offset];
+			if (state->depth_func == SR_DEPTH_LESS_EQUAL && !(z <= *p_depth)) continue;
+			if (state->depth_func == SR_DEPTH_GREATER && !(z > *p_depth)) continue;
+
+			uint8_t *p_stencil = &target->stencil[offset];
+			if (state->stencil_once && *p_stencil != 0) continue;
+
+			float w = 1.0f / (l0 * tri->inv_w[0] + l1 * tri->inv_w[1] + l2 * tri->inv_w[2]);
+			for (uint32_t i = 0; i < num_varyings; i++) {
+				float v = l0 * attribs[i] + l1 * attribs[num_varyings + i] + l2 * attribs[num_varyings * 2 + i];
+				vary[i] = v * w;
+			}
+
+			// Derivatives towards the neighboring pixels like a 2x2 quad would compute
+			if (state->derivatives) {
+				float dl0x = a[0] * inv_area, dl1x = a[1] * inv_area, dl2x = a[2] * inv_area;
+				float dl0y = b[0] * inv_area, dl1y = b[1] * inv_area, dl2y = b[2] * inv_area;
+				float wx = 1.0f / ((l0 + dl0x) * tri->inv_w[0] + (l1 + dl1x) * tri->inv_w[1] + (l2 + dl2x) * tri->inv_w[2]);
+				float wy = 1.0f / ((l0 + dl0y) * tri->inv_w[0] + (l1 + dl1y) * tri->inv_w[1] + (l2 + dl2y) * tri->inv_w[2]);
+				for (uint32_t i = 0; i < num_varyings; i++) {
+					float v0 = attribs[i], v1 = attribs[num_varyings + i], v2 = attribs[num_varyings * 2 + i];
+					vary_dx[i] = ((l0 + dl0x) * v0 + (l1 + dl1x) * v1 + (l2 + dl2x) * v2) * wx - vary[i];
+					vary_dy[i] = ((l0 + dl0y) * v0 + (l1 + dl1y) * v1 + (l2 + dl2y) * v2) * wy - vary[i];
+				}
+			}
+
+			frag.x = (uint32_t)x;
+			frag.y = (uint32_t)y;
+			float color[4];
+			state->shade(color, &frag, state->uniforms);
+
+			uint8_t *dst = &target->color[offset * 4];
+			if (state->blend == SR_BLEND_NONE) {
+				for (uint32_t i = 0; i < 4; i++) dst[i] = sr_unorm8(color[i]);
+			} else {
+				float alpha = state->blend == SR_BLEND_SRC_ALPHA ? color[3] : state->blend_alpha;
+				for (uint32_t i = 0; i < 3; i++) {
+					float prev = (float)dst[i] * (1.0f / 255.0f);
+					dst[i] = sr_unorm8(color[i] * alpha + prev * (1.0f - alpha));
+				}
+			}
+
+			if (state->depth_write) *p_depth = z;
+			if (state->stencil_once) *p_stencil = 1;
+		}
+	}
+}
+
+static void sr_raster_tile(void *user, size_t index)
+{
+	sr_context *ctx = (sr_context*)user;
+	sr_bin *bin = &ctx->bins[index];
+	if (bin->count == 0) return;
+
+	int32_t tile_x0 = (int32_t)(index % ctx->tiles_x) * SR_TILE_SIZE;
+	int32_t tile_y0 = (int32_t)(index / ctx->tiles_x) * SR_TILE_SIZE;
+	int32_t tile_x1 = tile_x0 + SR_TILE_SIZE - 1;
+	int32_t tile_y1 = tile_y0 + SR_TILE_SIZE - 1;
+
+	for (size_t i = 0; i < bin->count; i++) {
+		const sr_triangle *tri = &ctx->triangles.data[bin->data[i]];
+		int32_t x0 = tri->min_x > tile_x0 ? tri->min_x : tile_x0;
+		int32_t y0 = tri->min_y > tile_y0 ? tri->min_y : tile_y0;
+		int32_t x1 = tri->max_x < tile_x1 ? tri->max_x : tile_x1;
+		int32_t y1 = tri->max_y < tile_y1 ? tri->max_y : tile_y1;
+		sr_raster_triangle(ctx, tri, x0, y0, x1, y1);
+	}
+}
+
+size_t sr_flush(sr_context *ctx)
+{
+	size_t num_triangles = ctx->triangles.count;
+	if (num_triangles == 0) return 0;
+
+	size_t num_tiles = (size_t)ctx->tiles_x * ctx->tiles_y;
+	tp_run(num_tiles, &sr_raster_tile, ctx);
+
+	for (size_t i = 0; i < num_tiles; i++) {
+		ctx->bins[i].count = 0;
+	}
+	ctx->triangles.count = 0;
+	ctx->varyings.count = 0;
+	return num_triangles;
+}
+
+void sr_clear(sr_target *target, const float color[4], float depth)
+{
+	uint8_t rgba[4] = { sr_unorm8(color[0]), sr_unorm8(color[1]), sr_unorm8(color[2]), sr_unorm8(color[3]) };
+	size_t num_pixels = (size_t)target->width * target->height;
+	for (size_t i = 0; i < num_pixels; i++) {
+		memcpy(target->color + i * 4, rgba, 4);
+		target->depth[i] = depth;
+	}
+	memset(target->stencil, 0, num_pixels);
+}
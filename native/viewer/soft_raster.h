@@ -0,0 +1,85 @@
+#pragma once
+
+#include "arena.h"
+#include "external/umath.h"
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// Tiled triangle rasterizer for rendering without a GPU. Draws are recorded
+// into bins per screen tile and rasterized when flushing, one tile per task
+// of the thread pool, so the submission order is preserved within each pixel.
+//
+// Clip space follows D3D conventions (`0 <= z <= w`) and the target is stored
+// bottom row first like `glReadPixels()` returns it.
+
+enum {
+	SR_MAX_VARYINGS = 16,
+	SR_TILE_SIZE = 64,
+};
+
+typedef struct sr_vertex {
+	um_vec4 position; // Clip space
+	float varyings[SR_MAX_VARYINGS];
+} sr_vertex;
+
+typedef struct sr_fragment {
+	uint32_t x, y;
+	const float *varyings;
+	// Screen space derivatives of `varyings`, only if `sr_state.derivatives`
+	const float *ddx, *ddy;
+} sr_fragment;
+
+// Write the RGBA color of `frag` to `color`, `uniforms` is `sr_state.uniforms`
+typedef void sr_shade_fn(float color[4], const sr_fragment *frag, const void *uniforms);
+
+typedef enum {
+	SR_DEPTH_ALWAYS,
+	SR_DEPTH_LESS_EQUAL,
+	SR_DEPTH_GREATER,
+} sr_depth_func;
+
+typedef enum {
+	SR_BLEND_NONE,
+	SR_BLEND_SRC_ALPHA,      // Blend RGB by the shaded alpha, keep destination alpha
+	SR_BLEND_CONSTANT_ALPHA, // Blend RGB by `sr_state.blend_alpha`, keep destination alpha
+} sr_blend;
+
+typedef struct sr_state {
+	sr_shade_fn *shade;
+	const void *uniforms;   // Copied by `sr_add_state()`
+	size_t uniforms_size;
+	uint32_t num_varyings;  // Used prefix of `sr_vertex.varyings`
+	bool derivatives;
+
+	sr_depth_func depth_func;
+	bool depth_write;
+	bool cull_back;         // Counter-clockwise triangles are front facing
+	bool stencil_once;      // Pass only where the stencil is zero and set it on pass
+	sr_blend blend;
+	float blend_alpha;
+} sr_state;
+
+typedef struct sr_target {
+	uint32_t width, height;
+	uint8_t *color; // RGBA8
+	float *depth;
+	uint8_t *stencil;
+} sr_target;
+
+typedef struct sr_context sr_context;
+
+// Recording state for a single frame, all memory is allocated from `arena`.
+sr_context *sr_begin(arena_t *arena, sr_target *target);
+
+// Returns an ID for `sr_draw()`
+uint32_t sr_add_state(sr_context *ctx, const sr_state *state);
+
+// Clip, set up and bin `num_indices / 3` triangles of `vertices`.
+void sr_draw(sr_context *ctx, uint32_t state_id, const sr_vertex *vertices, const uint32_t *indices, size_t num_indices);
+
+// Rasterize everything recorded so far into the target, returns the number of
+// rasterized triangles (after clipping and culling).
+size_t sr_flush(sr_context *ctx);
+
+void sr_clear(sr_target *target, const float color[4], float depth);
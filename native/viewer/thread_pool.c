@@ -0,0 +1,342 @@
+#include "thread_pool.h"
+#include <stdint.h>
+#include <stdlib.h>
+
+#if defined(VIEWER_THREADS)
+
+#if defined(_WIN32)
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+
+	typedef HANDLE tp_thread;
+	typedef SRWLOCK tp_mutex;
+	typedef CONDITION_VARIABLE tp_cond;
+
+	static void tp_mutex_init(tp_mutex *m) { InitializeSRWLock(m); }
+	static void tp_mutex_free(tp_mutex *m) { }
+	static void tp_lock(tp_mutex *m) { AcquireSRWLockExclusive(m); }
+	static void tp_unlock(tp_mutex *m) { ReleaseSRWLockExclusive(m); }
+	static void tp_cond_init(tp_cond *c) { InitializeConditionVariable(c); }
+	static void tp_cond_free(tp_cond *c) { }
+	static void tp_wait(tp_cond *c, tp_mutex *m) { SleepConditionVariableSRW(c, m, INFINITE, 0); }
+	static void tp_broadcast(tp_cond *c) { WakeAllConditionVariable(c); }
+
+	static DWORD WINAPI tp_thread_entry(LPVOID arg);
+	static bool tp_thread_start(tp_thread *t, void *arg) {
+		*t = CreateThread(NULL, 0, &tp_thread_entry, arg, 0, NULL);
+		return *t != NULL;
+	}
+	static void tp_thread_join(tp_thread *t) {
+		WaitForSingleObject(*t, INFINITE);
+		CloseHandle(*t);
+	}
+	static size_t tp_num_cores() {
+		SYSTEM_INFO info;
+		GetSystemInfo(&info);
+		return (size_t)info.dwNumberOfProcessors;
+	}
+#else
+	#include <pthread.h>
+	#include <unistd.h>
+	#if defined(__EMSCRIPTEN__)
+		#include <emscripten/threading.h>
+	#endif
+
+	typedef pthread_t tp_thread;
+	typedef pthread_mutex_t tp_mutex;
+	typedef pthread_cond_t tp_cond;
+
+	static void tp_mutex_init(tp_mutex *m) { pthread_mutex_init(m, NULL); }
+	static void tp_mutex_free(tp_mutex *m) { pthread_mutex_destroy(m); }
+	static void tp_lock(tp_mutex *m) { pthread_mutex_lock(m); }
+	static void tp_unlock(tp_mutex *m) { pthread_mutex_unlock(m); }
+	static void tp_cond_init(tp_cond *c) { pthread_cond_init(c, NULL); }
+	static void tp_cond_free(tp_cond *c) { pthread_cond_destroy(c); }
+	static void tp_wait(tp_cond *c, tp_mutex *m) { pthread_cond_wait(c, m); }
+	static void tp_broadcast(tp_cond *c) { pthread_cond_broadcast(c); }
+
+	static void *tp_thread_entry(void *arg);
+	static bool tp_thread_start(tp_thread *t, void *arg) {
+		return pthread_create(t, NULL, &tp_thread_entry, arg) == 0;
+	}
+	static void tp_thread_join(tp_thread *t) {
+		pthread_join(*t, NULL);
+	}
+	static size_t tp_num_cores() {
+	#if defined(__EMSCRIPTEN__)
+		return (size_t)emscripten_num_logical_cores();
+	#else
+		long num = sysconf(_SC_NPROCESSORS_ONLN);
+		return num > 0 ? (size_t)num : 1;
+	#endif
+	}
+#endif
+
+enum {
+	TP_MAX_THREADS = 64,
+};
+
+typedef struct {
+	bool running;
+	bool quit;
+
+	tp_thread threads[TP_MAX_THREADS];
+	size_t num_threads;
+
+	// Protected by `mutex`
+	tp_mutex mutex;
+	tp_cond work_cond;
+	tp_cond done_cond;
+	tp_task_fn *fn;
+	void *user;
+	size_t next_index;
+	size_t count;
+	size_t num_done;
+} tp_globals;
+
+static tp_globals tpg;
+
+// Run tasks of the current batch until none are left, called with `tpg.mutex` held
+static void tp_work_locked()
+{
+	while (tpg.next_index < tpg.count) {
+		tp_task_fn *fn = tpg.fn;
+		void *user = tpg.user;
+		size_t index = tpg.next_index++;
+
+		tp_unlock(&tpg.mutex);
+		fn(user, index);
+		tp_lock(&tpg.mutex);
+
+		if (++tpg.num_done == tpg.count) {
+			tp_broadcast(&tpg.done_cond);
+		}
+	}
+}
+
+static void tp_worker()
+{
+	tp_lock(&tpg.mutex);
+	while (!tpg.quit) {
+		tp_work_locked();
+		if (tpg.quit) break;
+		tp_wait(&tpg.work_cond, &tpg.mutex);
+	}
+	tp_unlock(&tpg.mutex);
+}
+
+struct tp_job {
+	tp_thread thread;
+	bool has_thread;
+	tp_job_fn *fn;
+	void *user;
+
+	// Protected by `mutex`
+	tp_mutex mutex;
+	bool done;
+	bool cancelled;
+	uint64_t progress_done;
+	uint64_t progress_total;
+};
+
+static void tp_job_run(tp_job *job)
+{
+	job->fn(job, job->user);
+	tp_lock(&job->mutex);
+	job->done = true;
+	tp_unlock(&job->mutex);
+}
+
+// Pool workers are started with a NULL argument, jobs with the `tp_job`
+#if defined(_WIN32)
+	static DWORD WINAPI tp_thread_entry(LPVOID arg) { if (arg) tp_job_run((tp_job*)arg); else tp_worker(); return 0; }
+#else
+	static void *tp_thread_entry(void *arg) { if (arg) tp_job_run((tp_job*)arg); else tp_worker(); return NULL; }
+#endif
+
+void tp_setup(size_t num_threads)
+{
+	if (tpg.running) return;
+
+	if (num_threads == 0) {
+		size_t num_cores = tp_num_cores();
+		num_threads = num_cores > 1 ? num_cores - 1 : 0;
+	}
+	if (num_threads > TP_MAX_THREADS) num_threads = TP_MAX_THREADS;
+
+	tp_mutex_init(&tpg.mutex);
+	tp_cond_init(&tpg.work_cond);
+	tp_cond_init(&tpg.done_cond);
+	tpg.quit = false;
+	tpg.running = true;
+
+	tpg.num_threads = 0;
+	for (size_t i = 0; i < num_threads; i++) {
+		if (!tp_thread_start(&tpg.threads[i], NULL)) break;
+		tpg.num_threads++;
+	}
+}
+
+void tp_shutdown()
+{
+	if (!tpg.running) return;
+
+	tp_lock(&tpg.mutex);
+	tpg.quit = true;
+	tp_broadcast(&tpg.work_cond);
+	tp_unlock(&tpg.mutex);
+
+	for (size_t i = 0; i < tpg.num_threads; i++) {
+		tp_thread_join(&tpg.threads[i]);
+	}
+
+	tp_cond_free(&tpg.done_cond);
+	tp_cond_free(&tpg.work_cond);
+	tp_mutex_free(&tpg.mutex);
+	tpg.num_threads = 0;
+	tpg.running = false;
+}
+
+size_t tp_num_threads()
+{
+	return tpg.running ? tpg.num_threads + 1 : 1;
+}
+
+void tp_run(size_t count, tp_task_fn *fn, void *user)
+{
+	if (!tpg.running || tpg.num_threads == 0 || count <= 1) {
+		for (size_t i = 0; i < count; i++) {
+			fn(user, i);
+		}
+		return;
+	}
+
+	tp_lock(&tpg.mutex);
+	tpg.fn = fn;
+	tpg.user = user;
+	tpg.next_index = 0;
+	tpg.num_done = 0;
+	tpg.count = count;
+	tp_broadcast(&tpg.work_cond);
+
+	tp_work_locked();
+	while (tpg.num_done < tpg.count) {
+		tp_wait(&tpg.done_cond, &tpg.mutex);
+	}
+
+	tpg.fn = NULL;
+	tpg.user = NULL;
+	tpg.next_index = 0;
+	tpg.count = 0;
+	tp_unlock(&tpg.mutex);
+}
+
+tp_job *tp_job_start(tp_job_fn *fn, void *user)
+{
+	tp_job *job = (tp_job*)calloc(1, sizeof(tp_job));
+	if (!job) return NULL;
+	job->fn = fn;
+	job->user = user;
+	tp_mutex_init(&job->mutex);
+
+	job->has_thread = tp_thread_start(&job->thread, job);
+	if (!job->has_thread) {
+		tp_job_run(job);
+	}
+	return job;
+}
+
+void tp_job_set_progress(tp_job *job, uint64_t done, uint64_t total)
+{
+	tp_lock(&job->mutex);
+	job->progress_done = done;
+	job->progress_total = total;
+	tp_unlock(&job->mutex);
+}
+
+void tp_job_get_progress(tp_job *job, uint64_t *done, uint64_t *total)
+{
+	tp_lock(&job->mutex);
+	*done = job->progress_done;
+	*total = job->progress_total;
+	tp_unlock(&job->mutex);
+}
+
+void tp_job_cancel(tp_job *job)
+{
+	tp_lock(&job->mutex);
+	job->cancelled = true;
+	tp_unlock(&job->mutex);
+}
+
+bool tp_job_cancelled(tp_job *job)
+{
+	tp_lock(&job->mutex);
+	bool cancelled = job->cancelled;
+	tp_unlock(&job->mutex);
+	return cancelled;
+}
+
+bool tp_job_done(tp_job *job)
+{
+	tp_lock(&job->mutex);
+	bool done = job->done;
+	tp_unlock(&job->mutex);
+	return done;
+}
+
+void tp_job_join(tp_job *job)
+{
+	if (!job) return;
+	if (job->has_thread) {
+		tp_thread_join(&job->thread);
+	}
+	tp_mutex_free(&job->mutex);
+	free(job);
+}
+
+#else
+
+void tp_setup(size_t num_threads) { }
+void tp_shutdown() { }
+size_t tp_num_threads() { return 1; }
+
+void tp_run(size_t count, tp_task_fn *fn, void *user)
+{
+	for (size_t i = 0; i < count; i++) {
+		fn(user, i);
+	}
+}
+
+struct tp_job {
+	bool cancelled;
+	uint64_t progress_done;
+	uint64_t progress_total;
+};
+
+tp_job *tp_job_start(tp_job_fn *fn, void *user)
+{
+	tp_job *job = (tp_job*)calloc(1, sizeof(tp_job));
+	if (!job) return NULL;
+	fn(job, user);
+	return job;
+}
+
+void tp_job_set_progress(tp_job *job, uint64_t done, uint64_t total)
+{
+	job->progress_done = done;
+	job->progress_total = total;
+}
+
+void tp_job_get_progress(tp_job *job, uint64_t *done, uint64_t *total)
+{
+	*done = job->progress_done;
+	*total = job->progress_total;
+}
+
+void tp_job_cancel(tp_job *job) { job->cancelled = true; }
+bool tp_job_cancelled(tp_job *job) { return job->cancelled; }
+bool tp_job_done(tp_job *job) { return true; }
+void tp_job_join(tp_job *job) { free(job); }
+
+#endif
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// Minimal fork-join pool for splitting CPU-only work over worker threads.
+// Threading is compiled in only with `VIEWER_THREADS`, otherwise (and if
+// starting the workers fails) every task runs serially on the calling thread.
+
+typedef void tp_task_fn(void *user, size_t index);
+
+// Start `num_threads` workers in addition to the calling thread, 0 to use one
+// per logical core. Does nothing if the pool is already running.
+void tp_setup(size_t num_threads);
+void tp_shutdown();
+
+// Number of threads that execute tasks, including the calling thread
+size_t tp_num_threads();
+
+// Call `fn(user, i)` for every `0 <= i < count` and wait for all of them to finish.
+// Tasks may run in any order and concurrently, so they must not touch shared
+// mutable state. Must only be called from one thread at a time.
+void tp_run(size_t count, tp_task_fn *fn, void *user);
+
+// Single long running task on its own thread, eg. loading a scene without blocking
+// the thread that handles RPC calls. Without `VIEWER_THREADS` (or if starting the
+// thread fails) the task runs to completion inside `tp_job_start()`.
+typedef struct tp_job tp_job;
+typedef void tp_job_fn(tp_job *job, void *user);
+
+// Returns NULL if out of memory
+tp_job *tp_job_start(tp_job_fn *fn, void *user);
+
+// Progress and cancellation, safe to call from any thread while the job is alive
+void tp_job_set_progress(tp_job *job, uint64_t done, uint64_t total);
+void tp_job_get_progress(tp_job *job, uint64_t *done, uint64_t *total);
+void tp_job_cancel(tp_job *job);
+bool tp_job_cancelled(tp_job *job);
+
+// Returns true once `fn` has returned, does not block
+bool tp_job_done(tp_job *job);
+
+// Wait for the job to finish and free it
+void tp_job_join(tp_job *job);
@@ -101,6 +101,12 @@
 	#define UFBX_NO_UNALIGNED_LOADS
 #endif
 
+// SSE2 is used to convert geometry cache data, it's available on every x64 target
+#if (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)) && !defined(UFBX_NO_SSE)
+	#define UFBXI_HAS_SSE 1
+	#include <emmintrin.h>
+#endif
+
 // Unaligned little-endian load functions
 // On platforms that support unaligned access natively (x86, x64, ARM64) just use normal loads,
 // with unaligned attributes, otherwise do manual byte-wise load.
@@ -12703,6 +12709,9 @@ static ufbxi_noinline void ufbxi_update_scene_settings(ufbx_scene_settings *sett
 
 // -- Geometry caches
 
+// Source of `ufbx_geometry_cache.cache_id`, zero is never handed out
+static ufbxi_atomic_counter ufbxi_geometry_cache_id_counter;
+
 typedef struct {
 	ufbxi_refcount refcount;
 	ufbx_geometry_cache cache;
@@ -13412,6 +13421,12 @@ static ufbxi_noinline int ufbxi_cache_load_imp(ufbxi_cache_context *cc, ufbx_str
 	ufbxi_check_err(&cc->error, ufbxi_cache_sort_frames(cc, cc->cache.frames.data, cc->cache.frames.count));
 	ufbxi_check_err(&cc->error, ufbxi_cache_setup_channels(cc));
 
+	cc->cache.cache_id = (uint64_t)ufbxi_atomic_counter_inc(&ufbxi_geometry_cache_id_counter) + 1;
+	for (size_t i = 0; i < cc->cache.channels.count; i++) {
+		cc->cache.channels.data[i].cache_id = cc->cache.cache_id;
+		cc->cache.channels.data[i].index = (uint32_t)i;
+	}
+
 	// Must be last allocation!
 	cc->imp = ufbxi_push(&cc->result, ufbxi_geometry_cache_imp, 1);
 	ufbxi_check_err(&cc->error, cc->imp);
@@ -14857,6 +14872,7 @@ ufbxi_nodiscard static int ufbxi_evaluate_imp(ufbxi_eval_context *ec)
 	if (ec->opts.evaluate_skinning) {
 		ufbx_geometry_cache_data_opts cache_opts = { 0 };
 		cache_opts.open_file_cb = ec->opts.open_file_cb;
+		cache_opts.frame_cache = ec->opts.frame_cache;
 		ufbxi_check_err(&ec->error, ufbxi_evaluate_skinning(&ec->scene, &ec->error, &ec->result, &ec->tmp,
 			ec->time, ec->opts.load_external_files, &cache_opts));
 	}
@@ -18911,27 +18927,324 @@ ufbx_abi size_t ufbx_get_sample_geometry_cache_vec3_num_data(const ufbx_cache_ch
 	return ufbx_get_read_geometry_cache_vec3_num_data(last);
 }
 
-ufbx_abi ufbxi_noinline size_t ufbx_read_geometry_cache_real(const ufbx_cache_frame *frame, ufbx_real *data, size_t count, const ufbx_geometry_cache_data_opts *user_opts)
+// -- Frame cache
+
+#define UFBXI_FRAME_CACHE_IMP_MAGIC 0x43524655
+
+// Stream kept open between frame reads, reading a later frame of the same file
+// only skips forward instead of reopening the file and seeking from the start.
+typedef struct {
+	ufbxi_allocator *ator;
+	char *filename;
+	size_t filename_len, filename_cap;
+	ufbx_open_file_cb open_file_cb;
+	ufbx_stream stream;
+	uint64_t offset; // < Current position in `stream`
+	bool open;
+} ufbxi_cache_file;
+
+static ufbxi_noinline void ufbxi_cache_file_close(ufbxi_cache_file *file)
 {
-	if (!frame || count == 0) return 0;
-	ufbx_assert(data);
-	if (!data) return 0;
+	if (file->open && file->stream.close_fn) {
+		file->stream.close_fn(file->stream.user);
+	}
+	file->open = false;
+}
 
-	ufbx_geometry_cache_data_opts opts;
-	if (user_opts) {
-		opts = *user_opts;
-	} else {
-		memset(&opts, 0, sizeof(opts));
+// Make `file` point to the file of `frame`, `*p_skip` is set to the number of bytes to skip to reach the data
+static ufbxi_noinline bool ufbxi_cache_file_open(ufbxi_cache_file *file, const ufbx_cache_frame *frame, const ufbx_open_file_cb *cb, uint64_t *p_skip)
+{
+	if (file->open && file->offset <= frame->data_offset && file->filename_len == frame->filename.length
+		&& !memcmp(file->filename, frame->filename.data, frame->filename.length)
+		&& file->open_file_cb.fn == cb->fn && file->open_file_cb.user == cb->user) {
+		*p_skip = frame->data_offset - file->offset;
+		return true;
 	}
 
-	if (!opts.open_file_cb.fn) {
-		opts.open_file_cb.fn = ufbx_open_file;
+	ufbxi_cache_file_close(file);
+	if (!ufbxi_grow_array(file->ator, &file->filename, &file->filename_cap, frame->filename.length + 1)) return false;
+
+	memset(&file->stream, 0, sizeof(ufbx_stream));
+	if (!cb->fn(cb->user, &file->stream, frame->filename.data, frame->filename.length)) return false;
+
+	memcpy(file->filename, frame->filename.data, frame->filename.length);
+	file->filename_len = frame->filename.length;
+	file->open_file_cb = *cb;
+	file->offset = 0;
+	file->open = true;
+	*p_skip = frame->data_offset;
+	return true;
+}
+
+static ufbxi_noinline void ufbxi_cache_close_stream(ufbx_stream *stream, ufbxi_cache_file *file)
+{
+	if (file) {
+		ufbxi_cache_file_close(file);
+	} else if (stream->close_fn) {
+		stream->close_fn(stream->user);
 	}
+}
 
-	// `ufbx_geometry_cache_data_opts` must be cleared to zero first!
-	ufbx_assert(opts._begin_zero == 0 && opts._end_zero == 0);
-	if (!(opts._begin_zero == 0 && opts._end_zero == 0)) return 0;
+// Convert `count` floats at `src` to `dst`, `src` may alias the last `count * 4` bytes
+// of `dst` as every element is loaded before the stores that could overwrite it.
+static ufbxi_noinline void ufbxi_widen_cache_f32(ufbx_real *dst, const char *src, size_t count, bool swap, bool use_weight, ufbx_real weight)
+{
+	size_t i = 0;
+
+#if defined(UFBXI_HAS_SSE) && !defined(UFBX_REAL_IS_FLOAT)
+	const __m128d weight4 = _mm_set1_pd(weight);
+	for (; i + 4 <= count; i += 4) {
+		__m128i v = _mm_loadu_si128((const __m128i*)(src + i * sizeof(float)));
+		if (swap) {
+			v = _mm_shufflehi_epi16(_mm_shufflelo_epi16(v, 0xb1), 0xb1);
+			v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+		}
+		__m128 f = _mm_castsi128_ps(v);
+		__m128d lo = _mm_cvtps_pd(f);
+		__m128d hi = _mm_cvtps_pd(_mm_movehl_ps(f, f));
+		if (use_weight) {
+			lo = _mm_mul_pd(lo, weight4);
+			hi = _mm_mul_pd(hi, weight4);
+		}
+		_mm_storeu_pd(dst + i, lo);
+		_mm_storeu_pd(dst + i + 2, hi);
+	}
+#endif
+
+	for (; i < count; i++) {
+		char v[4];
+		memcpy(v, src + i * sizeof(float), sizeof(float));
+		if (swap) {
+			char t;
+			t = v[0]; v[0] = v[3]; v[3] = t;
+			t = v[1]; v[1] = v[2]; v[2] = t;
+		}
+		float value;
+		memcpy(&value, v, sizeof(float));
+		dst[i] = use_weight ? (ufbx_real)value * weight : (ufbx_real)value;
+	}
+}
+
+static ufbxi_noinline size_t ufbxi_read_cache_frame(const ufbx_cache_frame *frame, ufbx_real *data, size_t count, const ufbx_geometry_cache_data_opts *opts, ufbxi_cache_file *file);
+
+typedef struct ufbxi_frame_cache_entry ufbxi_frame_cache_entry;
+
+typedef struct {
+	uint64_t cache_id;
+	uint32_t channel_index;
+	uint32_t frame_index;
+} ufbxi_frame_cache_key;
+
+struct ufbxi_frame_cache_entry {
+	ufbxi_frame_cache_key key;
+	ufbxi_frame_cache_entry *hash_next;
+	ufbxi_frame_cache_entry *lru_prev, *lru_next;
+	ufbx_real *data;
+	size_t count;     // < Allocated number of reals
+	size_t num_valid; // < Number of reals successfully decoded
+};
+
+struct ufbx_frame_cache {
+	uint32_t magic;
+	ufbx_error error;
+	ufbxi_allocator ator;
+
+	ufbxi_frame_cache_entry **buckets;
+	size_t num_buckets;
+
+	// Most recently used first
+	ufbxi_frame_cache_entry *lru_head, *lru_tail;
+
+	ufbxi_cache_file file;
+
+	ufbx_frame_cache_stats stats;
+};
+
+static ufbxi_forceinline size_t ufbxi_frame_cache_entry_size(size_t count)
+{
+	return sizeof(ufbxi_frame_cache_entry) + count * sizeof(ufbx_real);
+}
+
+static ufbxi_forceinline uint32_t ufbxi_frame_cache_hash(const ufbxi_frame_cache_key *key)
+{
+	return ufbxi_hash64(key->cache_id ^ ((uint64_t)key->channel_index << 32 | key->frame_index) * UINT64_C(0x9e3779b97f4a7c15));
+}
+
+static ufbxi_noinline ufbxi_frame_cache_entry **ufbxi_frame_cache_find(ufbx_frame_cache *cache, const ufbxi_frame_cache_key *key)
+{
+	if (cache->num_buckets == 0) return NULL;
+	uint32_t hash = ufbxi_frame_cache_hash(key);
+	ufbxi_frame_cache_entry **p_entry = &cache->buckets[hash & (cache->num_buckets - 1)];
+	while (*p_entry) {
+		const ufbxi_frame_cache_key *k = &(*p_entry)->key;
+		if (k->cache_id == key->cache_id && k->channel_index == key->channel_index && k->frame_index == key->frame_index) break;
+		p_entry = &(*p_entry)->hash_next;
+	}
+	return p_entry;
+}
+
+static ufbxi_noinline void ufbxi_frame_cache_unlink(ufbx_frame_cache *cache, ufbxi_frame_cache_entry *entry)
+{
+	if (entry->lru_prev) entry->lru_prev->lru_next = entry->lru_next;
+	else cache->lru_head = entry->lru_next;
+	if (entry->lru_next) entry->lru_next->lru_prev = entry->lru_prev;
+	else cache->lru_tail = entry->lru_prev;
+	entry->lru_prev = entry->lru_next = NULL;
+}
+
+static ufbxi_noinline void ufbxi_frame_cache_push_front(ufbx_frame_cache *cache, ufbxi_frame_cache_entry *entry)
+{
+	entry->lru_prev = NULL;
+	entry->lru_next = cache->lru_head;
+	if (cache->lru_head) cache->lru_head->lru_prev = entry;
+	else cache->lru_tail = entry;
+	cache->lru_head = entry;
+}
+
+static ufbxi_noinline void ufbxi_frame_cache_remove(ufbx_frame_cache *cache, ufbxi_frame_cache_entry *entry)
+{
+	ufbxi_frame_cache_entry **p_entry = ufbxi_frame_cache_find(cache, &entry->key);
+	ufbx_assert(p_entry && *p_entry == entry);
+	if (p_entry && *p_entry == entry) *p_entry = entry->hash_next;
+
+	ufbxi_frame_cache_unlink(cache, entry);
+	cache->stats.num_frames--;
+	cache->stats.memory_used -= ufbxi_frame_cache_entry_size(entry->count);
+	ufbxi_free(&cache->ator, ufbx_real, entry->data, entry->count);
+	ufbxi_free(&cache->ator, ufbxi_frame_cache_entry, entry, 1);
+}
+
+static ufbxi_noinline bool ufbxi_frame_cache_grow(ufbx_frame_cache *cache)
+{
+	if (cache->stats.num_frames < cache->num_buckets) return true;
+
+	size_t num_buckets = cache->num_buckets ? cache->num_buckets * 2 : 64;
+	ufbxi_frame_cache_entry **buckets = ufbxi_alloc(&cache->ator, ufbxi_frame_cache_entry*, num_buckets);
+	if (!buckets) return false;
+	memset(buckets, 0, num_buckets * sizeof(ufbxi_frame_cache_entry*));
+
+	for (size_t i = 0; i < cache->num_buckets; i++) {
+		ufbxi_frame_cache_entry *entry = cache->buckets[i];
+		while (entry) {
+			ufbxi_frame_cache_entry *next = entry->hash_next;
+			uint32_t hash = ufbxi_frame_cache_hash(&entry->key);
+			ufbxi_frame_cache_entry **p_bucket = &buckets[hash & (num_buckets - 1)];
+			entry->hash_next = *p_bucket;
+			*p_bucket = entry;
+			entry = next;
+		}
+	}
+
+	ufbxi_free(&cache->ator, ufbxi_frame_cache_entry*, cache->buckets, cache->num_buckets);
+	cache->buckets = buckets;
+	cache->num_buckets = num_buckets;
+	return true;
+}
+
+static ufbxi_noinline ufbxi_frame_cache_entry *ufbxi_frame_cache_insert(ufbx_frame_cache *cache, const ufbxi_frame_cache_key *key, const ufbx_cache_frame *frame, const ufbx_geometry_cache_data_opts *opts)
+{
+	size_t num_data = ufbx_get_read_geometry_cache_real_num_data(frame);
+	if (num_data == 0) return NULL;
+
+	// Frames that can never fit in the budget are read directly
+	size_t size = ufbxi_frame_cache_entry_size(num_data);
+	if (num_data > SIZE_MAX / sizeof(ufbx_real) / 2 || size > cache->stats.memory_budget) return NULL;
+
+	while (cache->lru_tail && cache->stats.memory_used + size > cache->stats.memory_budget) {
+		ufbxi_frame_cache_remove(cache, cache->lru_tail);
+		cache->stats.evictions++;
+	}
+
+	if (!ufbxi_frame_cache_grow(cache)) return NULL;
+
+	ufbxi_frame_cache_entry *entry = ufbxi_alloc(&cache->ator, ufbxi_frame_cache_entry, 1);
+	if (!entry) return NULL;
+	memset(entry, 0, sizeof(ufbxi_frame_cache_entry));
+	entry->data = ufbxi_alloc(&cache->ator, ufbx_real, num_data);
+	if (!entry->data) {
+		ufbxi_free(&cache->ator, ufbxi_frame_cache_entry, entry, 1);
+		return NULL;
+	}
+
+	// Decode the whole frame without weighting so it can be shared by all readers
+	ufbx_geometry_cache_data_opts read_opts = { 0 };
+	read_opts.open_file_cb = opts->open_file_cb;
+	if (!read_opts.open_file_cb.fn) {
+		read_opts.open_file_cb.fn = ufbx_open_file;
+	}
+	size_t count = ufbxi_read_cache_frame(frame, entry->data, num_data, &read_opts, &cache->file);
+	if (count == 0) {
+		ufbxi_free(&cache->ator, ufbx_real, entry->data, num_data);
+		ufbxi_free(&cache->ator, ufbxi_frame_cache_entry, entry, 1);
+		return NULL;
+	}
+
+	entry->key = *key;
+	entry->count = num_data;
+	entry->num_valid = ufbxi_min_sz(count, num_data);
+
+	ufbxi_frame_cache_entry **p_entry = ufbxi_frame_cache_find(cache, key);
+	ufbx_assert(p_entry && !*p_entry);
+	entry->hash_next = NULL;
+	*p_entry = entry;
+	ufbxi_frame_cache_push_front(cache, entry);
+
+	cache->stats.num_frames++;
+	cache->stats.memory_used += size;
+	return entry;
+}
+
+// Read `channel->frames.data[frame_index]` through `opts->frame_cache` if there is one
+static ufbxi_noinline size_t ufbxi_read_channel_frame(const ufbx_cache_channel *channel, size_t frame_index, ufbx_real *data, size_t count, const ufbx_geometry_cache_data_opts *opts)
+{
+	const ufbx_cache_frame *frame = &channel->frames.data[frame_index];
+	ufbx_frame_cache *cache = opts->frame_cache;
+	if (!cache) {
+		return ufbx_read_geometry_cache_real(frame, data, count, opts);
+	}
+
+	ufbx_assert(cache->magic == UFBXI_FRAME_CACHE_IMP_MAGIC);
+	if (cache->magic != UFBXI_FRAME_CACHE_IMP_MAGIC) return 0;
+
+	ufbxi_frame_cache_key key = { channel->cache_id, channel->index, (uint32_t)frame_index };
+	ufbxi_frame_cache_entry **p_entry = ufbxi_frame_cache_find(cache, &key);
+	ufbxi_frame_cache_entry *entry = p_entry ? *p_entry : NULL;
+	if (entry) {
+		cache->stats.hits++;
+		ufbxi_frame_cache_unlink(cache, entry);
+		ufbxi_frame_cache_push_front(cache, entry);
+	} else {
+		cache->stats.misses++;
+		entry = ufbxi_frame_cache_insert(cache, &key, frame, opts);
+		if (!entry) {
+			// Frames that don't fit the budget still stream through the open file
+			ufbx_geometry_cache_data_opts read_opts = *opts;
+			if (!read_opts.open_file_cb.fn) {
+				read_opts.open_file_cb.fn = ufbx_open_file;
+			}
+			return ufbxi_read_cache_frame(frame, data, count, &read_opts, &cache->file);
+		}
+	}
 
+	size_t num = ufbxi_min_sz(entry->num_valid, count);
+	const ufbx_real *src = entry->data;
+	ufbx_real weight = opts->use_weight ? opts->weight : 1.0f;
+	if (opts->additive) {
+		for (size_t i = 0; i < num; i++) {
+			data[i] += src[i] * weight;
+		}
+	} else if (opts->use_weight) {
+		for (size_t i = 0; i < num; i++) {
+			data[i] = src[i] * weight;
+		}
+	} else {
+		memcpy(data, src, num * sizeof(ufbx_real));
+	}
+	return num;
+}
+
+static ufbxi_noinline size_t ufbxi_read_cache_frame(const ufbx_cache_frame *frame, ufbx_real *data, size_t count, const ufbx_geometry_cache_data_opts *opts, ufbxi_cache_file *file)
+{
 	bool use_double = false;
 
 	size_t src_count = 0;
@@ -18965,24 +19278,32 @@ ufbx_abi ufbxi_noinline size_t ufbx_read_geometry_cache_real(const ufbx_cache_fr
 	if (src_count == 0) return 0;
 	src_count = ufbxi_min_sz(src_count, count);
 
-	ufbx_stream stream = { 0 };
-	if (!opts.open_file_cb.fn(opts.open_file_cb.user, &stream, frame->filename.data, frame->filename.length)) {
+	size_t src_elem_size = use_double ? sizeof(double) : sizeof(float);
+	uint64_t src_size = (uint64_t)src_count * src_elem_size;
+	uint64_t bytes_consumed = 0;
+
+	ufbx_stream local_stream = { 0 };
+	ufbx_stream *stream = &local_stream;
+	uint64_t offset = frame->data_offset;
+	if (file) {
+		if (!ufbxi_cache_file_open(file, frame, &opts->open_file_cb, &offset)) return 0;
+		stream = &file->stream;
+	} else if (!opts->open_file_cb.fn(opts->open_file_cb.user, stream, frame->filename.data, frame->filename.length)) {
 		return 0;
 	}
 
 	// Skip to the correct point in the file
-	uint64_t offset = frame->data_offset;
-	if (stream.skip_fn) {
+	if (stream->skip_fn) {
 		while (offset > 0) {
 			size_t to_skip = (size_t)ufbxi_min64(offset, UFBXI_MAX_SKIP_SIZE);
-			if (!stream.skip_fn(stream.user, to_skip)) break;
+			if (!stream->skip_fn(stream->user, to_skip)) break;
 			offset -= to_skip;
 		}
 	} else {
 		char buffer[4096];
 		while (offset > 0) {
 			size_t to_skip = (size_t)ufbxi_min64(offset, sizeof(buffer));
-			size_t num_read = stream.read_fn(stream.user, buffer, to_skip);
+			size_t num_read = stream->read_fn(stream->user, buffer, to_skip);
 			if (num_read != to_skip) break;
 			offset -= to_skip;
 		}
@@ -18990,20 +19311,54 @@ ufbx_abi ufbxi_noinline size_t ufbx_read_geometry_cache_real(const ufbx_cache_fr
 
 	// Failed to skip all the way
 	if (offset > 0) {
-		if (stream.close_fn) {
-			stream.close_fn(stream.user);
-		}
+		ufbxi_cache_close_stream(stream, file);
 		return 0;
 	}
 
 	ufbx_real *dst = data;
-	if (use_double) {
+	if (!opts->additive && src_elem_size <= sizeof(ufbx_real)) {
+		// Decode directly into `data`: Read the whole frame with as few calls as
+		// possible into the tail of the destination and widen it in place from
+		// front to back. Destination element `i` ends before source element `i + 1`
+		// starts so nothing is overwritten before it has been converted.
+		char *src = (char*)data + src_count * sizeof(ufbx_real) - (size_t)src_size;
+		size_t bytes_read = 0;
+		while (bytes_read < src_size) {
+			size_t num = stream->read_fn(stream->user, src + bytes_read, (size_t)src_size - bytes_read);
+			if (num == 0 || num == SIZE_MAX) break;
+			bytes_read += num;
+		}
+		bytes_consumed = bytes_read;
+		size_t num_read = bytes_read / src_elem_size;
+
+		bool swap = src_big_endian != dst_big_endian;
+		ufbx_real weight = opts->use_weight ? opts->weight : 1.0f;
+		if (use_double) {
+			for (size_t i = 0; i < num_read; i++) {
+				char t, *v = src + i * sizeof(double);
+				if (swap) {
+					t = v[0]; v[0] = v[7]; v[7] = t;
+					t = v[1]; v[1] = v[6]; v[6] = t;
+					t = v[2]; v[2] = v[5]; v[5] = t;
+					t = v[3]; v[3] = v[4]; v[4] = t;
+				}
+				double value;
+				memcpy(&value, v, sizeof(double));
+				dst[i] = opts->use_weight ? (ufbx_real)value * weight : (ufbx_real)value;
+			}
+		} else {
+			ufbxi_widen_cache_f32(dst, src, num_read, swap, opts->use_weight, weight);
+		}
+
+		dst += num_read;
+	} else if (use_double) {
 		double buffer[512];
 		while (src_count > 0) {
 			size_t to_read = ufbxi_min_sz(src_count, ufbxi_arraycount(buffer));
 			src_count -= to_read;
-			size_t bytes_read = stream.read_fn(stream.user, buffer, to_read * sizeof(double));
+			size_t bytes_read = stream->read_fn(stream->user, buffer, to_read * sizeof(double));
 			if (bytes_read == SIZE_MAX) bytes_read = 0;
+			bytes_consumed += bytes_read;
 			size_t num_read = bytes_read / sizeof(double);
 
 			if (src_big_endian != dst_big_endian) {
@@ -19016,16 +19371,16 @@ ufbx_abi ufbxi_noinline size_t ufbx_read_geometry_cache_real(const ufbx_cache_fr
 				}
 			}
 
-			ufbx_real weight = opts.weight;
-			if (opts.additive && opts.use_weight) {
+			ufbx_real weight = opts->weight;
+			if (opts->additive && opts->use_weight) {
 				for (size_t i = 0; i < num_read; i++) {
 					dst[i] += (ufbx_real)buffer[i] * weight;
 				}
-			} else if (opts.additive) {
+			} else if (opts->additive) {
 				for (size_t i = 0; i < num_read; i++) {
 					dst[i] += (ufbx_real)buffer[i];
 				}
-			} else if (opts.use_weight) {
+			} else if (opts->use_weight) {
 				for (size_t i = 0; i < num_read; i++) {
 					dst[i] = (ufbx_real)buffer[i] * weight;
 				}
@@ -19043,8 +19398,9 @@ ufbx_abi ufbxi_noinline size_t ufbx_read_geometry_cache_real(const ufbx_cache_fr
 		while (src_count > 0) {
 			size_t to_read = ufbxi_min_sz(src_count, ufbxi_arraycount(buffer));
 			src_count -= to_read;
-			size_t bytes_read = stream.read_fn(stream.user, buffer, to_read * sizeof(float));
+			size_t bytes_read = stream->read_fn(stream->user, buffer, to_read * sizeof(float));
 			if (bytes_read == SIZE_MAX) bytes_read = 0;
+			bytes_consumed += bytes_read;
 			size_t num_read = bytes_read / sizeof(float);
 
 			if (src_big_endian != dst_big_endian) {
@@ -19055,16 +19411,16 @@ ufbx_abi ufbxi_noinline size_t ufbx_read_geometry_cache_real(const ufbx_cache_fr
 				}
 			}
 
-			ufbx_real weight = opts.weight;
-			if (opts.additive && opts.use_weight) {
+			ufbx_real weight = opts->weight;
+			if (opts->additive && opts->use_weight) {
 				for (size_t i = 0; i < num_read; i++) {
 					dst[i] += (ufbx_real)buffer[i] * weight;
 				}
-			} else if (opts.additive) {
+			} else if (opts->additive) {
 				for (size_t i = 0; i < num_read; i++) {
 					dst[i] += (ufbx_real)buffer[i];
 				}
-			} else if (opts.use_weight) {
+			} else if (opts->use_weight) {
 				for (size_t i = 0; i < num_read; i++) {
 					dst[i] = (ufbx_real)buffer[i] * weight;
 				}
@@ -19079,13 +19435,39 @@ ufbx_abi ufbxi_noinline size_t ufbx_read_geometry_cache_real(const ufbx_cache_fr
 		}
 	}
 
-	if (stream.close_fn) {
-		stream.close_fn(stream.user);
+	if (file && bytes_consumed == src_size) {
+		file->offset = frame->data_offset + bytes_consumed;
+	} else {
+		ufbxi_cache_close_stream(stream, file);
 	}
 
 	return (size_t)(dst - data);
 }
 
+ufbx_abi ufbxi_noinline size_t ufbx_read_geometry_cache_real(const ufbx_cache_frame *frame, ufbx_real *data, size_t count, const ufbx_geometry_cache_data_opts *user_opts)
+{
+	if (!frame || count == 0) return 0;
+	ufbx_assert(data);
+	if (!data) return 0;
+
+	ufbx_geometry_cache_data_opts opts;
+	if (user_opts) {
+		opts = *user_opts;
+	} else {
+		memset(&opts, 0, sizeof(opts));
+	}
+
+	if (!opts.open_file_cb.fn) {
+		opts.open_file_cb.fn = ufbx_open_file;
+	}
+
+	// `ufbx_geometry_cache_data_opts` must be cleared to zero first!
+	ufbx_assert(opts._begin_zero == 0 && opts._end_zero == 0);
+	if (!(opts._begin_zero == 0 && opts._end_zero == 0)) return 0;
+
+	return ufbxi_read_cache_frame(frame, data, count, &opts, NULL);
+}
+
 ufbx_abi ufbxi_noinline size_t ufbx_sample_geometry_cache_real(const ufbx_cache_channel *channel, double time, ufbx_real *data, size_t count, const ufbx_geometry_cache_data_opts *user_opts)
 {
 	if (!channel || count == 0) return 0;
@@ -19125,17 +19507,17 @@ ufbx_abi ufbxi_noinline size_t ufbx_sample_geometry_cache_real(const ufbx_cache_
 
 		// First keyframe
 		if (begin == 0) {
-			return ufbx_read_geometry_cache_real(next, data, count, &opts);
+			return ufbxi_read_channel_frame(channel, begin, data, count, &opts);
 		}
 
 		const ufbx_cache_frame *prev = next - 1;
 
 		// Snap to exact frames if near
 		if (fabs(next->time - time) < eps) {
-			return ufbx_read_geometry_cache_real(next, data, count, &opts);
+			return ufbxi_read_channel_frame(channel, begin, data, count, &opts);
 		}
 		if (fabs(prev->time - time) < eps) {
-			return ufbx_read_geometry_cache_real(prev, data, count, &opts);
+			return ufbxi_read_channel_frame(channel, begin - 1, data, count, &opts);
 		}
 
 		double rcp_delta = 1.0 / (next->time - prev->time);
@@ -19145,16 +19527,15 @@ ufbx_abi ufbxi_noinline size_t ufbx_sample_geometry_cache_real(const ufbx_cache_
 
 		opts.use_weight = true;
 		opts.weight = (ufbx_real)(original_weight * (1.0 - t));
-		size_t num_prev = ufbx_read_geometry_cache_real(prev, data, count, &opts);
+		size_t num_prev = ufbxi_read_channel_frame(channel, begin - 1, data, count, &opts);
 
 		opts.additive = true;
 		opts.weight = (ufbx_real)(original_weight * t);
-		return ufbx_read_geometry_cache_real(next, data, num_prev, &opts);
+		return ufbxi_read_channel_frame(channel, begin, data, num_prev, &opts);
 	}
 
 	// Last frame
-	const ufbx_cache_frame *last = &frames[end - 1];
-	return ufbx_read_geometry_cache_real(last, data, count, &opts);
+	return ufbxi_read_channel_frame(channel, end - 1, data, count, &opts);
 }
 
 ufbx_abi ufbxi_noinline size_t ufbx_read_geometry_cache_vec3(const ufbx_cache_frame *frame, ufbx_vec3 *data, size_t count, const ufbx_geometry_cache_data_opts *opts)
@@ -19173,6 +19554,136 @@ ufbx_abi ufbxi_noinline size_t ufbx_sample_geometry_cache_vec3(const ufbx_cache_
 	return ufbx_sample_geometry_cache_real(channel, time, (ufbx_real*)data, count * 3, opts) / 3;
 }
 
+ufbx_abi ufbx_frame_cache *ufbx_create_frame_cache(size_t memory_budget, const ufbx_allocator_opts *allocator, ufbx_error *error)
+{
+	ufbx_error local_error;
+	if (!error) error = &local_error;
+
+	ufbxi_allocator ator = { 0 };
+	ufbxi_init_ator(error, &ator, allocator);
+
+	ufbx_frame_cache *cache = ufbxi_alloc(&ator, ufbx_frame_cache, 1);
+	if (!cache) {
+		ufbxi_fix_error_type(error, "Failed to create frame cache");
+		ufbxi_free_ator(&ator);
+		return NULL;
+	}
+	memset(cache, 0, sizeof(ufbx_frame_cache));
+
+	error->stack_size = 0;
+	error->description.data = ufbxi_empty_char;
+	error->description.length = 0;
+	error->type = UFBX_ERROR_NONE;
+
+	cache->magic = UFBXI_FRAME_CACHE_IMP_MAGIC;
+	cache->ator = ator;
+	cache->ator.error = &cache->error;
+	cache->file.ator = &cache->ator;
+	cache->stats.memory_budget = memory_budget;
+	return cache;
+}
+
+ufbx_abi void ufbx_free_frame_cache(ufbx_frame_cache *cache)
+{
+	if (!cache) return;
+	ufbx_assert(cache->magic == UFBXI_FRAME_CACHE_IMP_MAGIC);
+	if (cache->magic != UFBXI_FRAME_CACHE_IMP_MAGIC) return;
+
+	ufbx_clear_frame_cache(cache);
+	ufbxi_free(&cache->ator, ufbxi_frame_cache_entry*, cache->buckets, cache->num_buckets);
+	ufbxi_free(&cache->ator, char, cache->file.filename, cache->file.filename_cap);
+
+	ufbxi_allocator ator = cache->ator;
+	cache->magic = 0;
+	ufbxi_free(&ator, ufbx_frame_cache, cache, 1);
+	ufbxi_free_ator(&ator);
+}
+
+ufbx_abi void ufbx_clear_frame_cache(ufbx_frame_cache *cache)
+{
+	if (!cache) return;
+	ufbx_assert(cache->magic == UFBXI_FRAME_CACHE_IMP_MAGIC);
+	if (cache->magic != UFBXI_FRAME_CACHE_IMP_MAGIC) return;
+
+	while (cache->lru_tail) {
+		ufbxi_frame_cache_remove(cache, cache->lru_tail);
+	}
+	ufbxi_cache_file_close(&cache->file);
+}
+
+ufbx_abi size_t ufbx_prefetch_frame_cache(ufbx_frame_cache *cache, const ufbx_cache_channel *channel, double time, size_t num_frames, const ufbx_geometry_cache_data_opts *user_opts)
+{
+	if (!cache || !channel || channel->frames.count == 0 || num_frames == 0) return 0;
+	ufbx_assert(cache->magic == UFBXI_FRAME_CACHE_IMP_MAGIC);
+	if (cache->magic != UFBXI_FRAME_CACHE_IMP_MAGIC) return 0;
+
+	ufbx_geometry_cache_data_opts opts;
+	if (user_opts) {
+		opts = *user_opts;
+	} else {
+		memset(&opts, 0, sizeof(opts));
+	}
+
+	if (!opts.open_file_cb.fn) {
+		opts.open_file_cb.fn = ufbx_open_file;
+	}
+
+	// `ufbx_geometry_cache_data_opts` must be cleared to zero first!
+	ufbx_assert(opts._begin_zero == 0 && opts._end_zero == 0);
+	if (!(opts._begin_zero == 0 && opts._end_zero == 0)) return 0;
+
+	// Start from the last frame at or before `time` as sampling interpolates from it
+	const ufbx_cache_frame *frames = channel->frames.data;
+	size_t begin = 0;
+	size_t end = channel->frames.count;
+	while (end - begin > 1) {
+		size_t mid = (begin + end) >> 1;
+		if (frames[mid].time <= time) {
+			begin = mid;
+		} else {
+			end = mid;
+		}
+	}
+
+	// Prefetching more than fits would evict the frames needed first
+	size_t frame_size = ufbxi_frame_cache_entry_size(ufbx_get_read_geometry_cache_real_num_data(&frames[begin]));
+	num_frames = ufbxi_min_sz(num_frames, cache->stats.memory_budget / frame_size);
+	num_frames = ufbxi_min_sz(num_frames, channel->frames.count - begin);
+
+	// Decode in file order so sequential frames only skip forward in the open file
+	size_t num_decoded = 0;
+	for (size_t i = 0; i < num_frames; i++) {
+		ufbxi_frame_cache_key key = { channel->cache_id, channel->index, (uint32_t)(begin + i) };
+		ufbxi_frame_cache_entry **p_entry = ufbxi_frame_cache_find(cache, &key);
+		if (p_entry && *p_entry) continue;
+		if (ufbxi_frame_cache_insert(cache, &key, &frames[begin + i], &opts)) {
+			cache->stats.prefetched++;
+			num_decoded++;
+		}
+	}
+
+	// Leave the closest frame as the most recently used one
+	for (size_t i = num_frames; i-- > 0; ) {
+		ufbxi_frame_cache_key key = { channel->cache_id, channel->index, (uint32_t)(begin + i) };
+		ufbxi_frame_cache_entry **p_entry = ufbxi_frame_cache_find(cache, &key);
+		if (p_entry && *p_entry) {
+			ufbxi_frame_cache_unlink(cache, *p_entry);
+			ufbxi_frame_cache_push_front(cache, *p_entry);
+		}
+	}
+
+	return num_decoded;
+}
+
+ufbx_abi ufbx_frame_cache_stats ufbx_get_frame_cache_stats(const ufbx_frame_cache *cache)
+{
+	ufbx_frame_cache_stats stats = { 0 };
+	if (!cache) return stats;
+	ufbx_assert(cache->magic == UFBXI_FRAME_CACHE_IMP_MAGIC);
+	if (cache->magic != UFBXI_FRAME_CACHE_IMP_MAGIC) return stats;
+	return cache->stats;
+}
+
 ufbx_abi size_t ufbx_generate_indices(const ufbx_vertex_stream *streams, size_t num_streams, uint32_t *indices, size_t num_indices, const ufbx_allocator_opts *allocator, ufbx_error *error)
 {
 	ufbx_error local_error;
@@ -1624,6 +1624,10 @@ typedef struct ufbx_cache_channel {
 	ufbx_cache_interpretation interpretation;
 	ufbx_string interpretation_name;
 	ufbx_cache_frame_list frames;
+
+	// Identity of the channel used as the key of `ufbx_frame_cache`
+	uint64_t cache_id; // < `ufbx_geometry_cache.cache_id` of the owning cache
+	uint32_t index;    // < Index in `ufbx_geometry_cache.channels`
 } ufbx_cache_channel;
 
 UFBX_LIST_TYPE(ufbx_cache_channel_list, ufbx_cache_channel);
@@ -1633,8 +1637,29 @@ typedef struct ufbx_geometry_cache {
 	ufbx_cache_channel_list channels;
 	ufbx_cache_frame_list frames;
 	ufbx_string_list extra_info;
+
+	// Unique for every loaded geometry cache in the process, never reused
+	uint64_t cache_id;
 } ufbx_geometry_cache;
 
+// Budgeted LRU cache of decoded `ufbx_cache_frame` data, see `ufbx_create_frame_cache()`.
+// Frames are keyed by `(cache_id, channel index, frame index)` so the cache can be
+// shared between geometry caches and outlive them without returning stale data.
+// Frames are decoded through a file kept open between reads, so playing a cache
+// forwards only skips ahead in the file instead of reopening it for every frame.
+// NOTE: Reading through a frame cache is not thread safe.
+typedef struct ufbx_frame_cache ufbx_frame_cache;
+
+typedef struct ufbx_frame_cache_stats {
+	size_t hits;          // < Number of reads served from memory
+	size_t misses;        // < Number of reads that had to decode the frame from the file
+	size_t evictions;     // < Number of frames dropped to stay within the budget
+	size_t prefetched;    // < Number of frames decoded ahead of time by `ufbx_prefetch_frame_cache()`
+	size_t num_frames;    // < Number of frames currently in the cache
+	size_t memory_used;   // < Bytes of decoded frame data currently in the cache
+	size_t memory_budget; // < Maximum bytes of decoded frame data to retain
+} ufbx_frame_cache_stats;
+
 struct ufbx_cache_deformer {
 	union { ufbx_element element; struct {
 		ufbx_string name;
@@ -3055,6 +3080,9 @@ typedef struct ufbx_evaluate_opts {
 	// External file callbacks (defaults to stdio.h)
 	ufbx_open_file_cb open_file_cb;
 
+	// Optional cache for decoded geometry cache frames, see `ufbx_create_frame_cache()`
+	ufbx_nullable ufbx_frame_cache *frame_cache;
+
 	// Internal: Clear the whole structure instead of setting this to zero manually!
 	uint32_t _end_zero;
 } ufbx_evaluate_opts;
@@ -3138,6 +3166,11 @@ typedef struct ufbx_geometry_cache_data_opts {
 	bool use_weight;
 	ufbx_real weight;
 
+	// Optional cache for decoded frames, see `ufbx_create_frame_cache()`
+	// Used by `ufbx_sample_geometry_cache_TYPE()`, reading a single frame directly
+	// with `ufbx_read_geometry_cache_TYPE()` always decodes it from the file.
+	ufbx_nullable ufbx_frame_cache *frame_cache;
+
 	// Internal: Clear the whole structure instead of setting this to zero manually!
 	uint32_t _end_zero;
 } ufbx_geometry_cache_data_opts;
@@ -3521,6 +3554,22 @@ ufbx_abi size_t ufbx_sample_geometry_cache_real(const ufbx_cache_channel *channe
 ufbx_abi size_t ufbx_read_geometry_cache_vec3(const ufbx_cache_frame *frame, ufbx_vec3 *data, size_t num_data, const ufbx_geometry_cache_data_opts *opts);
 ufbx_abi size_t ufbx_sample_geometry_cache_vec3(const ufbx_cache_channel *channel, double time, ufbx_vec3 *data, size_t num_data, const ufbx_geometry_cache_data_opts *opts);
 
+// Create a cache that retains up to `memory_budget` bytes of decoded frames.
+// Pass it in `ufbx_geometry_cache_data_opts.frame_cache` or `ufbx_evaluate_opts.frame_cache`.
+ufbx_abi ufbx_frame_cache *ufbx_create_frame_cache(size_t memory_budget, const ufbx_allocator_opts *allocator, ufbx_error *error);
+ufbx_abi void ufbx_free_frame_cache(ufbx_frame_cache *cache);
+
+// Drop all cached frames. Not required when freeing geometry caches, entries of
+// freed caches are never hit again and age out of the LRU order.
+ufbx_abi void ufbx_clear_frame_cache(ufbx_frame_cache *cache);
+ufbx_abi ufbx_frame_cache_stats ufbx_get_frame_cache_stats(const ufbx_frame_cache *cache);
+
+// Decode up to `num_frames` frames of `channel` into `cache` ahead of sampling them,
+// starting from the frame at or before `time` and limited to what fits in the budget.
+// Returns the number of frames decoded, frames already in the cache are skipped.
+// To prefetch on a worker thread nothing else may use `cache` until this returns.
+ufbx_abi size_t ufbx_prefetch_frame_cache(ufbx_frame_cache *cache, const ufbx_cache_channel *channel, double time, size_t num_frames, const ufbx_geometry_cache_data_opts *opts);
+
 // Utility
 
 ufbx_abi size_t ufbx_generate_indices(const ufbx_vertex_stream *streams, size_t num_streams, uint32_t *indices, size_t num_indices, const ufbx_allocator_opts *allocator, ufbx_error *error);
@@ -0,0 +1,238 @@
+#include "vertex_cache.h"
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+#include <stdbool.h>
+
+// -- Forsyth scoring, see https://tomforsyth1000.github.io/papers/fast_vert_cache_opt.html
+
+enum {
+	VC_MAX_VALENCE = 32,
+};
+
+typedef struct {
+	float cache_score[VC_CACHE_SIZE + 3];
+	float valence_score[VC_MAX_VALENCE + 1];
+} vc_tables;
+
+// Tables are built per call instead of lazily into globals so that meshes can
+// be optimized concurrently from multiple threads.
+static void vc_init_tables(vc_tables *tables)
+{
+	for (size_t i = 0; i < VC_CACHE_SIZE + 3; i++) {
+		float score = 0.0f;
+		if (i < 3) {
+			// Vertices of the last triangle are penalized slightly to avoid
+			// emitting strips that reuse only a single edge.
+			score = 0.75f;
+		} else if (i < VC_CACHE_SIZE) {
+			float t = 1.0f - (float)(i - 3) / (float)(VC_CACHE_SIZE - 3);
+			score = powf(t, 1.5f);
+		}
+		tables->cache_score[i] = score;
+	}
+
+	tables->valence_score[0] = 0.0f;
+	for (size_t i = 1; i <= VC_MAX_VALENCE; i++) {
+		tables->valence_score[i] = 2.0f / sqrtf((float)i);
+	}
+}
+
+static float vc_vertex_score(const vc_tables *tables, int32_t cache_pos, uint32_t valence)
+{
+	// Vertices with no triangles left are never needed again
+	if (valence == 0) return -1.0f;
+	float score = cache_pos >= 0 ? tables->cache_score[cache_pos] : 0.0f;
+	score += tables->valence_score[valence < VC_MAX_VALENCE ? valence : VC_MAX_VALENCE];
+	return score;
+}
+
+void vc_optimize_triangles(uint32_t *indices, size_t num_indices, size_t num_vertices)
+{
+	size_t num_triangles = num_indices / 3;
+	if (num_triangles <= 1) return;
+
+	vc_tables tables;
+	vc_init_tables(&tables);
+
+	arena_t arena;
+	arena_init(&arena, NULL);
+
+	// Vertex to triangle adjacency
+	uint32_t *valence = aalloc(&arena, uint32_t, num_vertices);
+	uint32_t *adj_offset = aalloc(&arena, uint32_t, num_vertices + 1);
+	uint32_t *adj_triangles = aalloc_uninit(&arena, uint32_t, num_indices);
+
+	for (size_t i = 0; i < num_indices; i++) {
+		assert(indices[i] < num_vertices);
+		valence[indices[i]]++;
+	}
+
+	uint32_t offset = 0;
+	for (size_t i = 0; i < num_vertices; i++) {
+		adj_offset[i] = offset;
+		offset += valence[i];
+	}
+	adj_offset[num_vertices] = offset;
+
+	uint32_t *adj_pos = aalloc_copy(&arena, uint32_t, num_vertices, adj_offset);
+	for (size_t i = 0; i < num_indices; i++) {
+		adj_triangles[adj_pos[indices[i]]++] = (uint32_t)(i / 3);
+	}
+
+	int32_t *cache_pos = aalloc_uninit(&arena, int32_t, num_vertices);
+	float *vertex_score = aalloc_uninit(&arena, float, num_vertices);
+	for (size_t i = 0; i < num_vertices; i++) {
+		cache_pos[i] = -1;
+		vertex_score[i] = vc_vertex_score(&tables, -1, valence[i]);
+	}
+
+	float *triangle_score = aalloc_uninit(&arena, float, num_triangles);
+	bool *emitted = aalloc(&arena, bool, num_triangles);
+	for (size_t i = 0; i < num_triangles; i++) {
+		const uint32_t *tri = indices + i * 3;
+		triangle_score[i] = vertex_score[tri[0]] + vertex_score[tri[1]] + vertex_score[tri[2]];
+	}
+
+	uint32_t *result = aalloc_uninit(&arena, uint32_t, num_indices);
+
+	uint32_t cache[VC_CACHE_SIZE + 3];
+	size_t cache_count = 0;
+
+	size_t scan_pos = 0;
+	size_t best_triangle = SIZE_MAX;
+
+	for (size_t out_tri = 0; out_tri < num_triangles; out_tri++) {
+
+		// Fall back to the first remaining triangle if nothing in the cache is adjacent
+		if (best_triangle == SIZE_MAX) {
+			while (emitted[scan_pos]) scan_pos++;
+			best_triangle = scan_pos;
+		}
+
+		const uint32_t *tri = indices + best_triangle * 3;
+		memcpy(result + out_tri * 3, tri, 3 * sizeof(uint32_t));
+		emitted[best_triangle] = true;
+
+		// Remove the triangle from the adjacency lists of its vertices
+		for (size_t ci = 0; ci < 3; ci++) {
+			uint32_t v = tri[ci];
+			uint32_t *adj = adj_triangles + adj_offset[v];
+			uint32_t count = valence[v];
+			for (uint32_t i = 0; i < count; i++) {
+				if (adj[i] == best_triangle) {
+					adj[i] = adj[count - 1];
+					break;
+				}
+			}
+			valence[v] = count - 1;
+		}
+
+		// Move the triangle vertices to the front of the LRU cache
+		uint32_t new_cache[VC_CACHE_SIZE + 3];
+		size_t new_count = 0;
+		for (size_t ci = 0; ci < 3; ci++) {
+			new_cache[new_count++] = tri[ci];
+		}
+		for (size_t i = 0; i < cache_count; i++) {
+			uint32_t v = cache[i];
+			if (v != tri[0] && v != tri[1] && v != tri[2]) {
+				new_cache[new_count++] = v;
+			}
+		}
+
+		// Update scores of everything that was in the cache, including the
+		// vertices that have just been pushed out of it
+		best_triangle = SIZE_MAX;
+		float best_score = -1.0f;
+		for (size_t i = 0; i < new_count; i++) {
+			uint32_t v = new_cache[i];
+			cache_pos[v] = i < VC_CACHE_SIZE ? (int32_t)i : -1;
+			float score = vc_vertex_score(&tables, cache_pos[v], valence[v]);
+			float delta = score - vertex_score[v];
+			vertex_score[v] = score;
+
+			const uint32_t *adj = adj_triangles + adj_offset[v];
+			for (uint32_t ai = 0; ai < valence[v]; ai++) {
+				uint32_t t = adj[ai];
+				triangle_score[t] += delta;
+				if (triangle_score[t] > best_score) {
+					best_score = triangle_score[t];
+					best_triangle = t;
+				}
+			}
+		}
+
+		cache_count = new_count < VC_CACHE_SIZE ? new_count : VC_CACHE_SIZE;
+		memcpy(cache, new_cache, cache_count * sizeof(uint32_t));
+	}
+
+	memcpy(indices, result, num_indices * sizeof(uint32_t));
+	arena_free(&arena);
+}
+
+void vc_optimize_fetch(void *vertices, size_t vertex_size, uint32_t *indices, size_t num_indices, size_t num_vertices)
+{
+	if (num_vertices == 0) return;
+
+	arena_t arena;
+	arena_init(&arena, NULL);
+
+	uint32_t *remap = aalloc_uninit(&arena, uint32_t, num_vertices);
+	memset(remap, 0xff, num_vertices * sizeof(uint32_t));
+
+	char *src = (char*)vertices;
+	char *dst = aalloc_uninit(&arena, char, num_vertices * vertex_size);
+
+	uint32_t next_index = 0;
+	for (size_t i = 0; i < num_indices; i++) {
+		uint32_t v = indices[i];
+		assert(v < num_vertices);
+		if (remap[v] == UINT32_MAX) {
+			remap[v] = next_index;
+			memcpy(dst + next_index * vertex_size, src + v * vertex_size, vertex_size);
+			next_index++;
+		}
+		indices[i] = remap[v];
+	}
+
+	for (size_t v = 0; v < num_vertices; v++) {
+		if (remap[v] == UINT32_MAX) {
+			memcpy(dst + next_index * vertex_size, src + v * vertex_size, vertex_size);
+			next_index++;
+		}
+	}
+
+	memcpy(vertices, dst, num_vertices * vertex_size);
+	arena_free(&arena);
+}
+
+vc_stats vc_analyze(const uint32_t *indices, size_t num_indices, size_t num_vertices)
+{
+	vc_stats stats = { 0 };
+	if (num_indices < 3 || num_vertices == 0) return stats;
+
+	arena_t arena;
+	arena_init(&arena, NULL);
+
+	// Store the time each vertex entered the FIFO, a vertex is in the cache if
+	// fewer than `VC_CACHE_SIZE` misses have happened since.
+	size_t *enter_time = aalloc_uninit(&arena, size_t, num_vertices);
+	memset(enter_time, 0xff, num_vertices * sizeof(size_t));
+
+	size_t misses = 0;
+	for (size_t i = 0; i < num_indices; i++) {
+		uint32_t v = indices[i];
+		assert(v < num_vertices);
+		if (enter_time[v] == SIZE_MAX || misses - enter_time[v] >= VC_CACHE_SIZE) {
+			enter_time[v] = misses;
+			misses++;
+		}
+	}
+
+	stats.acmr = (float)misses / (float)(num_indices / 3);
+	stats.atvr = (float)misses / (float)num_vertices;
+
+	arena_free(&arena);
+	return stats;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "arena.h"
+#include <stdint.h>
+#include <stddef.h>
+
+enum {
+	// Size of the simulated post-transform cache used for both optimizing and analyzing
+	VC_CACHE_SIZE = 32,
+};
+
+typedef struct vc_stats {
+	float acmr; // Average cache miss ratio: transformed vertices per triangle (0.5 .. 3.0)
+	float atvr; // Average transform to vertex ratio: transformed vertices per unique vertex (1.0 ..)
+} vc_stats;
+
+// Reorder triangles in `indices` for post-transform vertex cache locality using
+// Tom Forsyth's linear-speed vertex cache optimization.
+void vc_optimize_triangles(uint32_t *indices, size_t num_indices, size_t num_vertices);
+
+// Reorder `vertices` in the order they are first referenced by `indices` and remap
+// the indices to match. Unreferenced vertices are moved to the end.
+void vc_optimize_fetch(void *vertices, size_t vertex_size, uint32_t *indices, size_t num_indices, size_t num_vertices);
+
+// Simulate a FIFO cache of `VC_CACHE_SIZE` entries over `indices`.
+vc_stats vc_analyze(const uint32_t *indices, size_t num_indices, size_t num_vertices);
@@ -1,12 +1,18 @@
 #include "viewer.h"
 #include "arena.h"
 #include "resources.h"
+#include "vertex_cache.h"
+#include "compact_vertex.h"
+#include "bvh.h"
+#include "thread_pool.h"
+#include "soft_raster.h"
 #include "external/sokol_config.h"
 #include "external/sokol_gfx.h"
 #include "shaders/copy.h"
 #include "shaders/mesh.h"
 #include "shaders/debug.h"
 #include "shaders/icon.h"
+#include <stdlib.h>
 
 #if defined(SOKOL_GLES3) || defined(SOKOL_GLES2)
 	#define HAS_GL 1
@@ -21,6 +27,9 @@
 #define MAX_ICON_VERTICES 512
 #define MAX_ICON_INDICES 1024
 
+// Minimum number of instances to draw a mesh using instancing
+#define VI_MIN_INSTANCED 2
+
 bool vi_initialized = false;
 
 // static um_vec2 fbx_to_um_vec2(ufbx_vec2 v) { return um_v2((float)v.x, (float)v.y); }
@@ -171,6 +180,13 @@ typedef struct {
 	int32_t vertex_id;
 } vi_vertex;
 
+// Quantized `vi_vertex`, decoded in `mesh_compact_vertex`
+typedef struct {
+	int16_t position[4]; // SHORT4N in part bounds, see `vi_part.position_offset/scale`
+	int16_t normal[2];   // SHORT2N octahedral encoded
+	int32_t vertex_id;
+} vi_compact_vertex;
+
 typedef struct {
 	float f_num_bones;
 	float f_bone_begin;
@@ -208,6 +224,21 @@ typedef struct {
 	sg_buffer index_buffer;
 	uint32_t num_indices;
 	uint32_t num_vertices;
+	vc_stats cache_stats;
+	vc_stats original_cache_stats;
+
+	// Geometry space bounds including blend shape offsets
+	um_vec3 bounds_min, bounds_max;
+
+	// Compact vertices only
+	um_vec3 position_offset;
+	um_vec3 position_scale;
+	float max_position_error;
+	float max_normal_error;
+
+	// Software rendering only, see `vi_render_software()`
+	const void *cpu_vertices;
+	const uint32_t *cpu_indices;
 } vi_part;
 
 typedef struct {
@@ -219,12 +250,119 @@ typedef struct {
 	um_mat geometry_to_world;
 } vi_node;
 
+// Geometry space bounds of the vertices weighted by a skin cluster, transformed
+// by the evaluated `ufbx_skin_cluster.geometry_to_world` they bound the skinned
+// vertices as those are convex combinations of the cluster transforms.
+typedef struct {
+	uint32_t cluster_id;
+	um_vec3 min, max;
+} vi_cluster_bounds;
+
+typedef struct {
+	// All vertices including blend shape offsets
+	um_vec3 min, max;
+
+	// Skinned meshes are bounded by the union of `clusters`, and the node
+	// transformed `min, max` if some vertices have no weights.
+	bool skinned;
+	bool has_unskinned_vertices;
+	vi_cluster_bounds *clusters;
+	size_t num_clusters;
+} vi_mesh_bounds;
+
+// Per-instance vertex data of meshes drawn with `mesh_instanced` pipelines
+typedef struct {
+	um_mat geometry_to_world;
+	float highlight;
+	float pad[3];
+} vi_instance;
+
+// Sorted once per scene by `vi_init_draw_items()`, `sort_key` contains the
+// instanced pipeline bit, material ID and mesh index from high to low bits.
+typedef struct {
+	uint64_t sort_key;
+	uint32_t mesh_ix;
+	uint32_t part_ix;
+	uint32_t node_ix; // `UINT32_MAX` for instanced draws
+	uint32_t order;
+} vi_draw_item;
+
+// Triangle `i` of `bvh` is `indices[i*3..i*3+3]` in face `faces[i]`
+typedef struct {
+	bvh_t bvh;
+	uint32_t *faces;
+	uint32_t *indices;
+} vi_mesh_pick;
+
 typedef struct {
 	vi_part *parts;
 	size_t num_parts;
 	sg_image deform_buffer;
+	const um_vec4 *cpu_deform_buffer; // Software rendering only
+
+	// Meshes with at least `VI_MIN_INSTANCED` instances are drawn with a single
+	// instanced draw per part from `vi_scene.instances[instance_offset..]`.
+	bool instanced;
+	size_t instance_offset;
+	size_t num_visible_instances;
+
+	vi_mesh_bounds bounds;
+
+	vi_mesh_pick pick;
 } vi_mesh;
 
+// CPU side of a `vi_part`, GPU handles in `part` are unset
+typedef struct {
+	vi_part part;
+	void *vertices;
+	size_t vertices_size;
+	uint32_t *indices;
+} vi_part_data;
+
+// Result of `vi_build_mesh()`, may be shared between scenes via `vi_mesh_cache`
+typedef struct {
+	vi_part_data *parts;
+	size_t num_parts;
+	void *deform_buffer;
+	size_t deform_buffer_size;
+	vi_mesh_bounds bounds;
+	vi_mesh_pick pick;
+	size_t memory_size;
+} vi_mesh_data;
+
+// Identifies the inputs of `vi_build_mesh()`, `hash` picks the cache bucket and
+// the rest must match too so that a hash collision does not draw the wrong mesh.
+typedef struct {
+	uint64_t hash;
+	uint64_t check;
+	size_t num_vertices;
+	size_t num_indices;
+	size_t num_faces;
+} vi_mesh_key;
+
+typedef struct vi_mesh_cache_entry vi_mesh_cache_entry;
+struct vi_mesh_cache_entry {
+	vi_mesh_key key;
+	arena_t *arena;
+	vi_mesh_data *data;
+	vi_mesh_cache_entry *hash_next;
+	vi_mesh_cache_entry *prev, *next;
+};
+
+// Built meshes keyed by a hash of their inputs, kept across `vi_free_scene()`
+// and `vi_shutdown()` so scenes can be re-created by just uploading the data.
+typedef struct {
+	bool initialized;
+	arena_t arena;
+	vi_mesh_cache_entry **buckets;
+	size_t num_buckets;
+
+	// Most recently used first
+	vi_mesh_cache_entry *lru_head, *lru_tail;
+
+	vi_mesh_cache_stats stats;
+} vi_mesh_cache;
+
 typedef struct {
 	size_t keyframe_offset;
 } vi_blend_channel;
@@ -237,22 +375,49 @@ typedef struct {
 struct vi_scene {
 	arena_t *arena;
 	ufbx_scene fbx;
+	const ufbx_scene *fbx_source; // Passed to `vi_make_scene()`, needed for evaluation
 	ufbx_scene *fbx_state;
 	void *fbx_state_defer;
 
+	// Inputs `fbx_state`, node matrices and the global buffer were last evaluated with
+	double state_time;
+	uint64_t state_overrides_hash;
+	ufbx_prop_override *state_overrides; // Copied to `arena` with their strings
+	size_t num_state_overrides;
+
 	vi_node *nodes;
 	vi_mesh *meshes;
 	vi_material *materials;
 	vi_blend_channel *blend_channels;
+	bool compact_vertices;
+	bool optimize_vertex_cache;
+
+	vi_instance *instances;
+	size_t num_instances;
+	sg_buffer instance_buffer;
+
+	vi_draw_item *draw_items;
+	size_t num_draw_items;
+	bool *draw_visible; // Per `draw_items`, updated by `vi_update()`
+	bool *node_drawn;   // Per node, scratch for `vi_update_visibility()`
+	size_t num_draw_instances; // Instances of non-instanced meshes with parts to draw
+
+	vi_render_stats render_stats;
+
+	// Large allocations and GPU resources, `fbx_state` is added by `vi_get_scene_memory()`
+	vi_scene_memory memory;
 
 	size_t global_buffer_size;
 	size_t global_cluster_offset;
 	size_t global_keyframe_offset;
 	sg_image global_buffer;
 	void *global_buffer_cpu;
+	bool global_buffer_uploaded;
 	vi_cluster_info *global_clusters;
 	vi_blend_keyframe_info *global_keyframes;
 
+	bool has_view;
+	um_vec3 camera_pos;
 	um_mat world_to_view;
 	um_mat view_to_clip;
 	um_mat world_to_clip;
@@ -274,6 +439,9 @@ typedef struct {
 	vi_pipelines_desc desc;
 
 	sg_pipeline mesh_pipe;
+	sg_pipeline mesh_compact_pipe;
+	sg_pipeline mesh_instanced_pipe;
+	sg_pipeline mesh_compact_instanced_pipe;
 
 	sg_pipeline debug_pipe;
 	sg_pipeline debug_pipe_post;
@@ -295,6 +463,9 @@ typedef struct {
 	vi_framebuffer framebuffers[MAX_FRAMEBUFFERS];
 
 	sg_shader mesh_shader;
+	sg_shader mesh_compact_shader;
+	sg_shader mesh_instanced_shader;
+	sg_shader mesh_compact_instanced_shader;
 	sg_shader debug_shader;
 	sg_shader icon_shader;
 
@@ -313,6 +484,12 @@ typedef struct {
 	sg_buffer icon_ib;
 
 	sg_image icon_atlas;
+
+	// Render on the CPU using `soft_raster.h`, for the dummy backend without a GPU
+	bool software;
+	sr_target soft_targets[MAX_FRAMEBUFFERS];
+	uint8_t *icon_atlas_cpu;
+	uint32_t icon_atlas_extent;
 } vi_globals;
 
 typedef enum {
@@ -355,6 +532,63 @@ static void vi_init_pipelines(vi_pipelines *ps)
 		.face_winding = SG_FACEWINDING_CCW,
 	});
 
+	ps->mesh_compact_pipe = make_pipeline(&vig.arena, NULL, &(sg_pipeline_desc){
+		.shader = vig.mesh_compact_shader,
+		.depth.write_enabled = true,
+		.depth.compare = SG_COMPAREFUNC_LESS_EQUAL,
+		.sample_count = samples,
+		.colors[0].pixel_format = color_format,
+		.depth.pixel_format = depth_format,
+		.index_type = SG_INDEXTYPE_UINT32,
+		.layout.attrs[0].format = SG_VERTEXFORMAT_SHORT4N,
+		.layout.attrs[1].format = SG_VERTEXFORMAT_SHORT2N,
+		.layout.attrs[2].format = SG_VERTEXFORMAT_UFBX_INT,
+		.cull_mode = SG_CULLMODE_BACK,
+		.face_winding = SG_FACEWINDING_CCW,
+	});
+
+	ps->mesh_instanced_pipe = make_pipeline(&vig.arena, NULL, &(sg_pipeline_desc){
+		.shader = vig.mesh_instanced_shader,
+		.depth.write_enabled = true,
+		.depth.compare = SG_COMPAREFUNC_LESS_EQUAL,
+		.sample_count = samples,
+		.colors[0].pixel_format = color_format,
+		.depth.pixel_format = depth_format,
+		.index_type = SG_INDEXTYPE_UINT32,
+		.layout.attrs[0].format = SG_VERTEXFORMAT_FLOAT3,
+		.layout.attrs[1].format = SG_VERTEXFORMAT_FLOAT3,
+		.layout.attrs[2].format = SG_VERTEXFORMAT_UFBX_INT,
+		.layout.attrs[3] = { .buffer_index = 1, .format = SG_VERTEXFORMAT_FLOAT4 },
+		.layout.attrs[4] = { .buffer_index = 1, .format = SG_VERTEXFORMAT_FLOAT4 },
+		.layout.attrs[5] = { .buffer_index = 1, .format = SG_VERTEXFORMAT_FLOAT4 },
+		.layout.attrs[6] = { .buffer_index = 1, .format = SG_VERTEXFORMAT_FLOAT4 },
+		.layout.attrs[7] = { .buffer_index = 1, .format = SG_VERTEXFORMAT_FLOAT },
+		.layout.buffers[1] = { .stride = sizeof(vi_instance), .step_func = SG_VERTEXSTEP_PER_INSTANCE },
+		.cull_mode = SG_CULLMODE_BACK,
+		.face_winding = SG_FACEWINDING_CCW,
+	});
+
+	ps->mesh_compact_instanced_pipe = make_pipeline(&vig.arena, NULL, &(sg_pipeline_desc){
+		.shader = vig.mesh_compact_instanced_shader,
+		.depth.write_enabled = true,
+		.depth.compare = SG_COMPAREFUNC_LESS_EQUAL,
+		.sample_count = samples,
+		.colors[0].pixel_format = color_format,
+		.depth.pixel_format = depth_format,
+		.index_type = SG_INDEXTYPE_UINT32,
+		.layout.attrs[0].format = SG_VERTEXFORMAT_SHORT4N,
+		.layout.attrs[1].format = SG_VERTEXFORMAT_SHORT2N,
+		.layout.attrs[2].format = SG_VERTEXFORMAT_UFBX_INT,
+		.layout.attrs[3] = { .buffer_index = 1, .format = SG_VERTEXFORMAT_FLOAT4 },
+		.layout.attrs[4] = { .buffer_index = 1, .format = SG_VERTEXFORMAT_FLOAT4 },
+		.layout.attrs[5] = { .buffer_index = 1, .format = SG_VERTEXFORMAT_FLOAT4 },
+		.layout.attrs[6] = { .buffer_index = 1, .format = SG_VERTEXFORMAT_FLOAT4 },
+		.layout.attrs[7] = { .buffer_index = 1, .format = SG_VERTEXFORMAT_FLOAT },
+		.layout.buffers[1] = { .stride = sizeof(vi_instance), .step_func = SG_VERTEXSTEP_PER_INSTANCE },
+		.cull_mode = SG_CULLMODE_BACK,
+		.face_winding = SG_FACEWINDING_CCW,
+	});
+
 	ps->debug_pipe = make_pipeline(&vig.arena, NULL, &(sg_pipeline_desc){
 		.shader = vig.debug_shader,
 		.depth.compare = SG_COMPAREFUNC_LESS_EQUAL,
@@ -438,8 +672,10 @@ void vi_setup()
 	if (vi_initialized) return;
 
 	arena_init(&vig.arena, NULL);
+	tp_setup(0);
 
 	vig.backend = sg_query_backend();
+	vig.software = vig.backend == SG_BACKEND_DUMMY;
 	switch (vig.backend) {
 	case SG_BACKEND_GLCORE33: vig.origin_top_left = false; break;
     case SG_BACKEND_GLES2: vig.origin_top_left = false; break;
@@ -471,6 +707,9 @@ void vi_setup()
 	});
 
 	vig.mesh_shader = make_shader(&vig.arena, NULL, mesh_shader_desc(vig.backend));
+	vig.mesh_compact_shader = make_shader(&vig.arena, NULL, mesh_compact_shader_desc(vig.backend));
+	vig.mesh_instanced_shader = make_shader(&vig.arena, NULL, mesh_instanced_shader_desc(vig.backend));
+	vig.mesh_compact_instanced_shader = make_shader(&vig.arena, NULL, mesh_compact_instanced_shader_desc(vig.backend));
 	vig.debug_shader = make_shader(&vig.arena, NULL, debug_shader_desc(vig.backend));
 	vig.icon_shader = make_shader(&vig.arena, NULL, icon_shader_desc(vig.backend));
 
@@ -528,6 +767,11 @@ void vi_setup()
 			.min_filter = SG_FILTER_LINEAR,
 		});
 
+		if (vig.software) {
+			vig.icon_atlas_cpu = aalloc_copy(&vig.arena, uint8_t, num_pixels, icon_pixels);
+			vig.icon_atlas_extent = (uint32_t)extent;
+		}
+
 		afree(NULL, icon_pixels);
 	}
 
@@ -539,6 +783,7 @@ void vi_shutdown()
 	if (vi_initialized) {
 		arena_free(&vig.arena);
 		memset(&vig, 0, sizeof(vig));
+		tp_shutdown();
 		vi_initialized = false;
 	}
 }
@@ -549,6 +794,7 @@ void vi_free_targets()
 	vig.fb_arena = NULL;
 	memset(&vig.render_buffer, 0, sizeof(vig.render_buffer));
 	memset(&vig.framebuffers, 0, sizeof(vig.framebuffers));
+	memset(&vig.soft_targets, 0, sizeof(vig.soft_targets));
 }
 
 static void vi_init_node(vi_scene *vs, vi_node *node, ufbx_node *fbx_node)
@@ -557,10 +803,422 @@ static void vi_init_node(vi_scene *vs, vi_node *node, ufbx_node *fbx_node)
 	node->node_to_world = fbx_to_um_mat(fbx_node->node_to_world);
 }
 
-static void vi_init_mesh(vi_scene *vs, vi_mesh *mesh, ufbx_mesh *fbx_mesh)
+// Quantize `src` to `dst` and record the worst round-trip error of the part so
+// precision regressions are visible in `vi_get_part_stats()`.
+static void vi_compact_vertices(vi_part *part, vi_compact_vertex *dst, const vi_vertex *src, size_t count)
+{
+	um_vec3 min_pos = um_dup3(FLT_MAX), max_pos = um_dup3(-FLT_MAX);
+	for (size_t i = 0; i < count; i++) {
+		min_pos = um_min3(min_pos, src[i].position);
+		max_pos = um_max3(max_pos, src[i].position);
+	}
+	if (count == 0) min_pos = max_pos = um_zero3;
+
+	cv_bounds bounds = cv_make_bounds(min_pos, max_pos);
+
+	float max_position_error = 0.0f;
+	float max_normal_error = 0.0f;
+	for (size_t i = 0; i < count; i++) {
+		vi_compact_vertex *v = &dst[i];
+		cv_encode_position(v->position, src[i].position, &bounds);
+		v->position[3] = 0;
+		cv_encode_normal(v->normal, src[i].normal);
+		v->vertex_id = src[i].vertex_id;
+
+		um_vec3 dp = cv_decode_position(v->position, &bounds);
+		max_position_error = um_max(max_position_error, um_length3(um_sub3(dp, src[i].position)));
+		if (!um_equal3(src[i].normal, um_zero3)) {
+			um_vec3 dn = cv_decode_normal(v->normal);
+			max_normal_error = um_max(max_normal_error, um_length3(um_sub3(dn, um_normalize3(src[i].normal))));
+		}
+	}
+
+	part->position_offset = bounds.offset;
+	part->position_scale = bounds.scale;
+	part->max_position_error = max_position_error;
+	part->max_normal_error = max_normal_error;
+}
+
+static uint64_t vi_hash_bytes(uint64_t hash, const void *data, size_t size)
+{
+	if (size == 0) return hash;
+	const char *ptr = (const char*)data;
+	uint64_t word;
+	while (size >= 8) {
+		memcpy(&word, ptr, 8);
+		hash = (hash ^ word) * UINT64_C(0x9e3779b97f4a7c15);
+		hash ^= hash >> 31;
+		ptr += 8;
+		size -= 8;
+	}
+	word = size;
+	memcpy(&word, ptr, size);
+	hash = (hash ^ word) * UINT64_C(0xbf58476d1ce4e5b9);
+	hash ^= hash >> 29;
+	return hash;
+}
+
+static uint64_t vi_hash_u64(uint64_t hash, uint64_t value)
+{
+	return vi_hash_bytes(hash, &value, sizeof(value));
+}
+
+static uint64_t vi_hash_str(uint64_t hash, const char *str)
+{
+	size_t len = str ? strlen(str) : SIZE_MAX;
+	hash = vi_hash_u64(hash, len);
+	return str ? vi_hash_bytes(hash, str, len) : hash;
+}
+
+// Independent of `vi_hash_bytes()` so that `vi_mesh_key` is not just one 64-bit hash
+static uint64_t vi_check_bytes(uint64_t check, const void *data, size_t size)
+{
+	if (size == 0) return check;
+	const char *ptr = (const char*)data;
+	uint64_t word;
+	while (size >= 8) {
+		memcpy(&word, ptr, 8);
+		check = (check ^ (word * UINT64_C(0x87c37b91114253d5))) + UINT64_C(0x52dce729);
+		check = (check << 27 | check >> 37) * UINT64_C(0x4cf5ad432745937f);
+		ptr += 8;
+		size -= 8;
+	}
+	word = size;
+	memcpy(&word, ptr, size);
+	check = (check ^ (word * UINT64_C(0x87c37b91114253d5))) + UINT64_C(0x38495ab5);
+	check ^= check >> 33;
+	return check;
+}
+
+static void vi_mesh_key_bytes(vi_mesh_key *key, const void *data, size_t size)
+{
+	key->hash = vi_hash_bytes(key->hash, data, size);
+	key->check = vi_check_bytes(key->check, data, size);
+}
+
+static void vi_mesh_key_u64(vi_mesh_key *key, uint64_t value)
+{
+	vi_mesh_key_bytes(key, &value, sizeof(value));
+}
+
+#define vi_mesh_key_list(key, list) vi_mesh_key_bytes((key), (list).data, (list).count * sizeof(*(list).data))
+
+static bool vi_mesh_key_equal(const vi_mesh_key *a, const vi_mesh_key *b)
+{
+	return a->hash == b->hash && a->check == b->check && a->num_vertices == b->num_vertices
+		&& a->num_indices == b->num_indices && a->num_faces == b->num_faces;
+}
+
+// Hash everything `vi_build_mesh()` reads, including scene dependent ids
+static vi_mesh_key vi_hash_mesh(vi_scene *vs, ufbx_mesh *fbx_mesh)
+{
+	vi_mesh_key key = { UINT64_C(0xcbf29ce484222325), UINT64_C(0x9ae16a3b2f90404f) };
+	key.num_vertices = fbx_mesh->num_vertices;
+	key.num_indices = fbx_mesh->num_indices;
+	key.num_faces = fbx_mesh->num_faces;
+	vi_mesh_key_u64(&key, vs->compact_vertices);
+	vi_mesh_key_u64(&key, vs->optimize_vertex_cache);
+	vi_mesh_key_list(&key, fbx_mesh->faces);
+	vi_mesh_key_list(&key, fbx_mesh->vertex_indices);
+	vi_mesh_key_list(&key, fbx_mesh->vertex_position.values);
+	vi_mesh_key_list(&key, fbx_mesh->vertex_position.indices);
+	vi_mesh_key_list(&key, fbx_mesh->vertex_normal.values);
+	vi_mesh_key_list(&key, fbx_mesh->vertex_normal.indices);
+
+	for (size_t i = 0; i < fbx_mesh->materials.count; i++) {
+		ufbx_mesh_material *mat = &fbx_mesh->materials.data[i];
+		vi_mesh_key_u64(&key, mat->material ? mat->material->typed_id : vs->fbx.materials.count);
+		vi_mesh_key_list(&key, mat->face_indices);
+	}
+
+	for (size_t i = 0; i < fbx_mesh->skin_deformers.count; i++) {
+		ufbx_skin_deformer *deformer = fbx_mesh->skin_deformers.data[i];
+		vi_mesh_key_list(&key, deformer->vertices);
+		vi_mesh_key_list(&key, deformer->weights);
+		for (size_t j = 0; j < deformer->clusters.count; j++) {
+			vi_mesh_key_u64(&key, deformer->clusters.data[j]->typed_id);
+		}
+	}
+
+	for (size_t i = 0; i < fbx_mesh->blend_deformers.count; i++) {
+		ufbx_blend_deformer *deformer = fbx_mesh->blend_deformers.data[i];
+		for (size_t j = 0; j < deformer->channels.count; j++) {
+			ufbx_blend_channel *channel = deformer->channels.data[j];
+			vi_mesh_key_u64(&key, vs->blend_channels[channel->typed_id].keyframe_offset);
+			vi_mesh_key_u64(&key, channel->keyframes.count);
+			for (size_t k = 0; k < channel->keyframes.count; k++) {
+				ufbx_blend_shape *shape = channel->keyframes.data[k].shape;
+				vi_mesh_key_list(&key, shape->offset_vertices);
+				vi_mesh_key_list(&key, shape->position_offsets);
+			}
+		}
+	}
+
+	return key;
+}
+
+static vi_mesh_cache vimc;
+
+static void vi_mesh_cache_init()
+{
+	if (vimc.initialized) return;
+	arena_init(&vimc.arena, NULL);
+	vimc.stats.memory_budget = VI_DEFAULT_MESH_CACHE_BUDGET;
+	vimc.initialized = true;
+}
+
+static void vi_mesh_cache_unlink(vi_mesh_cache_entry *entry)
+{
+	if (entry->prev) entry->prev->next = entry->next;
+	else vimc.lru_head = entry->next;
+	if (entry->next) entry->next->prev = entry->prev;
+	else vimc.lru_tail = entry->prev;
+	entry->prev = entry->next = NULL;
+}
+
+static void vi_mesh_cache_push_front(vi_mesh_cache_entry *entry)
+{
+	entry->prev = NULL;
+	entry->next = vimc.lru_head;
+	if (vimc.lru_head) vimc.lru_head->prev = entry;
+	else vimc.lru_tail = entry;
+	vimc.lru_head = entry;
+}
+
+static vi_mesh_cache_entry **vi_mesh_cache_bucket(uint64_t hash)
 {
-	vi_part *parts = aalloc(vs->arena, vi_part, fbx_mesh->materials.count);
-	mesh->parts = parts;
+	return &vimc.buckets[(hash ^ (hash >> 32)) & (vimc.num_buckets - 1)];
+}
+
+static bool vi_mesh_cache_grow()
+{
+	if (vimc.stats.num_entries < vimc.num_buckets) return true;
+
+	size_t old_num_buckets = vimc.num_buckets;
+	vi_mesh_cache_entry **old_buckets = vimc.buckets;
+	size_t num_buckets = old_num_buckets ? old_num_buckets * 2 : 64;
+	vi_mesh_cache_entry **buckets = aalloc(&vimc.arena, vi_mesh_cache_entry*, num_buckets);
+	if (!buckets) return false;
+
+	vimc.buckets = buckets;
+	vimc.num_buckets = num_buckets;
+	for (size_t i = 0; i < old_num_buckets; i++) {
+		vi_mesh_cache_entry *entry = old_buckets[i];
+		while (entry) {
+			vi_mesh_cache_entry *next = entry->hash_next;
+			vi_mesh_cache_entry **bucket = vi_mesh_cache_bucket(entry->key.hash);
+			entry->hash_next = *bucket;
+			*bucket = entry;
+			entry = next;
+		}
+	}
+	afree(&vimc.arena, old_buckets);
+	return true;
+}
+
+static void vi_mesh_cache_remove(vi_mesh_cache_entry *entry)
+{
+	vi_mesh_cache_entry **p_entry = vi_mesh_cache_bucket(entry->key.hash);
+	while (*p_entry != entry) {
+		p_entry = &(*p_entry)->hash_next;
+	}
+	*p_entry = entry->hash_next;
+	vi_mesh_cache_unlink(entry);
+	vimc.stats.memory_used -= entry->data->memory_size;
+	vimc.stats.num_entries--;
+	arena_free(entry->arena);
+	afree(&vimc.arena, entry);
+}
+
+static vi_mesh_data *vi_mesh_cache_find(const vi_mesh_key *key)
+{
+	vi_mesh_cache_init();
+	vi_mesh_cache_entry *entry = vimc.num_buckets > 0 ? *vi_mesh_cache_bucket(key->hash) : NULL;
+	for (; entry; entry = entry->hash_next) {
+		if (vi_mesh_key_equal(&entry->key, key)) {
+			vimc.stats.hits++;
+			vi_mesh_cache_unlink(entry);
+			vi_mesh_cache_push_front(entry);
+			return entry->data;
+		}
+	}
+	vimc.stats.misses++;
+	return NULL;
+}
+
+// Takes ownership of `arena` if successful
+static bool vi_mesh_cache_insert(const vi_mesh_key *key, vi_mesh_data *data, arena_t *arena)
+{
+	vi_mesh_cache_init();
+	if (data->memory_size > vimc.stats.memory_budget) return false;
+
+	while (vimc.lru_tail && vimc.stats.memory_used + data->memory_size > vimc.stats.memory_budget) {
+		vi_mesh_cache_remove(vimc.lru_tail);
+		vimc.stats.evictions++;
+	}
+
+	if (!vi_mesh_cache_grow()) return false;
+	vi_mesh_cache_entry *entry = aalloc(&vimc.arena, vi_mesh_cache_entry, 1);
+	if (!entry) return false;
+	entry->key = *key;
+	entry->arena = arena;
+	entry->data = data;
+
+	vi_mesh_cache_entry **bucket = vi_mesh_cache_bucket(key->hash);
+	entry->hash_next = *bucket;
+	*bucket = entry;
+	vi_mesh_cache_push_front(entry);
+
+	vimc.stats.memory_used += data->memory_size;
+	vimc.stats.num_entries++;
+	return true;
+}
+
+void vi_set_mesh_cache_budget(size_t budget)
+{
+	vi_mesh_cache_init();
+	vimc.stats.memory_budget = budget;
+	while (vimc.lru_tail && vimc.stats.memory_used > vimc.stats.memory_budget) {
+		vi_mesh_cache_remove(vimc.lru_tail);
+		vimc.stats.evictions++;
+	}
+}
+
+void vi_clear_mesh_cache()
+{
+	vi_mesh_cache_init();
+	while (vimc.lru_tail) {
+		vi_mesh_cache_remove(vimc.lru_tail);
+	}
+}
+
+vi_mesh_cache_stats vi_get_mesh_cache_stats()
+{
+	vi_mesh_cache_init();
+	return vimc.stats;
+}
+
+// Returns the vertex of the sparse offset `index` in `shape` or `SIZE_MAX` if
+// it should be skipped, matching `ufbx_get_blend_shape_vertex_offset()` which
+// returns the first one of duplicated vertices.
+static size_t vi_blend_offset_vertex(const ufbx_blend_shape *shape, size_t index, size_t num_vertices)
+{
+	int32_t vertex = shape->offset_vertices.data[index];
+	if (vertex < 0 || (size_t)vertex >= num_vertices) return SIZE_MAX;
+	if (index > 0 && shape->offset_vertices.data[index - 1] == vertex) return SIZE_MAX;
+	ufbx_vec3 offset = shape->position_offsets.data[index];
+	if (offset.x == 0.0f && offset.y == 0.0f && offset.z == 0.0f) return SIZE_MAX;
+	return (size_t)vertex;
+}
+
+// `vertex_min/max` are filled with the per-vertex bounds including blend shape offsets
+static void vi_init_mesh_bounds(vi_mesh_bounds *bounds, arena_t *arena, ufbx_mesh *fbx_mesh, const vi_deform_vertex *d_verts,
+	const um_vec3 *blend_min, const um_vec3 *blend_max, um_vec3 *vertex_min, um_vec3 *vertex_max)
+{
+	bounds->min = um_dup3(FLT_MAX);
+	bounds->max = um_dup3(-FLT_MAX);
+	for (size_t vi = 0; vi < fbx_mesh->num_vertices; vi++) {
+		um_vec3 pos = fbx_to_um_vec3(fbx_mesh->vertices.data[vi]);
+		vertex_min[vi] = um_add3(pos, blend_min[vi]);
+		vertex_max[vi] = um_add3(pos, blend_max[vi]);
+		bounds->min = um_min3(bounds->min, vertex_min[vi]);
+		bounds->max = um_max3(bounds->max, vertex_max[vi]);
+	}
+
+	if (fbx_mesh->skin_deformers.count == 0) return;
+	bounds->skinned = true;
+
+	// `vi_build_mesh()` zeroes `f_num_bones` for vertices without any weight
+	for (size_t vi = 0; vi < fbx_mesh->num_vertices; vi++) {
+		if (d_verts[vi].f_num_bones == 0.0f) {
+			bounds->has_unskinned_vertices = true;
+			break;
+		}
+	}
+
+	alist_t(vi_cluster_bounds) clusters = { 0 };
+	for (size_t di = 0; di < fbx_mesh->skin_deformers.count; di++) {
+		ufbx_skin_deformer *deformer = fbx_mesh->skin_deformers.data[di];
+		vi_cluster_bounds *cb = alist_push_n(arena, vi_cluster_bounds, &clusters, deformer->clusters.count);
+		for (size_t ci = 0; ci < deformer->clusters.count; ci++) {
+			cb[ci].cluster_id = deformer->clusters.data[ci]->typed_id;
+			cb[ci].min = um_dup3(FLT_MAX);
+			cb[ci].max = um_dup3(-FLT_MAX);
+		}
+		for (size_t vi = 0; vi < fbx_mesh->num_vertices && vi < deformer->vertices.count; vi++) {
+			ufbx_skin_vertex vert = deformer->vertices.data[vi];
+			for (size_t i = 0; i < vert.num_weights; i++) {
+				ufbx_skin_weight weight = deformer->weights.data[vert.weight_begin + i];
+				if (weight.weight <= 0.0f) continue;
+				vi_cluster_bounds *b = &cb[weight.cluster_index];
+				b->min = um_min3(b->min, vertex_min[vi]);
+				b->max = um_max3(b->max, vertex_max[vi]);
+			}
+		}
+	}
+
+	// Drop clusters without any weighted vertices
+	size_t num_clusters = 0;
+	for (size_t i = 0; i < clusters.count; i++) {
+		if (clusters.data[i].min.x <= clusters.data[i].max.x) {
+			clusters.data[num_clusters++] = clusters.data[i];
+		}
+	}
+	bounds->clusters = clusters.data;
+	bounds->num_clusters = num_clusters;
+}
+
+// Picking BVH of the undeformed geometry, built with the rest of the mesh data
+// so `vi_pick()` never has to build anything on the calling thread.
+static void vi_build_mesh_pick(vi_mesh_pick *pick, arena_t *arena, ufbx_mesh *fbx_mesh)
+{
+	memset(pick, 0, sizeof(vi_mesh_pick));
+
+	size_t num_triangles = fbx_mesh->num_triangles;
+	if (num_triangles == 0) return;
+
+	arena_t tmp;
+	arena_init(&tmp, NULL);
+
+	um_vec3 *positions = aalloc_uninit(&tmp, um_vec3, num_triangles * 3);
+	pick->faces = aalloc_uninit(arena, uint32_t, num_triangles);
+	pick->indices = aalloc_uninit(arena, uint32_t, num_triangles * 3);
+
+	size_t num_tri_ix = fbx_mesh->max_face_triangles * 3;
+	uint32_t *tri_ix = aalloc_uninit(&tmp, uint32_t, num_tri_ix);
+
+	size_t tri_count = 0;
+	for (size_t fi = 0; fi < fbx_mesh->num_faces; fi++) {
+		ufbx_face face = fbx_mesh->faces.data[fi];
+		size_t num_tris = ufbx_triangulate_face(tri_ix, num_tri_ix, fbx_mesh, face);
+		for (size_t ti = 0; ti < num_tris && tri_count < num_triangles; ti++) {
+			for (size_t ci = 0; ci < 3; ci++) {
+				uint32_t index = tri_ix[ti * 3 + ci];
+				positions[tri_count * 3 + ci] = fbx_to_um_vec3(ufbx_get_vertex_vec3(&fbx_mesh->vertex_position, index));
+				pick->indices[tri_count * 3 + ci] = index;
+			}
+			pick->faces[tri_count] = (uint32_t)fi;
+			tri_count++;
+		}
+	}
+
+	bvh_build(&pick->bvh, arena, positions, tri_count);
+
+	arena_free(&tmp);
+}
+
+static size_t vi_mesh_pick_memory_size(const vi_mesh_pick *pick)
+{
+	if (!pick->bvh.nodes) return 0;
+	return bvh_memory_size(&pick->bvh) + pick->bvh.num_triangles * 4 * sizeof(uint32_t);
+}
+
+// Build the GPU-ready data of `fbx_mesh` into `arena` without touching any GPU resources
+static vi_mesh_data *vi_build_mesh(vi_scene *vs, arena_t *arena, ufbx_mesh *fbx_mesh)
+{
+	vi_mesh_data *data = aalloc(arena, vi_mesh_data, 1);
+	vi_part_data *parts = aalloc(arena, vi_part_data, fbx_mesh->materials.count);
+	data->parts = parts;
 
 	arena_t tmp;
 	arena_init(&tmp, NULL);
@@ -569,7 +1227,6 @@ static void vi_init_mesh(vi_scene *vs, vi_mesh *mesh, ufbx_mesh *fbx_mesh)
 
 	vi_deform_vertex *d_verts = aalloc(&tmp, vi_deform_vertex, fbx_mesh->num_vertices);
 	alist_t(vi_deform_bone) d_bones = { 0 };
-	alist_t(vi_deform_blend) d_blends = { 0 };
 
 	for (size_t di = 0; di < fbx_mesh->skin_deformers.count; di++) {
 		ufbx_skin_deformer *deformer = fbx_mesh->skin_deformers.data[di];
@@ -600,21 +1257,51 @@ static void vi_init_mesh(vi_scene *vs, vi_mesh *mesh, ufbx_mesh *fbx_mesh)
 		}
 	}
 
+	// Blend shapes store sparse offsets, so count the used ones per vertex first and
+	// then scatter them to per-vertex ranges in deformer/channel/keyframe order.
+	size_t num_d_blends = 0;
+	size_t *d_blend_begin = aalloc(&tmp, size_t, fbx_mesh->num_vertices + 1);
+	for (size_t di = 0; di < fbx_mesh->blend_deformers.count; di++) {
+		ufbx_blend_deformer *deformer = fbx_mesh->blend_deformers.data[di];
+		for (size_t ci = 0; ci < deformer->channels.count; ci++) {
+			ufbx_blend_channel *channel = deformer->channels.data[ci];
+			for (size_t ki = 0; ki < channel->keyframes.count; ki++) {
+				ufbx_blend_shape *shape = channel->keyframes.data[ki].shape;
+				for (size_t oi = 0; oi < shape->num_offsets; oi++) {
+					size_t vi = vi_blend_offset_vertex(shape, oi, fbx_mesh->num_vertices);
+					if (vi == SIZE_MAX) continue;
+					d_blend_begin[vi + 1]++;
+					d_verts[vi].f_num_blends += 1.0f;
+				}
+			}
+		}
+	}
 	for (size_t vi = 0; vi < fbx_mesh->num_vertices; vi++) {
-		for (size_t di = 0; di < fbx_mesh->blend_deformers.count; di++) {
-			ufbx_blend_deformer *deformer = fbx_mesh->blend_deformers.data[di];
-			for (size_t ci = 0; ci < deformer->channels.count; ci++) {
-				ufbx_blend_channel *channel = deformer->channels.data[ci];	
-				for (size_t ki = 0; ki < channel->keyframes.count; ki++) {
-					ufbx_blend_shape *shape = channel->keyframes.data[ki].shape;
-					float f_keyframe_index = (float)(vs->blend_channels[channel->typed_id].keyframe_offset + ki);
-					ufbx_vec3 offset = ufbx_get_blend_shape_vertex_offset(shape, vi);
-					if (offset.x == 0.0f && offset.y == 0.0f && offset.z == 0.0f) continue;
-
-					vi_deform_blend *d_blend = alist_push(&tmp, vi_deform_blend, &d_blends);
+		d_blend_begin[vi + 1] += d_blend_begin[vi];
+	}
+	num_d_blends = d_blend_begin[fbx_mesh->num_vertices];
+
+	vi_deform_blend *d_blends = aalloc_uninit(&tmp, vi_deform_blend, num_d_blends);
+	size_t *d_blend_next = d_blend_begin;
+
+	// Extremes of the blend offsets per vertex, assumes weights between 0 and 1
+	um_vec3 *blend_min = aalloc(&tmp, um_vec3, fbx_mesh->num_vertices);
+	um_vec3 *blend_max = aalloc(&tmp, um_vec3, fbx_mesh->num_vertices);
+	for (size_t di = 0; di < fbx_mesh->blend_deformers.count; di++) {
+		ufbx_blend_deformer *deformer = fbx_mesh->blend_deformers.data[di];
+		for (size_t ci = 0; ci < deformer->channels.count; ci++) {
+			ufbx_blend_channel *channel = deformer->channels.data[ci];
+			for (size_t ki = 0; ki < channel->keyframes.count; ki++) {
+				ufbx_blend_shape *shape = channel->keyframes.data[ki].shape;
+				float f_keyframe_index = (float)(vs->blend_channels[channel->typed_id].keyframe_offset + ki);
+				for (size_t oi = 0; oi < shape->num_offsets; oi++) {
+					size_t vi = vi_blend_offset_vertex(shape, oi, fbx_mesh->num_vertices);
+					if (vi == SIZE_MAX) continue;
+					vi_deform_blend *d_blend = &d_blends[d_blend_next[vi]++];
 					d_blend->f_keyframe_index = f_keyframe_index;
-					d_blend->offset = fbx_to_um_vec3(offset);
-					d_verts[vi].f_num_blends += 1.0f;
+					d_blend->offset = fbx_to_um_vec3(shape->position_offsets.data[oi]);
+					blend_min[vi] = um_add3(blend_min[vi], um_min3(d_blend->offset, um_zero3));
+					blend_max[vi] = um_add3(blend_max[vi], um_max3(d_blend->offset, um_zero3));
 				}
 			}
 		}
@@ -626,10 +1313,10 @@ static void vi_init_mesh(vi_scene *vs, vi_mesh *mesh, ufbx_mesh *fbx_mesh)
 	const size_t d_bone_offset = deform_buf_size;
 	deform_buf_size += d_bones.count * sizeof(vi_deform_bone);
 	const size_t d_blend_offset = deform_buf_size;
-	deform_buf_size += d_blends.count * sizeof(vi_deform_blend);
+	deform_buf_size += num_d_blends * sizeof(vi_deform_blend);
 	assert(deform_buf_size % 16 == 0);
 	deform_buf_size = get_buffer_size(deform_buf_size);
-	char *deform_buf = aalloc(&tmp, char, deform_buf_size);
+	char *deform_buf = aalloc(arena, char, deform_buf_size);
 
 	size_t bone_ix = 0;
 	size_t d_bone_pos = d_bone_offset;
@@ -658,18 +1345,27 @@ static void vi_init_mesh(vi_scene *vs, vi_mesh *mesh, ufbx_mesh *fbx_mesh)
 		d_blend_pos += (size_t)d_vert->f_num_blends * sizeof(vi_deform_blend);
 	}
 
+	um_vec3 *vertex_min = aalloc_uninit(&tmp, um_vec3, fbx_mesh->num_vertices);
+	um_vec3 *vertex_max = aalloc_uninit(&tmp, um_vec3, fbx_mesh->num_vertices);
+	vi_init_mesh_bounds(&data->bounds, arena, fbx_mesh, d_verts, blend_min, blend_max, vertex_min, vertex_max);
+
 	memcpy(deform_buf + d_vertex_offset, d_verts, fbx_mesh->num_vertices * sizeof(vi_deform_vertex));
-	memcpy(deform_buf + d_bone_offset, d_bones.data, d_bones.count * sizeof(vi_deform_bone));
-	memcpy(deform_buf + d_blend_offset, d_blends.data, d_blends.count * sizeof(vi_deform_blend));
+	if (d_bones.count > 0) {
+		memcpy(deform_buf + d_bone_offset, d_bones.data, d_bones.count * sizeof(vi_deform_bone));
+	}
+	memcpy(deform_buf + d_blend_offset, d_blends, num_d_blends * sizeof(vi_deform_blend));
 
-	mesh->deform_buffer = make_static_buffer(vs->arena, NULL, deform_buf, deform_buf_size);
+	data->deform_buffer = deform_buf;
+	data->deform_buffer_size = deform_buf_size;
+	data->memory_size = deform_buf_size + data->bounds.num_clusters * sizeof(vi_cluster_bounds);
 
 	size_t num_parts = 0;
 	for (size_t pi = 0; pi < fbx_mesh->materials.count; pi++) {
 		ufbx_mesh_material *fbx_mesh_mat = &fbx_mesh->materials.data[pi];
 		if (fbx_mesh_mat->num_triangles == 0) continue;
 
-		vi_part *part = &parts[num_parts++];
+		vi_part_data *part_data = &parts[num_parts++];
+		vi_part *part = &part_data->part;
 
 		if (fbx_mesh_mat->material) {
 			part->material_id = fbx_mesh_mat->material->typed_id;
@@ -734,66 +1430,253 @@ static void vi_init_mesh(vi_scene *vs, vi_mesh *mesh, ufbx_mesh *fbx_mesh)
 		ufbx_vertex_stream streams[] = { vertices, sizeof(vi_vertex) };
 		size_t num_vertices = ufbx_generate_indices(streams, 1, indices, num_indices, NULL, NULL);
 
-		part->vertex_buffer = make_buffer(vs->arena, NULL, &(sg_buffer_desc){
-			.type = SG_BUFFERTYPE_VERTEXBUFFER,
-			.data = { vertices, num_vertices * sizeof(vi_vertex) },
-		});
+		part->original_cache_stats = vc_analyze(indices, num_indices, num_vertices);
+		part->cache_stats = part->original_cache_stats;
+		if (vs->optimize_vertex_cache) {
+			vc_optimize_triangles(indices, num_indices, num_vertices);
+			vc_optimize_fetch(vertices, sizeof(vi_vertex), indices, num_indices, num_vertices);
+			part->cache_stats = vc_analyze(indices, num_indices, num_vertices);
+		}
 
-		part->index_buffer = make_buffer(vs->arena, NULL, &(sg_buffer_desc){
-			.type = SG_BUFFERTYPE_INDEXBUFFER,
-			.data = { indices, num_indices * sizeof(uint32_t) },
-		});
+		if (vs->compact_vertices) {
+			vi_compact_vertex *compact = aalloc_uninit(arena, vi_compact_vertex, num_vertices);
+			vi_compact_vertices(part, compact, vertices, num_vertices);
+			part_data->vertices = compact;
+			part_data->vertices_size = num_vertices * sizeof(vi_compact_vertex);
+		} else {
+			part_data->vertices = aalloc_copy(arena, vi_vertex, num_vertices, vertices);
+			part_data->vertices_size = num_vertices * sizeof(vi_vertex);
+		}
+		part_data->indices = aalloc_copy(arena, uint32_t, num_indices, indices);
+		data->memory_size += part_data->vertices_size + num_indices * sizeof(uint32_t);
 
 		part->num_indices = (uint32_t)num_indices;
 		part->num_vertices = (uint32_t)num_vertices;
 
+		part->bounds_min = um_dup3(FLT_MAX);
+		part->bounds_max = um_dup3(-FLT_MAX);
+		for (size_t i = 0; i < num_vertices; i++) {
+			uint32_t vertex = (uint32_t)vertices[i].vertex_id >> 2;
+			part->bounds_min = um_min3(part->bounds_min, vertex_min[vertex]);
+			part->bounds_max = um_max3(part->bounds_max, vertex_max[vertex]);
+		}
+
 		arena_free(&tmp_inner);
 	}
 
 	arena_free(&tmp);
-	mesh->num_parts = num_parts;
-}
+	data->num_parts = num_parts;
 
-void vi_init_globals(vi_scene *vs)
-{
-	size_t num_blend_keyframes = 0;
-	for (size_t i = 0; i < vs->fbx.blend_channels.count; i++) {
-		ufbx_blend_channel *fbx_channel = vs->fbx.blend_channels.data[i];
-		vs->blend_channels[i].keyframe_offset = num_blend_keyframes;
-		num_blend_keyframes += fbx_channel->keyframes.count;
-	}
+	vi_build_mesh_pick(&data->pick, arena, fbx_mesh);
+	data->memory_size += vi_mesh_pick_memory_size(&data->pick);
 
-	size_t global_buffer_size = 0;
-	vs->global_cluster_offset = global_buffer_size;
-	global_buffer_size += vs->fbx.skin_clusters.count * sizeof(vi_cluster_info);
-	vs->global_keyframe_offset = global_buffer_size;
-	global_buffer_size += num_blend_keyframes * sizeof(vi_blend_keyframe_info);
-	global_buffer_size = get_buffer_size(global_buffer_size);
-	vs->global_buffer_size = global_buffer_size;
-	vs->global_buffer_cpu = aalloc(vs->arena, char, vs->global_buffer_size);
-	vs->global_clusters = (vi_cluster_info*)((char*)vs->global_buffer_cpu + vs->global_cluster_offset);
-	vs->global_keyframes = (vi_blend_keyframe_info*)((char*)vs->global_buffer_cpu + vs->global_keyframe_offset);
-	vs->global_buffer = make_dynamic_buffer(vs->arena, NULL, global_buffer_size);
+	return data;
 }
 
-static void vi_update_globals(vi_scene *vs, const ufbx_scene *fbx_scene)
+static void vi_upload_mesh(vi_scene *vs, vi_mesh *mesh, const vi_mesh_data *data)
 {
-	for (size_t chan_ix = 0; chan_ix < vs->fbx.blend_channels.count; chan_ix++) {
-		ufbx_blend_channel *channel = fbx_scene->blend_channels.data[chan_ix];
-		vi_blend_keyframe_info *infos = vs->global_keyframes + vs->blend_channels[chan_ix].keyframe_offset;
-		for (size_t i = 0; i < channel->keyframes.count; i++) {
-			ufbx_blend_keyframe key = channel->keyframes.data[i];
-			infos[i].weight = (float)key.effective_weight;
-			infos[i].f_channel_id = (float)channel->typed_id;
-			infos[i].f_shape_id = (float)key.shape->typed_id;
-			infos[i].pad = 0.0f;
-		}
+	mesh->deform_buffer = make_static_buffer(vs->arena, NULL, data->deform_buffer, data->deform_buffer_size);
+	if (vig.software) {
+		mesh->cpu_deform_buffer = (const um_vec4*)aalloc_copy(vs->arena, char, data->deform_buffer_size, data->deform_buffer);
 	}
 
-	for (size_t cluster_ix = 0; cluster_ix < vs->fbx.skin_clusters.count; cluster_ix++) {
-		ufbx_skin_cluster *cluster = fbx_scene->skin_clusters.data[cluster_ix];
-		vi_cluster_info *info = &vs->global_clusters[cluster_ix];
-		info->geometry_to_bone = fbx_to_um_mat(cluster->geometry_to_world);
+	mesh->bounds = data->bounds;
+	mesh->bounds.clusters = aalloc_copy(vs->arena, vi_cluster_bounds, data->bounds.num_clusters, data->bounds.clusters);
+
+	mesh->parts = aalloc(vs->arena, vi_part, data->num_parts);
+	mesh->num_parts = data->num_parts;
+	for (size_t i = 0; i < data->num_parts; i++) {
+		const vi_part_data *part_data = &data->parts[i];
+		vi_part *part = &mesh->parts[i];
+		*part = part_data->part;
+
+		part->vertex_buffer = make_buffer(vs->arena, NULL, &(sg_buffer_desc){
+			.type = SG_BUFFERTYPE_VERTEXBUFFER,
+			.data = { part_data->vertices, part_data->vertices_size },
+		});
+		part->index_buffer = make_buffer(vs->arena, NULL, &(sg_buffer_desc){
+			.type = SG_BUFFERTYPE_INDEXBUFFER,
+			.data = { part_data->indices, part->num_indices * sizeof(uint32_t) },
+		});
+
+		if (vig.software) {
+			part->cpu_vertices = aalloc_copy(vs->arena, char, part_data->vertices_size, part_data->vertices);
+			part->cpu_indices = aalloc_copy(vs->arena, uint32_t, part->num_indices, part_data->indices);
+		}
+	}
+
+	size_t gpu_size = data->deform_buffer_size;
+	for (size_t i = 0; i < data->num_parts; i++) {
+		gpu_size += data->parts[i].vertices_size + data->parts[i].part.num_indices * sizeof(uint32_t);
+	}
+	vs->memory.gpu += gpu_size;
+	vs->memory.cpu += data->num_parts * sizeof(vi_part) + data->bounds.num_clusters * sizeof(vi_cluster_bounds);
+	if (bvh_copy(&mesh->pick.bvh, vs->arena, &data->pick.bvh)) {
+		size_t num_triangles = data->pick.bvh.num_triangles;
+		mesh->pick.faces = aalloc_copy(vs->arena, uint32_t, num_triangles, data->pick.faces);
+		mesh->pick.indices = aalloc_copy(vs->arena, uint32_t, num_triangles * 3, data->pick.indices);
+		vs->memory.cpu += vi_mesh_pick_memory_size(&mesh->pick);
+	}
+	if (vig.software) {
+		vs->memory.cpu += gpu_size;
+	}
+}
+
+typedef struct {
+	vi_scene *vs;
+	ufbx_mesh *fbx_mesh;
+	vi_mesh_key key;
+
+	// Either found in the cache, built by this job or shared from `jobs[source]`
+	vi_mesh_data *data;
+	arena_t *arena;
+	size_t source;
+
+	// Next job to build in the same `vi_init_meshes()` bucket or `SIZE_MAX`
+	size_t hash_next;
+} vi_mesh_job;
+
+typedef struct {
+	vi_mesh_job *jobs;
+	size_t *build_indices;
+} vi_mesh_jobs;
+
+static void vi_hash_mesh_task(void *user, size_t index)
+{
+	vi_mesh_job *job = &((vi_mesh_jobs*)user)->jobs[index];
+	job->key = vi_hash_mesh(job->vs, job->fbx_mesh);
+}
+
+static void vi_build_mesh_task(void *user, size_t index)
+{
+	vi_mesh_jobs *jobs = (vi_mesh_jobs*)user;
+	vi_mesh_job *job = &jobs->jobs[jobs->build_indices[index]];
+	job->arena = arena_create(NULL);
+	job->data = vi_build_mesh(job->vs, job->arena, job->fbx_mesh);
+}
+
+// Hashing and building run on the thread pool, cache access and GPU uploads
+// stay on the calling thread.
+static void vi_init_meshes(vi_scene *vs)
+{
+	size_t num_meshes = vs->fbx.meshes.count;
+	if (num_meshes == 0) return;
+
+	arena_t tmp;
+	arena_init(&tmp, NULL);
+
+	vi_mesh_jobs jobs;
+	jobs.jobs = aalloc(&tmp, vi_mesh_job, num_meshes);
+	jobs.build_indices = aalloc(&tmp, size_t, num_meshes);
+	for (size_t i = 0; i < num_meshes; i++) {
+		jobs.jobs[i].vs = vs;
+		jobs.jobs[i].fbx_mesh = vs->fbx.meshes.data[i];
+		jobs.jobs[i].source = i;
+	}
+
+	tp_run(num_meshes, &vi_hash_mesh_task, &jobs);
+
+	// Identical meshes within the scene are built only once, jobs to build are
+	// chained into buckets by their key hash to find earlier identical ones.
+	size_t num_buckets = 1;
+	while (num_buckets < num_meshes) num_buckets *= 2;
+	size_t *buckets = aalloc_uninit(&tmp, size_t, num_buckets);
+	for (size_t i = 0; i < num_buckets; i++) {
+		buckets[i] = SIZE_MAX;
+	}
+
+	size_t num_builds = 0;
+	for (size_t i = 0; i < num_meshes; i++) {
+		vi_mesh_job *job = &jobs.jobs[i];
+		job->data = vi_mesh_cache_find(&job->key);
+		if (job->data) continue;
+
+		uint64_t hash = job->key.hash;
+		size_t *bucket = &buckets[(hash ^ (hash >> 32)) & (num_buckets - 1)];
+		for (size_t j = *bucket; j != SIZE_MAX; j = jobs.jobs[j].hash_next) {
+			if (vi_mesh_key_equal(&jobs.jobs[j].key, &job->key)) {
+				job->source = j;
+				break;
+			}
+		}
+		if (job->source == i) {
+			job->hash_next = *bucket;
+			*bucket = i;
+			jobs.build_indices[num_builds++] = i;
+		}
+	}
+
+	tp_run(num_builds, &vi_build_mesh_task, &jobs);
+
+	// Upload everything before inserting, inserting may evict data found above
+	for (size_t i = 0; i < num_meshes; i++) {
+		vi_mesh_job *job = &jobs.jobs[i];
+		vi_upload_mesh(vs, &vs->meshes[i], jobs.jobs[job->source].data);
+	}
+
+	for (size_t i = 0; i < num_builds; i++) {
+		vi_mesh_job *job = &jobs.jobs[jobs.build_indices[i]];
+		if (!vi_mesh_cache_insert(&job->key, job->data, job->arena)) {
+			arena_free(job->arena);
+		}
+	}
+
+	arena_free(&tmp);
+}
+
+void vi_init_globals(vi_scene *vs)
+{
+	size_t num_blend_keyframes = 0;
+	for (size_t i = 0; i < vs->fbx.blend_channels.count; i++) {
+		ufbx_blend_channel *fbx_channel = vs->fbx.blend_channels.data[i];
+		vs->blend_channels[i].keyframe_offset = num_blend_keyframes;
+		num_blend_keyframes += fbx_channel->keyframes.count;
+	}
+
+	size_t global_buffer_size = 0;
+	vs->global_cluster_offset = global_buffer_size;
+	global_buffer_size += vs->fbx.skin_clusters.count * sizeof(vi_cluster_info);
+	vs->global_keyframe_offset = global_buffer_size;
+	global_buffer_size += num_blend_keyframes * sizeof(vi_blend_keyframe_info);
+	global_buffer_size = get_buffer_size(global_buffer_size);
+	vs->global_buffer_size = global_buffer_size;
+	vs->global_buffer_cpu = aalloc(vs->arena, char, vs->global_buffer_size);
+	vs->global_clusters = (vi_cluster_info*)((char*)vs->global_buffer_cpu + vs->global_cluster_offset);
+	vs->global_keyframes = (vi_blend_keyframe_info*)((char*)vs->global_buffer_cpu + vs->global_keyframe_offset);
+	vs->global_buffer = make_dynamic_buffer(vs->arena, NULL, global_buffer_size);
+	vs->memory.cpu += global_buffer_size;
+	vs->memory.gpu += global_buffer_size;
+}
+
+// Returns true if the buffer was uploaded, the CPU copy doubles as the state of the
+// GPU image so entries that didn't change since the last upload are detected by
+// comparing against it. `sg_update_image()` can only replace whole images so even
+// a single changed entry requires uploading everything.
+static bool vi_update_globals(vi_scene *vs, const ufbx_scene *fbx_scene)
+{
+	bool dirty = !vs->global_buffer_uploaded;
+
+	for (size_t chan_ix = 0; chan_ix < vs->fbx.blend_channels.count; chan_ix++) {
+		ufbx_blend_channel *channel = fbx_scene->blend_channels.data[chan_ix];
+		vi_blend_keyframe_info *infos = vs->global_keyframes + vs->blend_channels[chan_ix].keyframe_offset;
+		for (size_t i = 0; i < channel->keyframes.count; i++) {
+			ufbx_blend_keyframe key = channel->keyframes.data[i];
+			vi_blend_keyframe_info info;
+			info.weight = (float)key.effective_weight;
+			info.f_channel_id = (float)channel->typed_id;
+			info.f_shape_id = (float)key.shape->typed_id;
+			info.pad = 0.0f;
+			if (memcmp(&infos[i], &info, sizeof(info)) != 0) {
+				infos[i] = info;
+				dirty = true;
+			}
+		}
+	}
+
+	for (size_t cluster_ix = 0; cluster_ix < vs->fbx.skin_clusters.count; cluster_ix++) {
+		ufbx_skin_cluster *cluster = fbx_scene->skin_clusters.data[cluster_ix];
+		vi_cluster_info info;
+		info.geometry_to_bone = fbx_to_um_mat(cluster->geometry_to_world);
 
 		um_quat q0, qe;
 		q0 = fbx_to_um_quat(cluster->geometry_to_world_transform.rotation);
@@ -801,16 +1684,228 @@ static void vi_update_globals(vi_scene *vs, const ufbx_scene *fbx_scene)
 		qe.w = 0.0f;
 		qe = um_quat_mul(qe, q0);
 
-		info->q0 = q0;
-		info->qe = qe;
-		info->qs.xyz = fbx_to_um_vec3(cluster->geometry_to_world_transform.scale);
-		info->qs.w = 0.0f;
+		info.q0 = q0;
+		info.qe = qe;
+		info.qs.xyz = fbx_to_um_vec3(cluster->geometry_to_world_transform.scale);
+		info.qs.w = 0.0f;
+
+		if (memcmp(&vs->global_clusters[cluster_ix], &info, sizeof(info)) != 0) {
+			vs->global_clusters[cluster_ix] = info;
+			dirty = true;
+		}
 	}
 
+	if (!dirty) return false;
+
 	update_dynamic_buffer(vs->global_buffer, vs->global_buffer_cpu, vs->global_buffer_size);
+	vs->global_buffer_uploaded = true;
+	return true;
+}
+
+static void vi_init_instances(vi_scene *vs)
+{
+	size_t num_instances = 0;
+	for (size_t i = 0; i < vs->fbx.meshes.count; i++) {
+		ufbx_mesh *fbx_mesh = vs->fbx.meshes.data[i];
+		vi_mesh *mesh = &vs->meshes[i];
+		if (fbx_mesh->instances.count < VI_MIN_INSTANCED) continue;
+		mesh->instanced = true;
+		mesh->instance_offset = num_instances;
+		num_instances += fbx_mesh->instances.count;
+	}
+
+	vs->num_instances = num_instances;
+	if (num_instances == 0) return;
+
+	vs->instances = aalloc(vs->arena, vi_instance, num_instances);
+	vs->instance_buffer = make_buffer(vs->arena, NULL, &(sg_buffer_desc){
+		.type = SG_BUFFERTYPE_VERTEXBUFFER,
+		.usage = SG_USAGE_STREAM,
+		.size = num_instances * sizeof(vi_instance),
+	});
+	vs->memory.cpu += num_instances * sizeof(vi_instance);
+	vs->memory.gpu += num_instances * sizeof(vi_instance);
+}
+
+// Returns true if the box `min..max` transformed by `to_clip` is fully outside of
+// one of the clip planes. Uses `-w <= z` for the near plane which is conservative
+// for backends with a `0 <= z` clip space.
+static bool vi_cull_box(const um_mat *to_clip, um_vec3 min, um_vec3 max)
+{
+	uint32_t outside = 0x3f;
+	for (uint32_t i = 0; i < 8; i++) {
+		um_vec4 p = um_v4(i & 1 ? max.x : min.x, i & 2 ? max.y : min.y, i & 4 ? max.z : min.z, 1.0f);
+		um_vec4 c = um_mat_mulr(*to_clip, p);
+		uint32_t mask = 0;
+		if (c.x < -c.w) mask |= 0x1;
+		if (c.x > c.w) mask |= 0x2;
+		if (c.y < -c.w) mask |= 0x4;
+		if (c.y > c.w) mask |= 0x8;
+		if (c.z < -c.w) mask |= 0x10;
+		if (c.z > c.w) mask |= 0x20;
+		outside &= mask;
+		if (!outside) return false;
+	}
+	return true;
+}
+
+static void vi_transform_bounds(const um_mat *m, um_vec3 min, um_vec3 max, um_vec3 *p_min, um_vec3 *p_max)
+{
+	um_vec3 center = um_mul3(um_add3(min, max), 0.5f);
+	um_vec3 extent = um_mul3(um_sub3(max, min), 0.5f);
+	um_vec3 c = um_transform_point(m, center);
+	um_vec3 e = um_transform_extent(m, extent);
+	*p_min = um_min3(*p_min, um_sub3(c, e));
+	*p_max = um_max3(*p_max, um_add3(c, e));
+}
+
+// Expand `p_min..p_max` by the world space bounds of `mesh` instanced under `node`
+// using the current cluster transforms, `min..max` is used for non-skinned meshes.
+static void vi_add_mesh_world_bounds(vi_scene *vs, const vi_mesh *mesh, const vi_node *node, um_vec3 min, um_vec3 max, um_vec3 *p_min, um_vec3 *p_max)
+{
+	if (!mesh->bounds.skinned) {
+		vi_transform_bounds(&node->geometry_to_world, min, max, p_min, p_max);
+		return;
+	}
+
+	// Skinned vertices don't use the node transform, bound them in world space
+	for (size_t i = 0; i < mesh->bounds.num_clusters; i++) {
+		const vi_cluster_bounds *cb = &mesh->bounds.clusters[i];
+		const um_mat *cluster_to_world = &vs->global_clusters[cb->cluster_id].geometry_to_bone;
+		vi_transform_bounds(cluster_to_world, cb->min, cb->max, p_min, p_max);
+	}
+	if (mesh->bounds.has_unskinned_vertices) {
+		vi_transform_bounds(&node->geometry_to_world, mesh->bounds.min, mesh->bounds.max, p_min, p_max);
+	}
+}
+
+// Returns true if `min..max` (geometry space bounds of the mesh or one of its parts)
+// of `mesh` instanced under `node` is not visible using the last `vi_update()` view.
+static bool vi_cull_mesh(vi_scene *vs, const vi_mesh *mesh, const vi_node *node, um_vec3 min, um_vec3 max)
+{
+	if (!(min.x <= max.x)) return false;
+
+	if (!mesh->bounds.skinned) {
+		um_mat geometry_to_clip = um_mat_mul(vs->world_to_clip, node->geometry_to_world);
+		return vi_cull_box(&geometry_to_clip, min, max);
+	}
+
+	um_vec3 world_min = um_dup3(FLT_MAX), world_max = um_dup3(-FLT_MAX);
+	vi_add_mesh_world_bounds(vs, mesh, node, min, max, &world_min, &world_max);
+	if (!(world_min.x <= world_max.x)) return false;
+	return vi_cull_box(&vs->world_to_clip, world_min, world_max);
+}
+
+static void vi_update_visibility(vi_scene *vs)
+{
+	// Instances of non-instanced meshes are culled if all of their parts are,
+	// instanced meshes are counted in `vi_update_instances()`
+	memset(vs->node_drawn, 0, vs->fbx.nodes.count * sizeof(bool));
+	size_t num_drawn_instances = 0;
+
+	for (size_t item_ix = 0; item_ix < vs->num_draw_items; item_ix++) {
+		const vi_draw_item *item = &vs->draw_items[item_ix];
+		const vi_mesh *mesh = &vs->meshes[item->mesh_ix];
+		if (mesh->instanced) {
+			vs->draw_visible[item_ix] = mesh->num_visible_instances > 0;
+		} else {
+			const vi_part *part = &mesh->parts[item->part_ix];
+			const vi_node *node = &vs->nodes[item->node_ix];
+			bool visible = !vi_cull_mesh(vs, mesh, node, part->bounds_min, part->bounds_max);
+			vs->draw_visible[item_ix] = visible;
+			if (visible && !vs->node_drawn[item->node_ix]) {
+				vs->node_drawn[item->node_ix] = true;
+				num_drawn_instances++;
+			}
+		}
+	}
+
+	vs->render_stats.culled_instances += (uint32_t)(vs->num_draw_instances - num_drawn_instances);
 }
 
-vi_scene *vi_make_scene(const ufbx_scene *fbx_scene)
+static void vi_update_instances(vi_scene *vs, const vi_desc *desc)
+{
+	if (vs->num_instances == 0) return;
+
+	for (size_t mesh_ix = 0; mesh_ix < vs->fbx.meshes.count; mesh_ix++) {
+		ufbx_mesh *fbx_mesh = vs->fbx.meshes.data[mesh_ix];
+		vi_mesh *mesh = &vs->meshes[mesh_ix];
+		if (!mesh->instanced) continue;
+
+		// Visible instances are packed to the start of the mesh's range
+		vi_instance *instances = vs->instances + mesh->instance_offset;
+		size_t num_visible = 0;
+		for (size_t inst_ix = 0; inst_ix < fbx_mesh->instances.count; inst_ix++) {
+			ufbx_node *fbx_node = fbx_mesh->instances.data[inst_ix];
+			vi_node *node = &vs->nodes[fbx_node->typed_id];
+			if (vi_cull_mesh(vs, mesh, node, mesh->bounds.min, mesh->bounds.max)) continue;
+
+			instances[num_visible].geometry_to_world = node->geometry_to_world;
+			instances[num_visible].highlight = fbx_node->element_id == desc->selected_element_id ? 0.5f : 0.0f;
+			num_visible++;
+		}
+		mesh->num_visible_instances = num_visible;
+		vs->render_stats.culled_instances += (uint32_t)(fbx_mesh->instances.count - num_visible);
+	}
+
+	sg_update_buffer(vs->instance_buffer, &(sg_range){ vs->instances, vs->num_instances * sizeof(vi_instance) });
+}
+
+static int vi_cmp_draw_item(const void *va, const void *vb)
+{
+	const vi_draw_item *a = (const vi_draw_item*)va, *b = (const vi_draw_item*)vb;
+	if (a->sort_key != b->sort_key) return a->sort_key < b->sort_key ? -1 : 1;
+	if (a->part_ix != b->part_ix) return a->part_ix < b->part_ix ? -1 : 1;
+	return a->order < b->order ? -1 : a->order > b->order ? 1 : 0;
+}
+
+// Draws of the same part end up next to each other, so consecutive instances
+// only need to update uniforms and not re-apply the pipeline or bindings.
+static void vi_init_draw_items(vi_scene *vs)
+{
+	size_t num_items = 0;
+	for (size_t mesh_ix = 0; mesh_ix < vs->fbx.meshes.count; mesh_ix++) {
+		ufbx_mesh *fbx_mesh = vs->fbx.meshes.data[mesh_ix];
+		vi_mesh *mesh = &vs->meshes[mesh_ix];
+		size_t num_draws = mesh->instanced ? 1 : fbx_mesh->instances.count;
+		num_items += num_draws * mesh->num_parts;
+	}
+
+	vi_draw_item *items = aalloc(vs->arena, vi_draw_item, num_items);
+	vs->draw_items = items;
+	vs->num_draw_items = num_items;
+	vs->draw_visible = aalloc(vs->arena, bool, num_items);
+	vs->node_drawn = aalloc(vs->arena, bool, vs->fbx.nodes.count);
+	vs->memory.cpu += num_items * (sizeof(vi_draw_item) + sizeof(bool)) + vs->fbx.nodes.count * sizeof(bool);
+
+	size_t item_ix = 0;
+	for (size_t mesh_ix = 0; mesh_ix < vs->fbx.meshes.count; mesh_ix++) {
+		ufbx_mesh *fbx_mesh = vs->fbx.meshes.data[mesh_ix];
+		vi_mesh *mesh = &vs->meshes[mesh_ix];
+		size_t num_draws = mesh->instanced ? 1 : fbx_mesh->instances.count;
+		if (!mesh->instanced && mesh->num_parts > 0) {
+			vs->num_draw_instances += num_draws;
+		}
+		for (size_t draw_ix = 0; draw_ix < num_draws; draw_ix++) {
+			uint32_t node_ix = mesh->instanced ? UINT32_MAX : fbx_mesh->instances.data[draw_ix]->typed_id;
+			for (size_t part_ix = 0; part_ix < mesh->num_parts; part_ix++) {
+				vi_draw_item *item = &items[item_ix];
+				item->sort_key = (uint64_t)(mesh->instanced ? 1u : 0u) << 63
+					| (uint64_t)(mesh->parts[part_ix].material_id & 0x7fffffffu) << 32
+					| (uint64_t)mesh_ix;
+				item->mesh_ix = (uint32_t)mesh_ix;
+				item->part_ix = (uint32_t)part_ix;
+				item->node_ix = node_ix;
+				item->order = (uint32_t)item_ix;
+				item_ix++;
+			}
+		}
+	}
+
+	qsort(items, num_items, sizeof(vi_draw_item), &vi_cmp_draw_item);
+}
+
+vi_scene *vi_make_scene(const ufbx_scene *fbx_scene, const vi_scene_opts *opts)
 {
 	arena_t *arena = arena_create(&vig.arena);
 	vi_scene *vs = aalloc(arena, vi_scene, 1);
@@ -818,11 +1913,16 @@ vi_scene *vi_make_scene(const ufbx_scene *fbx_scene)
 	if (!vs) return NULL;
 
 	vs->fbx = *fbx_scene;
+	vs->fbx_source = fbx_scene;
+	vs->compact_vertices = opts ? opts->compact_vertices : false;
+	vs->optimize_vertex_cache = opts ? opts->optimize_vertex_cache : false;
 
 	vs->meshes = aalloc(vs->arena, vi_mesh, fbx_scene->meshes.count);
 	vs->nodes = aalloc(vs->arena, vi_node, fbx_scene->nodes.count);
 	vs->materials = aalloc(vs->arena, vi_material, fbx_scene->materials.count + 1); // + NULL
 	vs->blend_channels = aalloc(vs->arena, vi_blend_channel, fbx_scene->blend_channels.count);
+	vs->memory.cpu += fbx_scene->meshes.count * sizeof(vi_mesh) + fbx_scene->nodes.count * sizeof(vi_node)
+		+ (fbx_scene->materials.count + 1) * sizeof(vi_material) + fbx_scene->blend_channels.count * sizeof(vi_blend_channel);
 
 	vi_init_globals(vs);
 
@@ -830,9 +1930,9 @@ vi_scene *vi_make_scene(const ufbx_scene *fbx_scene)
 		vi_init_node(vs, &vs->nodes[i], vs->fbx.nodes.data[i]);
 	}
 
-	for (size_t i = 0; i < vs->fbx.meshes.count; i++) {
-		vi_init_mesh(vs, &vs->meshes[i], vs->fbx.meshes.data[i]);
-	}
+	vi_init_meshes(vs);
+	vi_init_instances(vs);
+	vi_init_draw_items(vs);
 
 	// NULL material
 	{
@@ -853,6 +1953,109 @@ void vi_free_scene(vi_scene *scene)
 	arena_free(scene->arena);
 }
 
+vi_scene_memory vi_get_scene_memory(vi_scene *scene)
+{
+	vi_scene_memory memory = scene->memory;
+	if (scene->fbx_state) {
+		memory.cpu += scene->fbx_state->metadata.result_memory_used;
+	}
+	return memory;
+}
+
+bool vi_pick(vi_scene *vs, float x, float y, vi_pick_result *result)
+{
+	memset(result, 0, sizeof(vi_pick_result));
+	if (!vs->has_view) return false;
+
+	// Ray from the camera through the clip space point (`x`, `y`), the depth
+	// is arbitrary as long as it's inside the clip range of every backend.
+	um_mat clip_to_world = um_mat_inverse(vs->world_to_clip);
+	um_vec4 p = um_mat_mulr(clip_to_world, um_v4(x, y, 0.5f, 1.0f));
+	um_vec3 target = um_div3(p.xyz, p.w);
+	um_vec3 origin = vs->camera_pos;
+	um_vec3 direction = um_normalize3(um_sub3(target, origin));
+
+	bvh_hit hit = { 0 };
+	hit.t = FLT_MAX;
+	ufbx_mesh *hit_mesh = NULL;
+	ufbx_node *hit_node = NULL;
+
+	for (size_t mesh_ix = 0; mesh_ix < vs->fbx.meshes.count; mesh_ix++) {
+		ufbx_mesh *fbx_mesh = vs->fbx.meshes.data[mesh_ix];
+		vi_mesh *mesh = &vs->meshes[mesh_ix];
+		if (fbx_mesh->instances.count == 0) continue;
+
+		if (!mesh->pick.bvh.nodes) continue;
+		const bvh_node *root = &mesh->pick.bvh.nodes[0];
+
+		for (size_t inst_ix = 0; inst_ix < fbx_mesh->instances.count; inst_ix++) {
+			ufbx_node *fbx_node = fbx_mesh->instances.data[inst_ix];
+			vi_node *node = &vs->nodes[fbx_node->typed_id];
+
+			// Reject instances by their world bounds before inverting the transform
+			um_vec3 world_min = um_dup3(FLT_MAX), world_max = um_dup3(-FLT_MAX);
+			vi_transform_bounds(&node->geometry_to_world, root->min, root->max, &world_min, &world_max);
+			if (!bvh_ray_bounds(world_min, world_max, origin, direction, hit.t)) continue;
+
+			// Cast in geometry space without normalizing the direction so `t`
+			// stays comparable between instances.
+			um_mat world_to_geometry = um_mat_inverse(node->geometry_to_world);
+			um_vec3 local_origin = um_transform_point(&world_to_geometry, origin);
+			um_vec3 local_direction = um_transform_direction(&world_to_geometry, direction);
+			if (bvh_raycast(&mesh->pick.bvh, local_origin, local_direction, &hit)) {
+				hit_mesh = fbx_mesh;
+				hit_node = fbx_node;
+			}
+		}
+	}
+
+	if (!hit_mesh) return false;
+
+	vi_mesh *mesh = &vs->meshes[hit_mesh->typed_id];
+	const uint32_t *indices = mesh->pick.indices + hit.triangle_id * 3;
+	float w = 1.0f - hit.u - hit.v;
+
+	result->mesh_element_id = hit_mesh->element_id;
+	result->node_element_id = hit_node->element_id;
+	result->face_index = mesh->pick.faces[hit.triangle_id];
+	result->indices[0] = indices[0];
+	result->indices[1] = indices[1];
+	result->indices[2] = indices[2];
+	result->barycentric = um_v3(w, hit.u, hit.v);
+	result->index = w >= hit.u && w >= hit.v ? indices[0] : hit.u >= hit.v ? indices[1] : indices[2];
+	result->position = um_add3(origin, um_mul3(direction, hit.t));
+	result->distance = hit.t;
+	return true;
+}
+
+size_t vi_get_part_stats(vi_scene *vs, vi_part_stats *stats, size_t max_stats)
+{
+	size_t num_stats = 0;
+	for (size_t mesh_ix = 0; mesh_ix < vs->fbx.meshes.count; mesh_ix++) {
+		vi_mesh *mesh = &vs->meshes[mesh_ix];
+		for (size_t part_ix = 0; part_ix < mesh->num_parts; part_ix++) {
+			vi_part *part = &mesh->parts[part_ix];
+			if (num_stats < max_stats) {
+				stats[num_stats] = (vi_part_stats){
+					.mesh_element_id = vs->fbx.meshes.data[mesh_ix]->element_id,
+					.material_id = part->material_id,
+					.num_indices = part->num_indices,
+					.num_vertices = part->num_vertices,
+					.acmr = part->cache_stats.acmr,
+					.atvr = part->cache_stats.atvr,
+					.original_acmr = part->original_cache_stats.acmr,
+					.original_atvr = part->original_cache_stats.atvr,
+					.vertex_size = vs->compact_vertices ? (uint32_t)sizeof(vi_compact_vertex) : (uint32_t)sizeof(vi_vertex),
+					.max_position_error = part->max_position_error,
+					.max_normal_error = part->max_normal_error,
+				};
+			}
+			num_stats++;
+		}
+	}
+	return num_stats;
+}
+
 typedef struct {
 	uint32_t width, height;
 	uint32_t msaa;
@@ -940,94 +2143,182 @@ static um_vec3 hex_to_um3(uint32_t hex)
 		(float)((hex>> 0)&0xff)/255.0f);
 }
 
-static void vi_draw_meshes(vi_pipelines *ps, vi_scene *vs, const vi_desc *desc)
+// Redundant state changes skipped by `vi_draw_meshes()`, reset when the pipeline changes
+typedef struct {
+	sg_pipeline pipeline;
+	bool has_bindings;
+	bool has_vs_uniforms;
+	bool has_fs_uniforms;
+	sg_bindings bindings;
+	ubo_mesh_vertex_t vs_uniforms;
+	ubo_mesh_pixel_t fs_uniforms;
+} vi_draw_state;
+
+typedef struct {
+	float highlight;
+	um_vec3 color;
+	int cluster;
+	int channel;
+	int shape;
+} vi_mesh_highlight;
+
+// Highlight of a mesh part drawn under `fbx_node`, NULL for instanced draws
+static vi_mesh_highlight vi_get_mesh_highlight(vi_scene *vs, const vi_desc *desc, ufbx_mesh *fbx_mesh, ufbx_node *fbx_node, ufbx_material *fbx_material)
 {
 	ufbx_element *selected_element = NULL;
 	if (desc->selected_element_id < vs->fbx.elements.count) {
 		selected_element = vs->fbx.elements.data[desc->selected_element_id];
 	}
-	for (size_t mesh_ix = 0; mesh_ix < vs->fbx.meshes.count; mesh_ix++) {
-		ufbx_mesh *fbx_mesh = vs->fbx.meshes.data[mesh_ix];
-		vi_mesh *mesh = &vs->meshes[mesh_ix];
 
-		for (size_t inst_ix = 0; inst_ix < fbx_mesh->instances.count; inst_ix++) {
-			ufbx_node *fbx_node = fbx_mesh->instances.data[inst_ix];
-			vi_node *node = &vs->nodes[fbx_node->typed_id];
-
-			for (size_t part_ix = 0; part_ix < mesh->num_parts; part_ix++) {
-				vi_part *part = &mesh->parts[part_ix];
+	int highlight_cluster = -1;
+	int highlight_channel = -1;
+	int highlight_shape = -1;
+
+	um_vec3 highlight_color = um_zero3;
+	float highlight = 0.0f;
+	if (fbx_mesh->element_id == desc->selected_element_id) {
+		highlight = 1.0f;
+		highlight_color = hex_to_um3(0xf4bf6e);
+	} else if (fbx_material && fbx_material->element_id == desc->selected_element_id) {
+		highlight = 1.0f;
+		highlight_color = hex_to_um3(0x6cdaa2);
+	} else if (fbx_node && fbx_node->element_id == desc->selected_element_id) {
+		highlight = 0.5f;
+		highlight_color = hex_to_um3(0x6cb9da);
+	} else if (!fbx_node && selected_element && selected_element->type == UFBX_ELEMENT_NODE) {
+		// Amount from `vi_instance.highlight`
+		highlight_color = hex_to_um3(0x6cb9da);
+	}
 
-				sg_apply_pipeline(ps->mesh_pipe);
+	if (selected_element && selected_element->type == UFBX_ELEMENT_SKIN_CLUSTER) {
+		highlight_cluster = selected_element->typed_id;
+		highlight_color = hex_to_um3(0xdf91e8);
+	} else if (selected_element && selected_element->type == UFBX_ELEMENT_BLEND_CHANNEL) {
+		highlight_channel = selected_element->typed_id;
+		highlight_color = hex_to_um3(0xdf91e8);
+	} else if (selected_element && selected_element->type == UFBX_ELEMENT_BLEND_SHAPE) {
+		highlight_shape = selected_element->typed_id;
+		highlight_color = hex_to_um3(0xdf91e8);
+	}
 
-				ufbx_material *fbx_material = NULL;
-				if (part->material_id < vs->fbx.materials.count) {
-					fbx_material = vs->fbx.materials.data[part->material_id];
-				}
+	for (size_t i = 0; i < fbx_mesh->all_deformers.count; i++) {
+		if (fbx_mesh->all_deformers.data[i]->element_id == desc->selected_element_id) {
+			highlight = 1.0f;
+			highlight_color = hex_to_um3(0xdf91e8);
+		}
+	}
 
-				int highlight_cluster = -1;
-				int highlight_channel = -1;
-				int highlight_shape = -1;
-
-				um_vec3 highlight_color = um_zero3;
-				float highlight = 0.0f;
-				if (fbx_mesh->element_id == desc->selected_element_id) {
-					highlight = 1.0f;
-					highlight_color = hex_to_um3(0xf4bf6e);
-				} else if (fbx_material && fbx_material->element_id == desc->selected_element_id) {
-					highlight = 1.0f;
-					highlight_color = hex_to_um3(0x6cdaa2);
-				} else if (fbx_node->element_id == desc->selected_element_id) {
-					highlight = 0.5f;
-					highlight_color = hex_to_um3(0x6cb9da);
-				}
+	vi_mesh_highlight hl = {
+		.highlight = highlight,
+		.color = highlight_color,
+		.cluster = highlight_cluster,
+		.channel = highlight_channel,
+		.shape = highlight_shape,
+	};
+	return hl;
+}
 
-				if (selected_element && selected_element->type == UFBX_ELEMENT_SKIN_CLUSTER) {
-					highlight_cluster = selected_element->typed_id;
-					highlight_color = hex_to_um3(0xdf91e8);
-				} else if (selected_element && selected_element->type == UFBX_ELEMENT_BLEND_CHANNEL) {
-					highlight_channel = selected_element->typed_id;
-					highlight_color = hex_to_um3(0xdf91e8);
-				} else if (selected_element && selected_element->type == UFBX_ELEMENT_BLEND_SHAPE) {
-					highlight_shape = selected_element->typed_id;
-					highlight_color = hex_to_um3(0xdf91e8);
-				}
+static void vi_draw_meshes(vi_pipelines *ps, vi_scene *vs, const vi_desc *desc)
+{
+	vi_render_stats *stats = &vs->render_stats;
+	vi_draw_state state = { 0 };
+
+	for (size_t item_ix = 0; item_ix < vs->num_draw_items; item_ix++) {
+		const vi_draw_item *item = &vs->draw_items[item_ix];
+		ufbx_mesh *fbx_mesh = vs->fbx.meshes.data[item->mesh_ix];
+		vi_mesh *mesh = &vs->meshes[item->mesh_ix];
+		vi_part *part = &mesh->parts[item->part_ix];
+
+		if (!vs->draw_visible[item_ix]) {
+			stats->culled_draw_calls++;
+			continue;
+		}
 
-				for (size_t i = 0; i < fbx_mesh->all_deformers.count; i++) {
-					if (fbx_mesh->all_deformers.data[i]->element_id == desc->selected_element_id) {
-						highlight = 1.0f;
-						highlight_color = hex_to_um3(0xdf91e8);
-					}
-				}
+		// Instanced meshes are drawn once with per-instance transforms and node highlights
+		ufbx_node *fbx_node = NULL;
+		vi_node *node = NULL;
+		if (item->node_ix != UINT32_MAX) {
+			fbx_node = vs->fbx.nodes.data[item->node_ix];
+			node = &vs->nodes[item->node_ix];
+		}
 
-				ubo_mesh_vertex_t vu = {
-					.u_geometry_to_world = node->geometry_to_world,
-					.u_world_to_clip = vs->world_to_clip,
-					.u_highlight = highlight,
-					.ui_highlight_cluster = (float)highlight_cluster,
-					.ui_highlight_channel = (float)highlight_channel,
-					.ui_highlight_shape = (float)highlight_shape,
-					.ui_g_cluster_begin = (float)(vs->global_cluster_offset / 16),
-					.ui_g_keyframe_begin = (float)(vs->global_keyframe_offset / 16),
-				};
-				sg_apply_uniforms(SG_SHADERSTAGE_VS, 0, SG_RANGE_REF(vu));
+		sg_pipeline pipeline;
+		if (mesh->instanced) {
+			pipeline = vs->compact_vertices ? ps->mesh_compact_instanced_pipe : ps->mesh_instanced_pipe;
+		} else {
+			pipeline = vs->compact_vertices ? ps->mesh_compact_pipe : ps->mesh_pipe;
+		}
+		if (pipeline.id != state.pipeline.id) {
+			sg_apply_pipeline(pipeline);
+			memset(&state, 0, sizeof(state));
+			state.pipeline = pipeline;
+			stats->pipeline_changes++;
+		}
 
+		ufbx_material *fbx_material = NULL;
+		if (part->material_id < vs->fbx.materials.count) {
+			fbx_material = vs->fbx.materials.data[part->material_id];
+		}
 
-				ubo_mesh_pixel_t pu = {
-					.highlight_color = highlight_color,
-					.pixel_scale = vs->pixel_scale,
-				};
-				sg_apply_uniforms(SG_SHADERSTAGE_FS, 0, SG_RANGE_REF(pu));
+		vi_mesh_highlight hl = vi_get_mesh_highlight(vs, desc, fbx_mesh, fbx_node, fbx_material);
+
+		// Bindings and uniform blocks are compared with `memcmp()`, so they are cleared
+		// with `memset()` first as initializers are not guaranteed to zero padding.
+		sg_bindings binds;
+		memset(&binds, 0, sizeof(binds));
+		binds.vs_images[SLOT_u_deform_buffer] = mesh->deform_buffer;
+		binds.vs_images[SLOT_u_global_buffer] = vs->global_buffer;
+		binds.vertex_buffers[0] = part->vertex_buffer;
+		binds.index_buffer = part->index_buffer;
+
+		int num_instances = 1;
+		if (mesh->instanced) {
+			binds.vertex_buffers[1] = vs->instance_buffer;
+			binds.vertex_buffer_offsets[1] = (int)(mesh->instance_offset * sizeof(vi_instance));
+			num_instances = (int)mesh->num_visible_instances;
+			stats->instanced_draw_calls++;
+		}
+		if (!state.has_bindings || memcmp(&binds, &state.bindings, sizeof(sg_bindings)) != 0) {
+			sg_apply_bindings(&binds);
+			state.bindings = binds;
+			state.has_bindings = true;
+			stats->binding_changes++;
+		}
 
-				sg_apply_bindings(&(sg_bindings){
-					.vs_images[SLOT_u_deform_buffer] = mesh->deform_buffer,
-					.vs_images[SLOT_u_global_buffer] = vs->global_buffer,
-					.vertex_buffers[0] = part->vertex_buffer,
-					.index_buffer = part->index_buffer,
-				});
+		ubo_mesh_vertex_t vu;
+		memset(&vu, 0, sizeof(vu));
+		vu.u_geometry_to_world = node ? node->geometry_to_world : um_mat_identity;
+		vu.u_world_to_clip = vs->world_to_clip;
+		vu.u_position_offset = um_v4(part->position_offset.x, part->position_offset.y, part->position_offset.z, 0.0f);
+		vu.u_position_scale = um_v4(part->position_scale.x, part->position_scale.y, part->position_scale.z, 0.0f);
+		vu.u_highlight = hl.highlight;
+		vu.ui_highlight_cluster = (float)hl.cluster;
+		vu.ui_highlight_channel = (float)hl.channel;
+		vu.ui_highlight_shape = (float)hl.shape;
+		vu.ui_g_cluster_begin = (float)(vs->global_cluster_offset / 16);
+		vu.ui_g_keyframe_begin = (float)(vs->global_keyframe_offset / 16);
+		if (!state.has_vs_uniforms || memcmp(&vu, &state.vs_uniforms, sizeof(vu)) != 0) {
+			sg_apply_uniforms(SG_SHADERSTAGE_VS, 0, SG_RANGE_REF(vu));
+			state.vs_uniforms = vu;
+			state.has_vs_uniforms = true;
+			stats->uniform_changes++;
+		}
 
-				sg_draw(0, (int)part->num_indices, 1);
-			}
+		ubo_mesh_pixel_t pu;
+		memset(&pu, 0, sizeof(pu));
+		pu.highlight_color = hl.color;
+		pu.pixel_scale = vs->pixel_scale;
+		if (!state.has_fs_uniforms || memcmp(&pu, &state.fs_uniforms, sizeof(pu)) != 0) {
+			sg_apply_uniforms(SG_SHADERSTAGE_FS, 0, SG_RANGE_REF(pu));
+			state.fs_uniforms = pu;
+			state.has_fs_uniforms = true;
+			stats->uniform_changes++;
 		}
+
+		sg_draw(0, (int)part->num_indices, num_instances);
+		stats->draw_calls++;
+		stats->instances += (uint32_t)num_instances;
+		stats->triangles += part->num_indices / 3 * (uint32_t)num_instances;
 	}
 }
 
@@ -1470,24 +2761,512 @@ static void vi_draw_present(vi_framebuffer *src)
 	sg_draw(0, 3, 1);
 }
 
+// -- Software rendering
+// CPU versions of the `mesh`, `debug` and `icon` shaders for `vig.software`, see `soft_raster.h`.
+
+enum {
+	VI_SOFT_MESH_VARYINGS = 6,  // normal, barycentric, highlight
+	VI_SOFT_DEBUG_VARYINGS = 4, // color
+	VI_SOFT_ICON_VARYINGS = 14, // uv, sdf thresholds, color, outline color
+};
+
+typedef struct {
+	um_vec3 highlight_color;
+	float pixel_scale;
+} vi_soft_mesh_pixel;
+
+typedef struct {
+	const vi_mesh *mesh;
+	const vi_part *part;
+	um_mat geometry_to_world;
+	float highlight;
+	vi_mesh_highlight hl;
+	uint32_t state_id;
+	sr_vertex *vertices;
+} vi_soft_draw;
+
+typedef struct {
+	vi_scene *vs;
+	vi_soft_draw *draws;
+} vi_soft_draws;
+
+static sr_target *vi_get_soft_target(uint32_t index, uint32_t width, uint32_t height)
+{
+	sr_target *target = &vig.soft_targets[index];
+	if (target->color && target->width == width && target->height == height) return target;
+
+	if (!vig.fb_arena) {
+		vig.fb_arena = arena_create(&vig.arena);
+	}
+
+	afree(vig.fb_arena, target->color);
+	afree(vig.fb_arena, target->depth);
+	afree(vig.fb_arena, target->stencil);
+
+	size_t num_pixels = (size_t)width * height;
+	target->width = width;
+	target->height = height;
+	target->color = aalloc(vig.fb_arena, uint8_t, num_pixels * 4);
+	target->depth = aalloc(vig.fb_arena, float, num_pixels);
+	target->stencil = aalloc(vig.fb_arena, uint8_t, num_pixels);
+	return target;
+}
+
+// Port of `deformVertex()` in `mesh.glsl`, reads the CPU copies of the deform and global buffers
+static void vi_soft_deform_vertex(vi_scene *vs, const vi_soft_draw *draw, sr_vertex *dst, um_vec3 geo_pos, um_vec3 geo_normal, int32_t packed_index)
+{
+	int32_t bary_index = packed_index & 3;
+	int32_t vertex_index = packed_index >> 2;
+	um_mat geometry_to_world = draw->geometry_to_world;
+	float highlight = draw->highlight;
+
+	const um_vec4 *deform = draw->mesh->cpu_deform_buffer;
+	um_vec4 deform_info = deform[vertex_index];
+	float dq_weight = um_clamp((deform_info.x - floorf(deform_info.x)) * 2.0f, 0.0f, 1.0f);
+	int32_t num_bones = (int32_t)um_min(floorf(deform_info.x), 16.0f);
+	int32_t bone_base = (int32_t)deform_info.y;
+
+	if (num_bones > 0) {
+		memset(&geometry_to_world, 0, sizeof(um_mat));
+	}
+
+	um_vec4 q0 = um_zero4, qe = um_zero4, qs = um_zero4;
+	for (int32_t bone_ix = 0; bone_ix < num_bones; bone_ix++) {
+		um_vec4 bone_info = deform[bone_base + bone_ix];
+		for (uint32_t i = 0; i < 2; i++) {
+			int32_t cluster_index = (int32_t)(i == 0 ? bone_info.x : bone_info.z);
+			float weight = i == 0 ? bone_info.y : bone_info.w;
+			if (cluster_index == draw->hl.cluster) highlight += weight;
+
+			const vi_cluster_info *cluster = &vs->global_clusters[cluster_index];
+			for (uint32_t j = 0; j < 16; j++) {
+				geometry_to_world.m[j] += cluster->geometry_to_bone.m[j] * weight;
+			}
+
+			if (dq_weight > 0.0f) {
+				float vweight = um_dot4(q0, cluster->q0.xyzw) < 0.0f ? -weight : weight;
+				q0 = um_add4(q0, um_mul4(cluster->q0.xyzw, vweight));
+				qe = um_add4(qe, um_mul4(cluster->qe.xyzw, vweight));
+				qs = um_add4(qs, um_mul4(cluster->qs, weight));
+			}
+		}
+	}
+
+	if (dq_weight > 0.0f) {
+		float rcp_len = 1.0f / sqrtf(um_dot4(q0, q0));
+		float rcp_len2x2 = 2.0f * rcp_len * rcp_len;
+		um_vec4 q = um_mul4(q0, rcp_len);
+		um_vec3 t;
+		t.x = rcp_len2x2 * (- qe.w*q0.x + qe.x*q0.w - qe.y*q0.z + qe.z*q0.y);
+		t.y = rcp_len2x2 * (- qe.w*q0.y + qe.x*q0.z + qe.y*q0.w - qe.z*q0.x);
+		t.z = rcp_len2x2 * (- qe.w*q0.z - qe.x*q0.y + qe.y*q0.x + qe.z*q0.w);
+
+		float sx = 2.0f * qs.x, sy = 2.0f * qs.y, sz = 2.0f * qs.z;
+		float xx = q.x*q.x, xy = q.x*q.y, xz = q.x*q.z, xw = q.x*q.w;
+		float yy = q.y*q.y, yz = q.y*q.z, yw = q.y*q.w;
+		float zz = q.z*q.z, zw = q.z*q.w;
+		um_mat dq_matrix = um_mat_cols(
+			sx * (- yy - zz + 0.5f), sx * (+ xy + zw), sx * (- yw + xz), 0.0f,
+			sy * (- zw + xy), sy * (- xx - zz + 0.5f), sy * (+ xw + yz), 0.0f,
+			sz * (+ xz + yw), sz * (- xw + yz), sz * (- xx - yy + 0.5f), 0.0f,
+			t.x, t.y, t.z, 1.0f);
+
+		for (uint32_t j = 0; j < 16; j++) {
+			geometry_to_world.m[j] = geometry_to_world.m[j] * (1.0f - dq_weight) + dq_matrix.m[j] * dq_weight;
+		}
+	}
+
+	int32_t num_blends = (int32_t)um_min(deform_info.z, 16.0f);
+	int32_t blend_base = (int32_t)deform_info.w;
+	for (int32_t blend_ix = 0; blend_ix < num_blends; blend_ix++) {
+		um_vec4 blend_info = deform[blend_base + blend_ix];
+		const vi_blend_keyframe_info *keyframe = &vs->global_keyframes[(int32_t)blend_info.x];
+		um_vec3 offset = um_v3(blend_info.y, blend_info.z, blend_info.w);
+		geo_pos = um_add3(geo_pos, um_mul3(offset, keyframe->weight));
+		if ((int32_t)keyframe->f_channel_id == draw->hl.channel || (int32_t)keyframe->f_shape_id == draw->hl.shape) {
+			highlight += 1.0f;
+		}
+	}
+
+	um_vec4 world_pos = um_mat_mulr(geometry_to_world, um_v4(geo_pos.x, geo_pos.y, geo_pos.z, 1.0f));
+	um_vec4 world_normal = um_mat_mulr(geometry_to_world, um_v4(geo_normal.x, geo_normal.y, geo_normal.z, 0.0f));
+	world_pos.w = 1.0f;
+
+	um_vec3 normal = um_normalize3(world_normal.xyz);
+	dst->position = um_mat_mulr(vs->world_to_clip, world_pos);
+	dst->varyings[0] = normal.x;
+	dst->varyings[1] = normal.y;
+	dst->varyings[2] = normal.z;
+	dst->varyings[3] = bary_index == 1 ? 1.0f : 0.0f;
+	dst->varyings[4] = bary_index == 2 ? 1.0f : 0.0f;
+	dst->varyings[5] = um_min(highlight, 1.0f);
+}
+
+static void vi_soft_vertex_task(void *user, size_t index)
+{
+	vi_soft_draws *draws = (vi_soft_draws*)user;
+	vi_scene *vs = draws->vs;
+	const vi_soft_draw *draw = &draws->draws[index];
+	const vi_part *part = draw->part;
+
+	for (uint32_t i = 0; i < part->num_vertices; i++) {
+		sr_vertex *dst = &draw->vertices[i];
+		if (vs->compact_vertices) {
+			const vi_compact_vertex *v = (const vi_compact_vertex*)part->cpu_vertices + i;
+			cv_bounds bounds = { part->position_offset, part->position_scale };
+			um_vec3 pos = cv_decode_position(v->position, &bounds);
+			um_vec3 normal = cv_decode_normal(v->normal);
+			vi_soft_deform_vertex(vs, draw, dst, pos, normal, v->vertex_id);
+		} else {
+			const vi_vertex *v = (const vi_vertex*)part->cpu_vertices + i;
+			vi_soft_deform_vertex(vs, draw, dst, v->position, v->normal, v->vertex_id);
+		}
+	}
+}
+
+// Port of `mesh_pixel` in `mesh.glsl`
+static void vi_soft_shade_mesh(float color[4], const sr_fragment *frag, const void *uniforms)
+{
+	const vi_soft_mesh_pixel *u = (const vi_soft_mesh_pixel*)uniforms;
+	const float *v = frag->varyings;
+
+	um_vec3 l = um_normalize3(um_v3(1.0f, 1.7f, 1.4f));
+	um_vec3 n = um_normalize3(um_v3(v[0], v[1], v[2]));
+	float x = um_dot3(n, l) * 0.4f + 0.4f;
+
+	float bary[3] = { v[3], v[4], 1.0f - v[3] - v[4] };
+	float dx[3] = { frag->ddx[3], frag->ddx[4], -frag->ddx[3] - frag->ddx[4] };
+	float dy[3] = { frag->ddy[3], frag->ddy[4], -frag->ddy[3] - frag->ddy[4] };
+	float min_wire = FLT_MAX;
+	for (uint32_t i = 0; i < 3; i++) {
+		float wire = bary[i] / sqrtf(dx[i]*dx[i] + dy[i]*dy[i]);
+		min_wire = um_min(min_wire, wire);
+	}
+	float width = 1.2f * u->pixel_scale;
+	float wire = 1.0f - um_clamp(min_wire - (width - 1.0f), 0.0f, 1.0f);
+
+	float t = v[5] * um_lerp(wire, 1.0f, 0.3f);
+	color[0] = um_lerp(x, u->highlight_color.x, t);
+	color[1] = um_lerp(x, u->highlight_color.y, t);
+	color[2] = um_lerp(x, u->highlight_color.z, t);
+	color[3] = 1.0f;
+}
+
+static void vi_soft_shade_debug(float color[4], const sr_fragment *frag, const void *uniforms)
+{
+	memcpy(color, frag->varyings, 4 * sizeof(float));
+}
+
+static float vi_soft_sample_atlas(float u, float v)
+{
+	uint32_t extent = vig.icon_atlas_extent;
+	float fx = um_clamp(u * (float)extent - 0.5f, 0.0f, (float)extent - 1.0f);
+	float fy = um_clamp(v * (float)extent - 0.5f, 0.0f, (float)extent - 1.0f);
+	uint32_t x0 = (uint32_t)fx, y0 = (uint32_t)fy;
+	uint32_t x1 = x0 + 1 < extent ? x0 + 1 : x0;
+	uint32_t y1 = y0 + 1 < extent ? y0 + 1 : y0;
+	float tx = fx - (float)x0, ty = fy - (float)y0;
+	const uint8_t *p = vig.icon_atlas_cpu;
+	float a = um_lerp((float)p[y0 * extent + x0], (float)p[y0 * extent + x1], tx);
+	float b = um_lerp((float)p[y1 * extent + x0], (float)p[y1 * extent + x1], tx);
+	return um_lerp(a, b, ty) * (1.0f / 255.0f);
+}
+
+// Port of `icon_pixel` in `icon.glsl`
+static void vi_soft_shade_icon(float color[4], const sr_fragment *frag, const void *uniforms)
+{
+	const float *v = frag->varyings;
+	const float *th = v + 2, *col = v + 6, *outline = v + 10;
+
+	float sdf = 1.0f - vi_soft_sample_atlas(v[0], v[1]);
+	for (uint32_t i = 0; i < 4; i++) {
+		if (sdf < th[0]) {
+			color[i] = col[i];
+		} else if (sdf < th[1]) {
+			color[i] = um_lerp(col[i], outline[i], (sdf - th[0]) / (th[1] - th[0]));
+		} else if (sdf < th[2]) {
+			color[i] = outline[i];
+		} else if (sdf < th[3]) {
+			color[i] = um_lerp(outline[i], i < 3 ? outline[i] : 0.0f, (sdf - th[2]) / (th[3] - th[2]));
+		} else {
+			color[i] = 0.0f;
+		}
+	}
+}
+
+static void vi_soft_draw_meshes(sr_context *ctx, arena_t *arena, vi_scene *vs, const vi_desc *desc)
+{
+	vi_render_stats *stats = &vs->render_stats;
+
+	alist_t(vi_soft_draw) draws = { 0 };
+	for (size_t item_ix = 0; item_ix < vs->num_draw_items; item_ix++) {
+		const vi_draw_item *item = &vs->draw_items[item_ix];
+		ufbx_mesh *fbx_mesh = vs->fbx.meshes.data[item->mesh_ix];
+		vi_mesh *mesh = &vs->meshes[item->mesh_ix];
+		vi_part *part = &mesh->parts[item->part_ix];
+
+		if (!vs->draw_visible[item_ix]) {
+			stats->culled_draw_calls++;
+			continue;
+		}
+
+		ufbx_node *fbx_node = NULL;
+		if (item->node_ix != UINT32_MAX) {
+			fbx_node = vs->fbx.nodes.data[item->node_ix];
+		}
+
+		ufbx_material *fbx_material = NULL;
+		if (part->material_id < vs->fbx.materials.count) {
+			fbx_material = vs->fbx.materials.data[part->material_id];
+		}
+
+		vi_mesh_highlight hl = vi_get_mesh_highlight(vs, desc, fbx_mesh, fbx_node, fbx_material);
+		vi_soft_mesh_pixel pu = {
+			.highlight_color = hl.color,
+			.pixel_scale = vs->pixel_scale,
+		};
+		uint32_t state_id = sr_add_state(ctx, &(sr_state){
+			.shade = &vi_soft_shade_mesh,
+			.uniforms = &pu,
+			.uniforms_size = sizeof(pu),
+			.num_varyings = VI_SOFT_MESH_VARYINGS,
+			.derivatives = true,
+			.depth_func = SR_DEPTH_LESS_EQUAL,
+			.depth_write = true,
+			.cull_back = true,
+		});
+
+		size_t num_instances = mesh->instanced ? mesh->num_visible_instances : 1;
+		vi_soft_draw *dst = alist_push_n(arena, vi_soft_draw, &draws, num_instances);
+		for (size_t i = 0; i < num_instances; i++) {
+			vi_soft_draw *draw = &dst[i];
+			draw->mesh = mesh;
+			draw->part = part;
+			draw->hl = hl;
+			draw->state_id = state_id;
+			draw->vertices = aalloc_uninit(arena, sr_vertex, part->num_vertices);
+			if (mesh->instanced) {
+				const vi_instance *instance = &vs->instances[mesh->instance_offset + i];
+				draw->geometry_to_world = instance->geometry_to_world;
+				draw->highlight = hl.highlight + instance->highlight;
+			} else {
+				draw->geometry_to_world = vs->nodes[item->node_ix].geometry_to_world;
+				draw->highlight = hl.highlight;
+			}
+		}
+
+		if (mesh->instanced) {
+			stats->instanced_draw_calls++;
+		}
+		stats->draw_calls++;
+		stats->instances += (uint32_t)num_instances;
+		stats->triangles += part->num_indices / 3 * (uint32_t)num_instances;
+	}
+
+	vi_soft_draws task = { vs, draws.data };
+	tp_run(draws.count, &vi_soft_vertex_task, &task);
+
+	for (size_t i = 0; i < draws.count; i++) {
+		const vi_soft_draw *draw = &draws.data[i];
+		sr_draw(ctx, draw->state_id, draw->vertices, draw->part->cpu_indices, draw->part->num_indices);
+	}
+}
+
+static void vi_soft_draw_debug(sr_context *ctx, arena_t *arena)
+{
+	if (vig.debug_vertices.count > 0) {
+		sr_vertex *verts = aalloc_uninit(arena, sr_vertex, vig.debug_vertices.count);
+		for (size_t i = 0; i < vig.debug_vertices.count; i++) {
+			const vi_debug_vertex *src = &vig.debug_vertices.data[i];
+			verts[i].position = src->position;
+			verts[i].varyings[0] = (float)src->color.r * (1.0f / 255.0f);
+			verts[i].varyings[1] = (float)src->color.g * (1.0f / 255.0f);
+			verts[i].varyings[2] = (float)src->color.b * (1.0f / 255.0f);
+			verts[i].varyings[3] = (float)src->color.a * (1.0f / 255.0f);
+		}
+
+		// `debug_pipe` and `debug_pipe_post`: Draw visible lines and then faintly the occluded parts
+		uint32_t visible_state = sr_add_state(ctx, &(sr_state){
+			.shade = &vi_soft_shade_debug,
+			.num_varyings = VI_SOFT_DEBUG_VARYINGS,
+			.depth_func = SR_DEPTH_LESS_EQUAL,
+			.cull_back = true,
+			.stencil_once = true,
+		});
+		uint32_t occluded_state = sr_add_state(ctx, &(sr_state){
+			.shade = &vi_soft_shade_debug,
+			.num_varyings = VI_SOFT_DEBUG_VARYINGS,
+			.depth_func = SR_DEPTH_GREATER,
+			.cull_back = true,
+			.stencil_once = true,
+			.blend = SR_BLEND_CONSTANT_ALPHA,
+			.blend_alpha = 0.2f,
+		});
+
+		sr_draw(ctx, visible_state, verts, vig.debug_indices.data, vig.debug_indices.count);
+		sr_draw(ctx, occluded_state, verts, vig.debug_indices.data, vig.debug_indices.count);
+
+		vig.debug_vertices.count = 0;
+		vig.debug_indices.count = 0;
+	}
+
+	if (vig.icon_vertices.count > 0) {
+		sr_vertex *verts = aalloc_uninit(arena, sr_vertex, vig.icon_vertices.count);
+		for (size_t i = 0; i < vig.icon_vertices.count; i++) {
+			const vi_icon_vertex *src = &vig.icon_vertices.data[i];
+			float *v = verts[i].varyings;
+			verts[i].position = src->position;
+			v[0] = src->uv.x;
+			v[1] = src->uv.y;
+			const uint8_t *bytes[3] = { src->sdf_thresholds, &src->color.r, &src->outline_color.r };
+			for (size_t j = 0; j < 12; j++) {
+				v[2 + j] = (float)bytes[j / 4][j % 4] * (1.0f / 255.0f);
+			}
+		}
+
+		uint32_t state = sr_add_state(ctx, &(sr_state){
+			.shade = &vi_soft_shade_icon,
+			.num_varyings = VI_SOFT_ICON_VARYINGS,
+			.depth_func = SR_DEPTH_ALWAYS,
+			.cull_back = true,
+			.blend = SR_BLEND_SRC_ALPHA,
+		});
+		sr_draw(ctx, state, verts, vig.icon_indices.data, vig.icon_indices.count);
+
+		vig.icon_vertices.count = 0;
+		vig.icon_indices.count = 0;
+	}
+}
+
+// Render to `vig.soft_targets[target->target_index]` without touching the GPU.
+// Multisampling is ignored and the postprocess pass is a plain copy so it's skipped.
+static void vi_render_software(vi_scene *vs, const vi_target *target, const vi_desc *desc)
+{
+	if (target->width == 0 || target->height == 0) return;
+	sr_target *dst = vi_get_soft_target(target->target_index, target->width, target->height);
+
+	arena_t tmp;
+	arena_init(&tmp, NULL);
+
+	const float clear_color[4] = { 0.2f, 0.2f, 0.3f, 1.0f };
+	sr_clear(dst, clear_color, 1.0f);
+
+	sr_context *ctx = sr_begin(&tmp, dst);
+	vi_soft_draw_meshes(ctx, &tmp, vs, desc);
+	vi_draw_widgets(NULL, vs, desc);
+	vi_soft_draw_debug(ctx, &tmp);
+	sr_flush(ctx);
+
+	arena_free(&tmp);
+}
+
 static void ad_free_ufbx_scene(void *user) { ufbx_free_scene(*(ufbx_scene**)user); }
 
-static void vi_update(vi_scene *vs, const vi_target *target, const vi_desc *desc)
+// Hash the property overrides by value, the caller re-creates the list every frame
+static uint64_t vi_hash_overrides(const ufbx_prop_override *overrides, size_t num_overrides)
 {
-	float aspect = (float)target->width / (float)target->height;
+	uint64_t h = UINT64_C(0xcbf29ce484222325);
+	h = vi_hash_u64(h, num_overrides);
+	for (size_t i = 0; i < num_overrides; i++) {
+		const ufbx_prop_override *over = &overrides[i];
+		h = vi_hash_u64(h, over->element_id);
+		h = vi_hash_str(h, over->prop_name);
+		h = vi_hash_bytes(h, &over->value, sizeof(over->value));
+		h = vi_hash_str(h, over->value_str);
+		h = vi_hash_u64(h, (uint64_t)over->value_int);
+	}
+	return h;
+}
+
+static bool vi_str_equal(const char *a, const char *b)
+{
+	if (!a || !b) return a == b;
+	return !strcmp(a, b);
+}
+
+static bool vi_overrides_equal(const ufbx_prop_override *a, const ufbx_prop_override *b, size_t num_overrides)
+{
+	for (size_t i = 0; i < num_overrides; i++) {
+		if (a[i].element_id != b[i].element_id) return false;
+		if (!vi_str_equal(a[i].prop_name, b[i].prop_name)) return false;
+		if (memcmp(&a[i].value, &b[i].value, sizeof(ufbx_vec3)) != 0) return false;
+		if (!vi_str_equal(a[i].value_str, b[i].value_str)) return false;
+		if (a[i].value_int != b[i].value_int) return false;
+	}
+	return true;
+}
+
+static void vi_store_overrides(vi_scene *vs, const ufbx_prop_override *overrides, size_t num_overrides)
+{
+	for (size_t i = 0; i < vs->num_state_overrides; i++) {
+		afree(vs->arena, (void*)vs->state_overrides[i].prop_name);
+		afree(vs->arena, (void*)vs->state_overrides[i].value_str);
+	}
+	afree(vs->arena, vs->state_overrides);
+
+	vs->state_overrides = aalloc_copy(vs->arena, ufbx_prop_override, num_overrides, overrides);
+	vs->num_state_overrides = num_overrides;
+	for (size_t i = 0; i < num_overrides; i++) {
+		ufbx_prop_override *over = &vs->state_overrides[i];
+		if (over->prop_name) over->prop_name = aalloc_copy_str(vs->arena, over->prop_name);
+		if (over->value_str) over->value_str = aalloc_copy_str(vs->arena, over->value_str);
+	}
+}
+
+// Evaluate the scene at `desc->time`, returns false if the previous state is still valid
+static bool vi_evaluate(vi_scene *vs, const vi_desc *desc)
+{
+	// The hash rejects most changes cheaply, matching lists are compared exactly
+	// so that a collision can't keep a stale evaluation.
+	uint64_t overrides_hash = vi_hash_overrides(desc->overrides, desc->num_overrides);
+	bool same_overrides = vs->fbx_state && vs->state_overrides_hash == overrides_hash
+		&& vs->num_state_overrides == desc->num_overrides
+		&& vi_overrides_equal(vs->state_overrides, desc->overrides, desc->num_overrides);
+	if (same_overrides && vs->state_time == desc->time) {
+		return false;
+	}
 
 	ufbx_anim anim = vs->fbx.anim;
 	anim.prop_overrides.data = desc->overrides;
 	anim.prop_overrides.count = desc->num_overrides;
 
-	// TODO: Cache
+	ufbx_scene *fbx_state = ufbx_evaluate_scene(vs->fbx_source, &anim, desc->time, NULL, NULL);
+	if (!fbx_state) return false;
+
 	if (vs->fbx_state) {
 		arena_cancel(vs->arena, vs->fbx_state_defer, true);
 	}
-	ufbx_scene *fbx_state = ufbx_evaluate_scene(&vs->fbx, &anim, desc->time, NULL, NULL);
 	vs->fbx_state = fbx_state;
 	vs->fbx_state_defer = arena_defer(vs->arena, ad_free_ufbx_scene, ufbx_scene*, &vs->fbx_state);
+	vs->state_time = desc->time;
+	if (!same_overrides) {
+		vs->state_overrides_hash = overrides_hash;
+		vi_store_overrides(vs, desc->overrides, desc->num_overrides);
+	}
+
+	for (size_t i = 0; i < vs->fbx.nodes.count; i++) {
+		ufbx_node *fbx_node = fbx_state->nodes.data[i];
+		vi_node *node = &vs->nodes[i];
+		node->node_to_world = fbx_to_um_mat(fbx_node->node_to_world);
+		node->geometry_to_world = fbx_to_um_mat(fbx_node->geometry_to_world);
+	}
 
+	if (vi_update_globals(vs, fbx_state)) {
+		vs->render_stats.global_buffer_uploads++;
+	}
+	return true;
+}
+
+static void vi_update(vi_scene *vs, const vi_target *target, const vi_desc *desc)
+{
+	float aspect = (float)target->width / (float)target->height;
+
+	if (vi_evaluate(vs, desc)) {
+		vs->render_stats.evaluations++;
+	}
+
+	vs->has_view = true;
+	vs->camera_pos = desc->camera_pos;
 	vs->world_to_view = um_mat_look_at(desc->camera_pos, desc->camera_target, um_v3(0,1,0));
 	vs->view_to_clip = vi_mat_perspective(desc->field_of_view * UM_DEG_TO_RAD, aspect, desc->near_plane, desc->far_plane);
 	vs->world_to_clip = um_mat_mulrev(vs->world_to_view, vs->view_to_clip);
@@ -1495,22 +3274,28 @@ static void vi_update(vi_scene *vs, const vi_target *target, const vi_desc *desc
 	vs->pixel_size.x = 1.0f / (float)target->width * target->pixel_scale;
 	vs->pixel_size.y = 1.0f / (float)target->height * target->pixel_scale;
 
-	for (size_t i = 0; i < vs->fbx.nodes.count; i++) {
-		ufbx_node *fbx_node = fbx_state->nodes.data[i];
-		vi_node *node = &vs->nodes[i];
-		node->node_to_world = fbx_to_um_mat(fbx_node->node_to_world);
-		node->geometry_to_world = fbx_to_um_mat(fbx_node->geometry_to_world);
-	}
+	vi_update_instances(vs, desc);
+	vi_update_visibility(vs);
+}
 
-	vi_update_globals(vs, fbx_state);
+void vi_set_view(vi_scene *vs, const vi_target *target, const vi_desc *desc)
+{
+	vi_update(vs, target, desc);
 }
 
 void vi_render(vi_scene *vs, const vi_target *target, const vi_desc *desc)
 {
 	assert(target->target_index < MAX_FRAMEBUFFERS);
 
+	memset(&vs->render_stats, 0, sizeof(vs->render_stats));
 	vi_update(vs, target, desc);
 
+	if (vig.software) {
+		vi_render_software(vs, target, desc);
+		sg_commit();
+		return;
+	}
+
 	vi_framebuffer *render_fb = &vig.render_buffer;
 	vi_framebuffer *dst_fb = &vig.framebuffers[target->target_index];
 
@@ -1561,8 +3346,38 @@ void vi_render(vi_scene *vs, const vi_target *target, const vi_desc *desc)
 	sg_commit();
 }
 
+vi_render_stats vi_get_render_stats(vi_scene *vs)
+{
+	return vs->render_stats;
+}
+
+bool vi_get_scene_bounds(vi_scene *vs, um_vec3 *p_min, um_vec3 *p_max)
+{
+	um_vec3 min = um_dup3(FLT_MAX), max = um_dup3(-FLT_MAX);
+	for (size_t mesh_ix = 0; mesh_ix < vs->fbx.meshes.count; mesh_ix++) {
+		ufbx_mesh *fbx_mesh = vs->fbx.meshes.data[mesh_ix];
+		const vi_mesh *mesh = &vs->meshes[mesh_ix];
+		if (!(mesh->bounds.min.x <= mesh->bounds.max.x)) continue;
+		for (size_t i = 0; i < fbx_mesh->instances.count; i++) {
+			const vi_node *node = &vs->nodes[fbx_mesh->instances.data[i]->typed_id];
+			vi_add_mesh_world_bounds(vs, mesh, node, mesh->bounds.min, mesh->bounds.max, &min, &max);
+		}
+	}
+
+	if (!(min.x <= max.x)) {
+		*p_min = *p_max = um_zero3;
+		return false;
+	}
+	*p_min = min;
+	*p_max = max;
+	return true;
+}
+
 void vi_present(uint32_t target_index, uint32_t width, uint32_t height)
 {
+	// Nothing to present to without a GPU, use `vi_get_pixels()` instead
+	if (vig.software) return;
+
 	vi_framebuffer *src_fb = &vig.framebuffers[target_index];
 
 	sg_begin_default_pass(&(sg_pass_action){
@@ -1576,6 +3391,15 @@ void vi_present(uint32_t target_index, uint32_t width, uint32_t height)
 
 bool vi_get_pixels(uint32_t target_index, uint32_t width, uint32_t height, void *dst)
 {
+	if (vig.software) {
+		const sr_target *src = &vig.soft_targets[target_index];
+		if (!src->color || width > src->width || height > src->height) return false;
+		for (uint32_t y = 0; y < height; y++) {
+			memcpy((char*)dst + (size_t)y * width * 4, src->color + (size_t)y * src->width * 4, (size_t)width * 4);
+		}
+		return true;
+	}
+
 #if HAS_GL
 	vi_framebuffer *src_fb = &vig.framebuffers[target_index];
 	sg_pass_info info = sg_query_pass_info(src_fb->pass);
@@ -28,13 +28,113 @@ typedef struct vi_desc {
 	size_t num_overrides;
 } vi_desc;
 
+typedef struct vi_part_stats {
+	uint32_t mesh_element_id;
+	uint32_t material_id;
+	uint32_t num_indices;
+	uint32_t num_vertices;
+
+	// Post-transform vertex cache efficiency, see `vertex_cache.h`
+	float acmr;
+	float atvr;
+	float original_acmr;
+	float original_atvr;
+
+	// Bytes per vertex and worst quantization error if using compact vertices
+	uint32_t vertex_size;
+	float max_position_error;
+	float max_normal_error;
+} vi_part_stats;
+
+typedef struct vi_pick_result {
+	uint32_t mesh_element_id;
+	uint32_t node_element_id;
+	uint32_t face_index;
+	uint32_t index;      // Mesh index of the corner closest to the hit
+	uint32_t indices[3]; // Mesh indices of the hit triangle
+	um_vec3 barycentric;
+	um_vec3 position;
+	float distance;
+} vi_pick_result;
+
+typedef struct vi_render_stats {
+	uint32_t draw_calls;           // Mesh `sg_draw()` calls, including instanced ones
+	uint32_t instanced_draw_calls; // Draws covering multiple instances of a mesh
+	uint32_t instances;            // Mesh instances drawn (per part)
+	uint32_t triangles;
+
+	// Frustum culled draws (per part) and mesh instances entirely outside the view
+	uint32_t culled_draw_calls;
+	uint32_t culled_instances;
+
+	// State changes actually submitted for meshes, redundant ones are skipped
+	uint32_t pipeline_changes;
+	uint32_t binding_changes;
+	uint32_t uniform_changes;      // Vertex and fragment blocks counted separately
+
+	// Scene evaluations, zero if the time and overrides matched the previous frame
+	uint32_t evaluations;
+	uint32_t global_buffer_uploads; // Skipped if no skin cluster or blend weight changed
+} vi_render_stats;
+
+typedef struct vi_scene_opts {
+	// Store vertices as quantized `vi_compact_vertex` (16 bytes) instead of floats (28 bytes)
+	bool compact_vertices;
+	// Reorder triangles and vertices of mesh parts for vertex cache and fetch locality,
+	// makes building meshes slower in exchange for faster drawing
+	bool optimize_vertex_cache;
+} vi_scene_opts;
+
+typedef struct vi_mesh_cache_stats {
+	size_t hits;
+	size_t misses;
+	size_t evictions;
+	size_t num_entries;
+	size_t memory_used;
+	size_t memory_budget;
+} vi_mesh_cache_stats;
+
+// Bytes owned by a `vi_scene`, mesh data shared through the mesh cache is not included
+typedef struct vi_scene_memory {
+	size_t cpu;
+	size_t gpu;
+} vi_scene_memory;
+
+#define VI_DEFAULT_MESH_CACHE_BUDGET ((size_t)256 * 1024 * 1024)
+
 void vi_setup();
 void vi_shutdown();
 void vi_free_targets();
 
-vi_scene *vi_make_scene(const ufbx_scene *fbx_scene);
+// `fbx_scene` is referenced by the returned scene and must outlive it
+vi_scene *vi_make_scene(const ufbx_scene *fbx_scene, const vi_scene_opts *opts);
 void vi_free_scene(vi_scene *scene);
 
+// CPU side mesh data is cached between `vi_make_scene()` calls up to a budget in bytes
+void vi_set_mesh_cache_budget(size_t budget);
+void vi_clear_mesh_cache();
+vi_mesh_cache_stats vi_get_mesh_cache_stats();
+
+vi_scene_memory vi_get_scene_memory(vi_scene *scene);
+
+// Evaluate the scene and set up the view of `desc` without rendering anything,
+// `vi_render()` does the same implicitly.
+void vi_set_view(vi_scene *scene, const vi_target *target, const vi_desc *desc);
+
+// Raycast through clip space `x`, `y` (-1 to 1, Y up) using the view of the last
+// `vi_render()` or `vi_set_view()`. Meshes are tested in their evaluated node
+// transforms but without skinning or blend shapes. Picking BVHs are built with
+// the rest of the mesh data in `vi_make_scene()`.
+bool vi_pick(vi_scene *scene, float x, float y, vi_pick_result *result);
+
+// Returns the total number of parts, writes up to `max_stats` of them to `stats`
+size_t vi_get_part_stats(vi_scene *scene, vi_part_stats *stats, size_t max_stats);
+
 void vi_render(vi_scene *scene, const vi_target *target, const vi_desc *desc);
+vi_render_stats vi_get_render_stats(vi_scene *scene);
+
+// World space bounds of all mesh instances in the last rendered pose, or the
+// initial pose before the first render. Returns false if there are no meshes.
+bool vi_get_scene_bounds(vi_scene *scene, um_vec3 *min, um_vec3 *max);
 void vi_present(uint32_t target_index, uint32_t width, uint32_t height);
 bool vi_get_pixels(uint32_t target_index, uint32_t width, uint32_t height, void *dst);
@@ -3,6 +3,7 @@
 #include <stdio.h>
 #include "json_rpc.h"
 #include "external/json_output.h"
+#include "external/json_input.h"
 #include "external/sokol_config.h"
 #include "external/sokol_gfx.h"
 #include "external/sokol_app.h"
@@ -10,9 +11,11 @@
 #include "external/umath.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 static char **g_argv;
 static int g_argc;
+static bool g_loading = false;
 
 static jso_stream begin_request(const char *cmd)
 {
@@ -24,11 +27,11 @@ static jso_stream begin_request(const char *cmd)
     return s;
 }
 
-static char *submit_request(jso_stream *s)
+static const char *submit_request(jso_stream *s)
 {
 	jso_end_object(s);
 	char *json = jso_close_growable(s);
-	return rpc_call(json);
+	return rpc_call(json, NULL);
 }
 
 void init(void)
@@ -41,7 +44,7 @@ void init(void)
         jso_stream s = begin_request("init");
         jso_prop_boolean(&s, "pretty", true);
         jso_prop_boolean(&s, "verbose", false);
-        free(submit_request(&s));
+        submit_request(&s);
     }
 
     if (g_argc > 1) {
@@ -55,15 +58,41 @@ void init(void)
         fread(data, 1, size, f);
         fclose(f);
 
-        jso_stream s = begin_request("loadScene");
+        // Parsed on a background thread that takes ownership of `data`, see `poll_scene()`
+        jso_stream s = begin_request("loadSceneAsync");
         jso_prop_string(&s, "name", "main");
         jso_prop_int64(&s, "dataPointer", (int64_t)(intptr_t)data);
         jso_prop_int64(&s, "size", (int64_t)size);
-        char *result = submit_request(&s);
+        submit_request(&s);
+        g_loading = true;
+    }
+}
 
-        free(result);
-        free(data);
+// Show the loading progress in the title until the scene has loaded
+static void poll_scene(void)
+{
+    jso_stream s = begin_request("pollScene");
+    jso_prop_string(&s, "sceneName", "main");
+    const char *result = submit_request(&s);
+
+    jsi_value *value = jsi_parse_string(result, NULL);
+    jsi_obj *obj = jsi_as_obj(value);
+    const char *state = jsi_get_str(obj, "state", "error");
+    if (!strcmp(state, "loading")) {
+        double read = jsi_get_double(obj, "bytesRead", 0.0);
+        double total = jsi_get_double(obj, "bytesTotal", 1.0);
+        char title[128];
+        snprintf(title, sizeof(title), "UFBX Viewer - Loading %.0f%%", total > 0.0 ? read / total * 100.0 : 0.0);
+        sapp_set_window_title(title);
+    } else {
+        if (!strcmp(state, "error")) {
+            fprintf(stderr, "%s\n", jsi_get_str(obj, "error", "Failed to load scene"));
+        }
+        sapp_set_window_title("UFBX Viewer");
+        g_loading = false;
     }
+
+    jsi_free(value);
 }
 
 static void serialize_vec3(jso_stream *s, um_vec3 v)
@@ -112,11 +141,11 @@ void event(const sapp_event *ev)
             if (ev->key_code == SAPP_KEYCODE_T) {
 				jso_stream s = begin_request("freeResources");
 				jso_prop_boolean(&s, "targets", true);
-				free(submit_request(&s));
+				submit_request(&s);
             } else if (ev->key_code == SAPP_KEYCODE_R) {
 				jso_stream s = begin_request("freeResources");
 				jso_prop_boolean(&s, "scenes", true);
-				free(submit_request(&s));
+				submit_request(&s);
             }
         }
         break;
@@ -132,12 +161,16 @@ void frame(void)
     int width = sapp_width();
     int height = sapp_height();
 
+    if (g_loading) {
+        poll_scene();
+    }
+
 #if 0
     {
 		jso_stream s = begin_request("freeResources");
 		jso_prop_boolean(&s, "targets", true);
 		jso_prop_boolean(&s, "scenes", true);
-		free(submit_request(&s));
+		submit_request(&s);
     }
 #endif
 
@@ -186,7 +219,7 @@ void frame(void)
 
 		jso_end_object(&s); // desc
 
-		free(submit_request(&s));
+		submit_request(&s);
     }
 
     {
@@ -194,7 +227,7 @@ void frame(void)
         jso_prop_int(&s, "targetIndex", 0);
         jso_prop_int(&s, "width", width);
         jso_prop_int(&s, "height", height);
-		free(submit_request(&s));
+		submit_request(&s);
     }
 }
 
@@ -1,7 +1,7 @@
 import { h, Fragment, useRef, useEffect, unwrap, immutable } from "kaiku"
 import { getTime } from "../common"
 import { mad3, cross3, normalize3, v3, add3 } from "../common/vec3"
-import { renderViewer, removeViewer, queryResolution, addSceneInfoListener } from "../viewer/viewer"
+import { renderViewer, removeViewer, queryResolution, addSceneInfoListener, getSceneTable, pickViewer } from "../viewer/viewer"
 import { beginDrag, buttonToButtons } from "./global-drag"
 import globalState from "./global-state"
 
@@ -15,7 +15,6 @@ function yawPitch(yaw, pitch, radius=1) {
 
 function stateToDesc(state) {
     const { camera, animation, fieldOverrides } = state
-    const info = globalState.infos[state.scene]
 
     const yaw = camera.yaw * (Math.PI/180.0)
     const pitch = camera.pitch * (Math.PI/180.0)
@@ -25,13 +24,14 @@ function stateToDesc(state) {
     const target = camera.offset
     const position = add3(target, delta)
 
+    const table = getSceneTable(state.scene)
     const overrides = []
 
     for (const key in fieldOverrides) {
         const value = fieldOverrides[key]
         const [elementIdStr, name] = key.split(".", 2)
         const elementId = parseInt(elementIdStr)
-        const type = info.elements[elementId].type
+        const type = table?.element(elementId)?.type
         if (type === "node") {
             if (name === "translation") {
                 overrides.push({ elementId, name: "Lcl Translation", value: [value.x, value.y, value.z] })
@@ -197,6 +197,21 @@ export default function FbxViewer({ id }) {
         }
     }
 
+    // Double click selects the mesh under the cursor and highlights the closest
+    // corner of the hit face, double clicking empty space clears the selection.
+    const doubleClick = (e) => {
+        const rect = ref.current.getBoundingClientRect()
+        const hit = pickViewer(id, e.clientX - rect.left, e.clientY - rect.top)
+        if (hit) {
+            state.selectedElement = hit.elementId
+            state.highlightVertexIndex = hit.index
+        } else {
+            state.selectedElement = -1
+            state.highlightVertexIndex = -1
+        }
+        e.preventDefault()
+    }
+
     useEffect(() => () => removeViewer(id))
 
     useEffect(() => {
@@ -209,6 +224,7 @@ export default function FbxViewer({ id }) {
         class="ufbx-viewer ufbx-canvas-container"
         ref={ref}
         onMouseDown={mouseDown}
+        onDblClick={doubleClick}
         onWheel={wheel}
     ></div>
 }
@@ -1,9 +1,11 @@
 import globalState from "./global-state"
 import { h, Fragment } from "kaiku"
 import { elementTypeCategory, typeToIconUrl } from "./common"
+import { getSceneTable } from "../viewer/viewer"
 
-function TreeNode({ state, info, id, level=0 }) {
-    const element = info.elements[id]
+function TreeNode({ state, table, id, level=0 }) {
+    const element = table.element(id)
+    if (!element) return null
     const icon = typeToIconUrl(element.type)
     const padding = `${level}em`
 
@@ -57,23 +59,24 @@ function TreeNode({ state, info, id, level=0 }) {
             <span className="ol-type">{element.type}</span>
         </div>
         <ul className="ol-list ol-nested">
-            {children.map(c => <TreeNode state={state} info={info} id={c} level={level+1} />)}
+            {children.map(c => <TreeNode state={state} table={table} id={c} level={level+1} />)}
         </ul>
     </li>
 }
 
 export default function Outliner({ id }) {
     const state = globalState.scenes[id]
-    const info = globalState.infos[state.scene]
-    if (!info) return null
-    const rootId = info.rootNode
+    if (!globalState.infos[state.scene]) return null
+    const table = getSceneTable(state.scene)
+    if (!table) return null
+    const rootId = table.rootNode
     return <div className="ol-top">
         <ul className="ol-list" role="tree">{
             state.outliner.includeRoot ? (
-                <TreeNode state={state} info={info} id={rootId} />
+                <TreeNode state={state} table={table} id={rootId} />
             ) : (
-                info.elements[rootId].children.map(c => 
-                    <TreeNode state={state} info={info} id={c} />)
+                table.element(rootId).children.map(c => 
+                    <TreeNode state={state} table={table} id={c} />)
             )
         }</ul>
     </div>
@@ -2,6 +2,7 @@ import { h, Fragment, useState, useRef, useEffect } from "kaiku"
 import { typeToIconUrl } from "./common"
 import { beginDrag, buttonToButtons } from "./global-drag"
 import { deepEqual, getTime } from "../common"
+import { getSceneElement, getSceneProps } from "../viewer/viewer"
 
 function getField(ctx, name) {
     const { state, info, elementId } = ctx
@@ -9,13 +10,13 @@ function getField(ctx, name) {
     if (override) {
         return { value: override, override: true }
     }
-    return { value: info.elements[elementId].fields[name], override: false }
+    return { value: getSceneElement(state.scene, elementId).fields[name], override: false }
 }
 
 function setField(ctx, name, value) {
     const { state, info, elementId } = ctx
     const key = `${elementId}.${name}`
-    if (state.fieldOverrides.hasOwnProperty(key) || !deepEqual(value, info.elements[elementId].fields[name])) {
+    if (state.fieldOverrides.hasOwnProperty(key) || !deepEqual(value, getSceneElement(state.scene, elementId).fields[name])) {
         state.fieldOverrides[key] = value
         state.latestInteractionTime = getTime()
     }
@@ -34,7 +35,7 @@ function getProp(ctx, index) {
     if (override) {
         return { value: override, override: true }
     }
-    return { value: info.elements[elementId].props[index].value, override: false }
+    return { value: getSceneProps(state.scene, elementId)[index].value, override: false }
 }
 
 function setProp(ctx, index, value) {
@@ -311,8 +312,8 @@ function CameraSheet({ ctx }) {
 }
 
 function MeshSheet({ ctx }) {
-    const { info, elementId } = ctx
-    const elem = info.elements[elementId]
+    const { state, elementId } = ctx
+    const elem = getSceneElement(state.scene, elementId)
     return <>
         <Label name="faces" text={elem.numFaces} />
         <Label name="vertices" text={elem.numVertices} />
@@ -339,7 +340,8 @@ export default function PropertySheet({ id }) {
     if (state.selectedElement < 0) return null
 
     const elementId = state.selectedElement
-    const element = info.elements[elementId]
+    const element = getSceneElement(state.scene, elementId)
+    if (!element) return null
     const Sheet = sheetByType[element.type] ?? NullSheet
 
     const ctx = {
@@ -1,24 +1,21 @@
-import { h, Fragment, useState, useEffect } from "kaiku"
+import { h, Fragment } from "kaiku"
 import VirtualTable from "./virtual-table"
-import { rpcCall } from "../viewer/rpc"
+import { getSceneElement, getVertexPage, vertexPageSize } from "../viewer/viewer"
 
-function vec3ToString(v) {
-    const x = v.x.toFixed(2)
-    const y = v.y.toFixed(2)
-    const z = v.z.toFixed(2)
+function vec3ToString(v, i) {
+    if (!v) return "-"
+    const x = v[i*3+0].toFixed(2)
+    const y = v[i*3+1].toFixed(2)
+    const z = v[i*3+2].toFixed(2)
     return `(${x}, ${y}, ${z})`
 }
 
 function VertexRow({ viewerId, sceneName, elementId, index }) {
-    const state = useState({ row: null })
-    useEffect(() => {
-        state.row = rpcCall({
-            cmd: "getVertex",
-            sceneName, elementId, index,
-        })
-    })
-    if (!state.row) return null
-    const { vertexIndex, position, normal, uv } = state.row
+    const pageIndex = Math.floor(index / vertexPageSize)
+    const page = getVertexPage(sceneName, elementId, pageIndex)
+    if (!page) return null
+    const i = index - page.begin
+    if (i < 0 || i >= page.count) return null
 
     function onMouseOver() {
         const state = globalState.scenes[viewerId]
@@ -27,9 +24,9 @@ function VertexRow({ viewerId, sceneName, elementId, index }) {
 
     return <div className="vw-row" onMouseOver={onMouseOver}>
         <div className="vw-index">{index}</div>
-        <div className="vw-index">{vertexIndex}</div>
-        <div className="vw-cell">{vec3ToString(position)}</div>
-        <div className="vw-cell">{vec3ToString(normal)}</div>
+        <div className="vw-index">{page.vertexIndex[i]}</div>
+        <div className="vw-cell">{vec3ToString(page.position, i)}</div>
+        <div className="vw-cell">{vec3ToString(page.normal, i)}</div>
     </div>
 }
 
@@ -39,8 +36,8 @@ export default function VertexDisplay({ id }) {
     if (!state) return null
     const { selectedElement } = state
     if (selectedElement < 0) return null
-    const element = info.elements[selectedElement]
-    if (element.type !== "mesh") return null
+    const element = getSceneElement(state.scene, selectedElement)
+    if (!element || element.type !== "mesh") return null
     console.log(element)
     const { numIndices } = element
 
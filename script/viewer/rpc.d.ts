@@ -3,7 +3,14 @@ export function rpcSetup(): void
 export function rpcReload(): void
 export function rpcDestroy(): void
 export function rpcCall(input: any): any
+export function rpcCallBatch(inputs: any[]): any[]
+export function rpcRender(target: any, desc: any): boolean
+export function rpcPresent(targetIndex: number, width: number, height: number): boolean
+export function rpcGetPixels(targetIndex: number, width: number, height: number): number
 export function rpcMemory(): ArrayBuffer
 export function rpcHeapU8(): Uint8Array
 export function rpcGl(): WebGL2RenderingContext
-export function rpcLoadScene(name: string, buffer: ArrayBuffer): any
\ No newline at end of file
+export function rpcHasThreads(): boolean
+export function rpcLoadScene(name: string, buffer: ArrayBuffer): any
+export function rpcLoadSceneAsync(name: string, buffer: ArrayBuffer): any
+export function rpcPollScene(name: string): any
@@ -29,19 +29,23 @@ export function rpcDestroy()
     Module._js_destroy_context()
 }
 
-export function rpcCall(input)
+function rpcCallJson(input)
 {
-    // console.log(">", input)
     const inStr = JSON.stringify(input)
     const inSize = inStr.length * 4 + 1
     const inPtr = Module._malloc(inSize)
     stringToUTF8(inStr, inPtr, inSize)
 
+    // The response is owned by the native side and reused by the next call
     const outPtr = Module._js_rpc(inPtr)
+    const outStr = UTF8ToString(outPtr, Module._js_rpc_response_length())
+    return JSON.parse(outStr)
+}
 
-    const outStr = UTF8ToString(outPtr)
-    Module._free(outPtr)
-    const output = JSON.parse(outStr)
+export function rpcCall(input)
+{
+    // console.log(">", input)
+    const output = rpcCallJson(input)
     // console.log("<", output)
 
     if (output.error) {
@@ -51,6 +55,149 @@ export function rpcCall(input)
     return output
 }
 
+// Run multiple commands in one call, returns an array of outputs in the same order
+export function rpcCallBatch(inputs)
+{
+    if (inputs.length === 0) return []
+    const output = rpcCallJson(inputs)
+
+    // The whole batch fails if the request can't be parsed
+    const outputs = Array.isArray(output) ? output : inputs.map(() => output)
+    for (const output of outputs) {
+        if (output.error) {
+            console.error(output.error)
+        }
+    }
+
+    return outputs
+}
+
+// Binary commands for per-frame calls, layouts must match `rpc_bin_*` in native/viewer/json_rpc.h
+const RPC_BIN_RENDER = 1
+const RPC_BIN_PRESENT = 2
+const RPC_BIN_GET_PIXELS = 3
+
+const RPC_BIN_RENDER_SIZE = 152
+const RPC_BIN_TARGET_SIZE = 40
+const RPC_BIN_OVERRIDE_SIZE = 20
+
+let binPtr = 0
+let binCapacity = 0
+
+function binReserve(size)
+{
+    if (size > binCapacity) {
+        if (binPtr) Module._free(binPtr)
+        binCapacity = Math.max(size, binCapacity * 2, 1024)
+        binPtr = Module._malloc(binCapacity)
+        if (!binPtr) throw new Error("Out of memory!")
+    }
+}
+
+// Needs to be re-created after every call as the wasm memory may have grown
+function binView()
+{
+    return new DataView(HEAPU8.buffer, binPtr, binCapacity)
+}
+
+function binWriteString(offset, str)
+{
+    const written = stringToUTF8(str, binPtr + offset, binCapacity - offset)
+    return offset + written + 1
+}
+
+function binCall(cmd, size)
+{
+    const view = binView()
+    view.setUint32(0, cmd, true)
+    view.setUint32(4, size, true)
+
+    const errorPtr = Module._js_rpc_binary(binPtr)
+    if (errorPtr) {
+        const output = JSON.parse(UTF8ToString(errorPtr))
+        console.error(output.error)
+        return null
+    }
+    return binView()
+}
+
+function binTarget(cmd, targetIndex, width, height)
+{
+    binReserve(RPC_BIN_TARGET_SIZE)
+    const view = binView()
+    view.setUint32(16, targetIndex, true)
+    view.setUint32(20, width, true)
+    view.setUint32(24, height, true)
+    return binCall(cmd, RPC_BIN_TARGET_SIZE)
+}
+
+export function rpcRender(target, desc)
+{
+    const camera = desc.camera ?? { }
+    const position = camera.position ?? { x: 4, y: 4, z: 4 }
+    const cameraTarget = camera.target ?? { x: 0, y: 0, z: 0 }
+    const overrides = desc.overrides ?? []
+
+    // Strings are written after the overrides, reserve the worst case UTF-8 size
+    const overridesOffset = RPC_BIN_RENDER_SIZE
+    let size = overridesOffset + overrides.length * RPC_BIN_OVERRIDE_SIZE + desc.sceneName.length * 4 + 1
+    for (const override of overrides) {
+        size += override.name.length * 4 + 1
+    }
+    binReserve(size)
+
+    const view = binView()
+    view.setUint32(16, target.targetIndex ?? 0, true)
+    view.setUint32(20, target.width ?? 256, true)
+    view.setUint32(24, target.height ?? 256, true)
+    view.setUint32(28, target.samples ?? 1, true)
+    view.setFloat32(32, target.pixelScale ?? 1.0, true)
+    view.setFloat32(40, position.x, true)
+    view.setFloat32(44, position.y, true)
+    view.setFloat32(48, position.z, true)
+    view.setFloat32(52, cameraTarget.x, true)
+    view.setFloat32(56, cameraTarget.y, true)
+    view.setFloat32(60, cameraTarget.z, true)
+    view.setFloat32(64, camera.fieldOfView ?? 50.0, true)
+    view.setFloat32(68, camera.nearPlane ?? 0.01, true)
+    view.setFloat32(72, camera.farPlane ?? 100.0, true)
+    view.setInt32(76, desc.selectedElement ?? -1, true)
+    view.setInt32(80, desc.highlightVertexIndex ?? -1, true)
+    view.setUint32(84, overrides.length, true)
+    view.setUint32(88, overridesOffset, true)
+    view.setFloat64(96, desc.animation?.time ?? 0.0, true)
+
+    let offset = overridesOffset + overrides.length * RPC_BIN_OVERRIDE_SIZE
+    view.setUint32(36, offset, true)
+    offset = binWriteString(offset, desc.sceneName)
+
+    for (let i = 0; i < overrides.length; i++) {
+        const { elementId, name, value } = overrides[i]
+        const base = overridesOffset + i * RPC_BIN_OVERRIDE_SIZE
+        const values = Array.isArray(value) ? value : [value, 0, 0]
+        view.setUint32(base + 0, elementId, true)
+        view.setUint32(base + 4, offset, true)
+        view.setFloat32(base + 8, values[0] ?? 0, true)
+        view.setFloat32(base + 12, values[1] ?? 0, true)
+        view.setFloat32(base + 16, values[2] ?? 0, true)
+        offset = binWriteString(offset, name)
+    }
+
+    return binCall(RPC_BIN_RENDER, offset) !== null
+}
+
+export function rpcPresent(targetIndex, width, height)
+{
+    return binTarget(RPC_BIN_PRESENT, targetIndex, width, height) !== null
+}
+
+// Returns a pointer to the pixels in wasm memory or 0 on failure
+export function rpcGetPixels(targetIndex, width, height)
+{
+    const view = binTarget(RPC_BIN_GET_PIXELS, targetIndex, width, height)
+    return view ? view.getUint32(32, true) : 0
+}
+
 export function rpcMemory()
 {
     return HEAPU8.buffer
@@ -75,3 +222,25 @@ export function rpcLoadScene(name, buffer) {
     Module._free(dataPointer)
     return scene.scene
 }
+
+// Threaded builds (`VIEWER_THREADS`) run on shared wasm memory, which browsers
+// only allow on cross-origin isolated pages.
+export function rpcHasThreads() {
+    return typeof SharedArrayBuffer !== "undefined" && HEAPU8.buffer instanceof SharedArrayBuffer
+}
+
+// Parses the scene on a background thread, poll with `rpcPollScene()`. The native
+// side takes ownership of the copy. Without threads, see `rpcHasThreads()`, the
+// scene is parsed before this returns, blocking like `rpcLoadScene()`. The default
+// web build is not threaded, so prefer `rpcLoadScene()` there.
+export function rpcLoadSceneAsync(name, buffer) {
+    const size = buffer.byteLength
+    const dataPointer = Module._malloc(size)
+    if (!dataPointer) throw new Error("Out of memory!")
+    HEAPU8.set(new Uint8Array(buffer), dataPointer)
+    return rpcCall({ cmd: "loadSceneAsync", name, dataPointer, size })
+}
+
+export function rpcPollScene(name) {
+    return rpcCall({ cmd: "pollScene", sceneName: name })
+}
@@ -0,0 +1,8 @@
+export class SceneTable {
+    constructor(buffer: ArrayBuffer)
+    readonly rootNode: number
+    readonly numElements: number
+    string(index: number): string
+    element(id: number): any
+    elementProps(id: number): any[]
+}
\ No newline at end of file
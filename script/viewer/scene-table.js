@@ -0,0 +1,118 @@
+
+// Decoder for the binary scene table returned by `getSceneTable`,
+// layout must match `scene_table_header` in native/viewer/serialization.h
+
+const SCENE_TABLE_MAGIC = 0x74626675
+const SCENE_TABLE_VERSION = 2
+const HEADER_WORDS = 21
+
+// Reference lists that exist even if empty, matching `getElements` "data"
+const linkFieldsByType = {
+    node: ["attribs", "children"],
+    mesh: ["materials", "deformers"],
+    material: ["textures"],
+    skin_deformer: ["clusters"],
+    blend_deformer: ["channels"],
+    blend_channel: ["keyframes"],
+}
+
+const textDecoder = new TextDecoder()
+
+export class SceneTable {
+    constructor(buffer) {
+        const header = new Uint32Array(buffer, 0, HEADER_WORDS)
+        if (header[0] !== SCENE_TABLE_MAGIC || header[1] !== SCENE_TABLE_VERSION) {
+            throw new Error("Bad scene table")
+        }
+
+        const [
+            magic, version, rootNode, numElements, numLinks, numProps, numStrings, stringDataSize,
+            elementNames, elementTypes, elementParents, linkBegin, linkIds, linkKinds,
+            propBegin, propNames, propTypes, propValueStrs, propValues, stringBegin, stringData,
+        ] = header
+
+        this.rootNode = rootNode
+        this.numElements = numElements
+        this.elementNames = new Uint32Array(buffer, elementNames, numElements)
+        this.elementTypes = new Uint32Array(buffer, elementTypes, numElements)
+        this.elementParents = new Uint32Array(buffer, elementParents, numElements)
+        this.linkBegin = new Uint32Array(buffer, linkBegin, numElements + 1)
+        this.linkIds = new Uint32Array(buffer, linkIds, numLinks)
+        this.linkKinds = new Uint32Array(buffer, linkKinds, numLinks)
+        this.propBegin = new Uint32Array(buffer, propBegin, numElements + 1)
+        this.propNames = new Uint32Array(buffer, propNames, numProps)
+        this.propTypes = new Uint32Array(buffer, propTypes, numProps)
+        this.propValueStrs = new Uint32Array(buffer, propValueStrs, numProps)
+        this.propValues = new Float64Array(buffer, propValues, numProps * 3)
+        this.stringBegin = new Uint32Array(buffer, stringBegin, numStrings + 1)
+        this.stringData = new Uint8Array(buffer, stringData, stringDataSize)
+
+        this.strings = new Array(numStrings)
+        this.elements = new Array(numElements)
+        this.props = new Array(numElements)
+    }
+
+    string(index) {
+        let str = this.strings[index]
+        if (str === undefined) {
+            const begin = this.stringBegin[index]
+            const end = this.stringBegin[index + 1]
+            str = textDecoder.decode(this.stringData.subarray(begin, end))
+            this.strings[index] = str
+        }
+        return str
+    }
+
+    // Returns `{ id, name, type, parent }` with reference lists such as `children`
+    element(id) {
+        if (id < 0 || id >= this.numElements) return null
+        let element = this.elements[id]
+        if (element) return element
+
+        const type = this.string(this.elementTypes[id])
+        const parent = this.elementParents[id]
+        element = {
+            id,
+            name: this.string(this.elementNames[id]),
+            type,
+            parent: parent === 0xffffffff ? -1 : parent,
+        }
+        for (const field of linkFieldsByType[type] ?? []) {
+            element[field] = []
+        }
+
+        const end = this.linkBegin[id + 1]
+        for (let i = this.linkBegin[id]; i < end; i++) {
+            const kind = this.string(this.linkKinds[i])
+            if (kind === "bone") {
+                element.bone = this.linkIds[i]
+            } else {
+                (element[kind] ??= []).push(this.linkIds[i])
+            }
+        }
+
+        this.elements[id] = element
+        return element
+    }
+
+    // Returns the props of an element as `{ name, type, value, valueStr }`
+    elementProps(id) {
+        if (id < 0 || id >= this.numElements) return []
+        let props = this.props[id]
+        if (props) return props
+
+        props = []
+        const end = this.propBegin[id + 1]
+        for (let i = this.propBegin[id]; i < end; i++) {
+            props.push({
+                name: this.string(this.propNames[i]),
+                type: this.string(this.propTypes[i]),
+                value: [this.propValues[i*3+0], this.propValues[i*3+1], this.propValues[i*3+2]],
+                valueStr: this.string(this.propValueStrs[i]),
+            })
+        }
+
+        this.props[id] = props
+        return props
+    }
+}
@@ -1,4 +1,5 @@
-import { rpcCall, rpcMemory, rpcGl, rpcSetup, rpcReload, rpcOnReady, rpcLoadScene, rpcDestroy } from "./rpc.js"
+import { rpcCall, rpcCallBatch, rpcRender, rpcPresent, rpcGetPixels, rpcMemory, rpcHeapU8, rpcGl, rpcSetup, rpcReload, rpcOnReady, rpcHasThreads, rpcLoadScene, rpcLoadSceneAsync, rpcDestroy } from "./rpc.js"
+import { SceneTable } from "./scene-table.js"
 import { deepEqual, getTime } from "../common"
 
 type SceneDesc = {
@@ -58,7 +59,11 @@ type SceneInfoListener = (name: string, info: SceneInfo) => void
 
 type Scene = {
     state: SceneState
+    progress: number // Parsing progress from 0 to 1 while "loading"
     info: SceneInfo | null
+    elementPages: Map<number, any[]>
+    vertexPages: Map<string, VertexPage>
+    table: SceneTable | null
 }
 
 function detach(element: HTMLElement) {
@@ -92,6 +97,7 @@ let rpcInitialized: boolean = false
 let rpcDestroyed: boolean = false
 let scenes: Map<string, Scene> = new Map()
 let scenesToLoad: Array<string> = []
+let scenesParsing: Array<string> = []
 let sceneInfoListeners: Array<SceneInfoListener> = []
 let realtimeViewerId: string = ""
 let prevInteractedViewerId: string = ""
@@ -104,7 +110,11 @@ function loadScene(path: string) {
     if (scenes.has(path)) return
     scenes.set(path, {
         state: "unloaded",
+        progress: 0,
         info: null,
+        elementPages: new Map(),
+        vertexPages: new Map(),
+        table: null,
     })
     scenesToLoad.push(path)
     requestFrame()
@@ -258,33 +268,35 @@ async function renderToTarget(targetIndex: number, desc: SceneDesc, resolution:
     await waitForExistingSync()
 
     const samples = 4
-    rpcCall({
-        cmd: "render",
-        target: { targetIndex, width: resolution.width, height: resolution.height, samples, pixelScale },
-        desc,
-    })
+    if (!rpcRender({ targetIndex, width: resolution.width, height: resolution.height, samples, pixelScale }, desc)) {
+        reloadIfEvicted(desc.sceneName)
+    }
+}
+
+// The native side unloads least recently rendered scenes to stay within its memory
+// budget, fetch them again (usually from the HTTP cache) when needed.
+function reloadIfEvicted(name: string) {
+    const scene = scenes.get(name)
+    if (!scene || scene.state !== "loaded") return
+
+    const stats = rpcCall({ cmd: "getMemoryStats" })
+    const entry = (stats.scenes ?? []).find((s: any) => s.name === name)
+    if (!entry || !entry.evicted) return
+
+    scene.state = "unloaded"
+    scenesToLoad.push(name)
+    requestFrame()
 }
 
 function presentTarget(targetIndex: number, resolution: Resolution) {
-    rpcCall({
-        cmd: "present",
-        targetIndex,
-        width: resolution.width,
-        height: resolution.height,
-    })
+    rpcPresent(targetIndex, resolution.width, resolution.height)
 }
 
 async function renderToBitmap(targetIndex: number, desc: SceneDesc, resolution: Resolution, pixelScale: number) {
     return acquireTarget(0, async () => {
         await renderToTarget(0, desc, resolution, pixelScale)
         await finishRendering()
-        const result = rpcCall({
-            cmd: "getPixels",
-            targetIndex,
-            width: resolution.width,
-            height: resolution.height,
-        })
-        const ptr = result.dataPointer
+        const ptr = rpcGetPixels(targetIndex, resolution.width, resolution.height)
         const pixels = new Uint8ClampedArray(rpcMemory(), ptr, resolution.width*resolution.height*4)
         const imageData = new ImageData(pixels, resolution.width, resolution.height)
         return createImageBitmap(imageData)
@@ -495,14 +507,49 @@ async function refreshViewer(viewer: Viewer) {
     }
 }
 
+function setSceneInfo(name: string, info: SceneInfo) {
+    const scene = scenes.get(name)!
+    scene.info = info
+    scene.elementPages.clear()
+    scene.vertexPages.clear()
+    scene.table = null
+    for (const cb of sceneInfoListeners) {
+        cb(name, info)
+    }
+}
+
+// Apply a `loadSceneAsync` or `pollScene` result, returns true while still parsing
+function updateSceneLoad(name: string, result: any): boolean {
+    const scene = scenes.get(name)!
+    if (result.state === "loading") {
+        scene.progress = result.bytesTotal > 0 ? result.bytesRead / result.bytesTotal : 0
+        return true
+    }
+
+    if (result.state === "loaded") {
+        setSceneInfo(name, result.scene)
+        scene.progress = 1
+        scene.state = "loaded"
+    } else {
+        scene.state = "error"
+    }
+    return false
+}
+
 function loadSceneFromBuffer(name: string, buffer: ArrayBuffer) {
-    const info = rpcLoadScene(name, buffer)
-    if (info) {
+    // `loadSceneAsync` would block just the same without threads
+    if (!rpcHasThreads()) {
+        const info = rpcLoadScene(name, buffer)
+        if (info) setSceneInfo(name, info)
         const scene = scenes.get(name)!
-        scene.info = info
-        for (const cb of sceneInfoListeners) {
-            cb(name, info)
-        }
+        scene.progress = 1
+        scene.state = "loaded"
+        return
+    }
+
+    const result = rpcLoadSceneAsync(name, buffer)
+    if (updateSceneLoad(name, result) && !scenesParsing.includes(name)) {
+        scenesParsing.push(name)
     }
 }
 
@@ -530,16 +577,23 @@ function animationFrame() {
         for (const url of scenesToLoad) {
             const scene = scenes.get(url)!
             scene.state = "loading"
+            scene.progress = 0
             fetch(url)
                 .then(response => response.arrayBuffer())
                 .then(buffer => loadSceneFromBuffer(url, buffer))
-                .then(() => scene.state = "loaded")
                 .catch(() => scene.state = "error")
                 .then(requestFrame)
         }
         scenesToLoad = []
     }
 
+    // With threads scenes are parsed on a native worker, keep polling until they finish
+    if (scenesParsing.length > 0) {
+        const results = rpcCallBatch(scenesParsing.map(name => ({ cmd: "pollScene", sceneName: name })))
+        scenesParsing = scenesParsing.filter((name, i) => updateSceneLoad(name, results[i]))
+        requestFrame()
+    }
+
     frameCallbacks = frameCallbacks.filter(cb => cb())
     if (frameCallbacks.length > 0) {
         requestFrame()
@@ -794,10 +848,135 @@ export function queryResolution(id: string) {
     }
 }
 
+export type PickResult = {
+    elementId: number
+    nodeId: number
+    faceIndex: number
+    index: number
+    indices: number[]
+    barycentric: [number, number, number]
+    position: [number, number, number]
+    distance: number
+}
+
+// Raycast the scene of a viewer at `x`, `y` in CSS pixels from the top-left corner
+// of its root element, using the view the viewer was last given in `renderViewer()`.
+export function pickViewer(id: string, x: number, y: number): PickResult | null {
+    const viewer = viewers.get(id)
+    if (!viewer || !rpcInitialized) return null
+    const scene = scenes.get(viewer.desc.sceneName)
+    if (!scene || scene.state !== "loaded") return null
+
+    const { width, height } = viewer.rootResolution
+    const result = rpcCall({
+        cmd: "pick",
+        sceneName: viewer.desc.sceneName,
+        x, y, width, height,
+        desc: viewer.desc,
+    })
+    if (result.error || !result.hit) return null
+    return result
+}
+
 export function addSceneInfoListener(cb: SceneInfoListener) {
     sceneInfoListeners.push(cb)
 }
 
+// Elements with type specific fields are fetched from the native side in pages on
+// first access, the scene info passed to listeners only contains a summary
+const elementPageSize = 256
+
+export function getSceneElement(name: string, id: number): any {
+    const scene = scenes.get(name)
+    if (!scene || !scene.info) return null
+    if (id < 0 || id >= scene.info.numElements) return null
+
+    const pageIndex = Math.floor(id / elementPageSize)
+    let page = scene.elementPages.get(pageIndex)
+    if (!page) {
+        const result = rpcCall({
+            cmd: "getElements",
+            sceneName: name,
+            begin: pageIndex * elementPageSize,
+            count: elementPageSize,
+            fields: ["data"],
+        })
+        // Don't cache failures, eg. if the scene is being reloaded
+        if (result.error || !result.elements) return null
+        page = result.elements as any[]
+        scene.elementPages.set(pageIndex, page)
+    }
+    return page[id - pageIndex * elementPageSize] ?? null
+}
+
+// Names, types, references and props of every element in a compact binary form,
+// decoded on demand. Use `getSceneElement()` for type specific fields.
+export function getSceneTable(name: string): SceneTable | null {
+    const scene = scenes.get(name)
+    if (!scene || !scene.info) return null
+
+    if (!scene.table) {
+        const result = rpcCall({ cmd: "getSceneTable", sceneName: name })
+        if (result.error) return null
+        const begin = result.dataPointer
+        scene.table = new SceneTable(rpcHeapU8().slice(begin, begin + result.size).buffer)
+    }
+    return scene.table
+}
+
+export type VertexPage = {
+    begin: number
+    count: number
+    vertexIndex: Uint32Array
+    position: Float32Array
+    normal: Float32Array | null
+    uv: Float32Array | null
+}
+
+export const vertexPageSize = 1000
+
+// Per-index vertex data of a mesh for indices `[page * vertexPageSize, (page + 1) * vertexPageSize)`,
+// fetched with a single `getVertexRange` call and cached until the scene is reloaded.
+export function getVertexPage(name: string, elementId: number, page: number): VertexPage | null {
+    const scene = scenes.get(name)
+    if (!scene || !scene.info) return null
+
+    const key = `${elementId}:${page}`
+    let result = scene.vertexPages.get(key)
+    if (!result) {
+        const range = rpcCall({
+            cmd: "getVertexRange",
+            sceneName: name,
+            elementId,
+            begin: page * vertexPageSize,
+            count: vertexPageSize,
+        })
+        if (range.error) return null
+
+        // Copy out of wasm memory as the buffer is reused by the next call
+        const { dataPointer, count, positionOffset, normalOffset, uvOffset } = range
+        const end = uvOffset !== undefined ? uvOffset + count * 8
+            : normalOffset !== undefined ? normalOffset + count * 12
+            : positionOffset + count * 12
+        const buffer = rpcHeapU8().slice(dataPointer, dataPointer + end).buffer
+        result = {
+            begin: range.begin,
+            count,
+            vertexIndex: new Uint32Array(buffer, 0, count),
+            position: new Float32Array(buffer, positionOffset, count * 3),
+            normal: normalOffset !== undefined ? new Float32Array(buffer, normalOffset, count * 3) : null,
+            uv: uvOffset !== undefined ? new Float32Array(buffer, uvOffset, count * 2) : null,
+        }
+        scene.vertexPages.set(key, result)
+    }
+    return result
+}
+
+export function getSceneProps(name: string, id: number): any[] {
+    const table = getSceneTable(name)
+    return table ? table.elementProps(id) : []
+}
+
 function initializeNativeViewer() {
     window.setTimeout(() => {
         getRealtimeCanvas()